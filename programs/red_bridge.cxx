@@ -1,32 +1,215 @@
 // Standard library:
 #include <cstdio>
+#include <cstdint>
 #include <iostream>
 #include <exception>
 #include <stdexcept>
 #include <memory>
 #include <string>
 #include <vector>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <limits>
+
+// System:
+#include <glob.h>
 
 // Third party:
 // - Bayeux:
 #include <bayeux/datatools/logger.h>
 #include <bayeux/datatools/io_factory.h>
 #include <bayeux/datatools/things.h>
-#include <bayeux/dpp/output_module.h>
-
-// - Falaise:
-#include <falaise/snemo/datamodels/event_header.h>
-#include <falaise/snemo/datamodels/unified_digitized_data.h>
+#include <bayeux/dpp/base_module.h>
 
 // - SNFEE:
 #include <snfee/snfee.h>
 #include <snfee/io/multifile_data_reader.h>
 #include <snfee/data/raw_event_data.h>
 
+// This project:
+#include <snredbridge/red_to_udd_conversion.h>
+#include <snredbridge/red_udd_comparison.h>
+#include <snredbridge/event_record_roundtrip.h>
+#include <snredbridge/run_monitoring.h>
+#include <snredbridge/json_writer.h>
+#include <snredbridge/udd_writer.h>
+#include <snredbridge/udd_file_sequence.h>
+#include <snredbridge/udd_sink.h>
+#include <snredbridge/conversion_checkpoint.h>
+#include <snredbridge/waveform_codec.h>
+#include <snredbridge/event_selection.h>
+#include <snredbridge/red_file_index.h>
+#include <snredbridge/event_fingerprint.h>
+#include <snredbridge/rtd2red_process.h>
+#include <snredbridge/red_file_follower.h>
+#include <snredbridge/run_statistics.h>
+#include <snredbridge/bounded_queue.h>
+
+
+/// Settings of the conversion
+struct conversion_config
+{
+  std::size_t data_count = 100000000;
+  std::size_t first_record = 0;     ///< Position of the first RED record to process
+  bool no_waveform = false;
+  snredbridge::waveform_config waveform; ///< Storage of the waveforms in the UDD hits
+  unsigned int number_of_threads = 1;
+  bool verify = false;
+  bool fingerprint = true;          ///< Store the fingerprint of each event in its header
+  bool statistics = false;          ///< Fill the run statistics of the converted events
+  double progress_interval = 60.0;  ///< Seconds between two progress lines (0: none)
+  std::string progress_label;       ///< Label of the progress lines (input file of a job)
+  std::size_t expected_events = 0; ///< Number of events to process if known (for the ETA)
+  datatools::logger::priority logging = datatools::logger::PRIO_WARNING;
+};
+
+/// Counters of the conversion
+struct conversion_counters
+{
+  std::size_t red = 0;       ///< Processed RED records
+  std::size_t udd = 0;       ///< Stored UDD records
+  std::size_t verified = 0;  ///< Verified UDD records
+  std::size_t non_equal = 0; ///< Verified UDD records not equivalent to their RED event
+  std::size_t calo_hits = 0;
+  std::size_t tracker_hits = 0;
+  snredbridge::run_statistics statistics; ///< Run statistics of the converted events
+
+  // Time spent in each stage of the conversion, summed over the threads
+  snredbridge::stage_timer read_timer;         ///< RED inflate and deserialization
+  snredbridge::stage_timer conversion_timer;   ///< RED to UDD conversion
+  snredbridge::stage_timer verification_timer; ///< Serialization round trip and comparison
+  snredbridge::stage_timer write_timer;        ///< UDD serialization and deflate
+};
+
+/// Results of an additional UDD output
+struct sink_results
+{
+  snredbridge::udd_sink::config_type config;   ///< Settings resolved by the writer
+  snredbridge::event_selection selection;      ///< Selection of the sink and its counters
+  std::size_t udd = 0;                         ///< Stored UDD records
+  snredbridge::stage_timer write_timer;        ///< UDD serialization and deflate (writer thread)
+  std::vector<std::string> output_filenames;
+};
+
+/// Additional UDD outputs of a conversion
+typedef std::vector<std::unique_ptr<snredbridge::udd_sink>> sink_list;
+
+/// \brief Conversion of RED files into a UDD output
+///
+/// Several jobs, one per input file, can run in parallel. The RED files of
+/// a job are read in a row into the same output.
+struct conversion_job
+{
+  std::vector<std::string> input_filenames;
+  snredbridge::udd_file_sequence::config_type output;
+  std::vector<snredbridge::udd_sink::config_type> sinks; ///< Additional outputs
+  snredbridge::event_selection selection; ///< Selection and its counters for this job
+  conversion_config config;
+  std::string index_filename;
+  std::size_t end_record = std::numeric_limits<std::size_t>::max(); ///< Past the last record to process
+  std::size_t shard_index = 0;
+  std::size_t shard_count = 0;
+  bool resume = false;
+
+  // Results
+  std::string error;                          ///< Error which stopped the job
+  bool already_complete = false;              ///< The checkpoint of a resumed job was complete
+  conversion_counters counters;
+  bool output_is_split = false;
+  bool output_has_checkpoints = false;
+  std::vector<std::string> output_filenames;
+  snredbridge::conversion_checkpoint checkpoint;
+  std::vector<sink_results> sinks_results;
+  double wall_time = 0.0;
+};
+
+/// Per thread tools to check converted event records against their RED event
+struct event_record_verifier
+{
+  /// The round trip uses the archive of the output file
+  explicit event_record_verifier(const std::string & output_filename_)
+    : roundtrip(snredbridge::archive_format_from_filename(output_filename_))
+  {
+  }
+
+  snredbridge::event_record_roundtrip roundtrip;
+  datatools::things stored_event_record;
+
+  /// Check the event record as it is loaded back after serialization
+  bool verify(const snfee::data::raw_event_data &,
+              const datatools::things &,
+              const conversion_config &);
+};
+
+void add_input_files(const std::string &,
+                     std::vector<std::string> &);
+
+std::string default_output_filename(const std::string &,
+                                    const std::string &);
+
+snredbridge::udd_sink::config_type parse_sink(const std::string &,
+                                              const snredbridge::udd_sink::config_type &);
+
+void run_conversion_job(conversion_job &);
+
+void do_conversion_job(conversion_job &);
+
+template <class Reader>
+void do_conversion(Reader &,
+                   snredbridge::udd_file_sequence &,
+                   sink_list &,
+                   snredbridge::event_selection &,
+                   const conversion_config &,
+                   conversion_counters &);
+
+template <class Reader>
+void do_serial_conversion(Reader &,
+                          snredbridge::udd_file_sequence &,
+                          sink_list &,
+                          snredbridge::event_selection &,
+                          const conversion_config &,
+                          conversion_counters &);
+
+template <class Reader>
+void do_multithreaded_conversion(Reader &,
+                                 snredbridge::udd_file_sequence &,
+                                 sink_list &,
+                                 snredbridge::event_selection &,
+                                 const conversion_config &,
+                                 conversion_counters &);
+
+void print_stage(const std::string &,
+                 const snredbridge::stage_timer &,
+                 const double);
+
+void print_job_results(const conversion_job &,
+                       const bool);
+
+void print_total_results(const std::vector<conversion_job> &,
+                         const double);
+
+void write_run_summary(const std::string &,
+                       const std::vector<conversion_job> &,
+                       const double);
+
+void write_job_summary(snredbridge::json_writer &,
+                       const conversion_job &);
+
+void write_run_statistics(const std::string &,
+                          const std::vector<conversion_job> &);
+
+std::string join_filenames(const std::vector<std::string> &);
+
+std::size_t get_files_size(const std::vector<std::string> &);
 
-void do_red_to_udd_conversion(const snfee::data::raw_event_data,
-                              datatools::things &,
-                              const bool);
 
 //----------------------------------------------------------------------
 // MAIN PROGRAM
@@ -37,10 +220,24 @@ int main (int argc, char *argv[])
   datatools::logger::priority logging = datatools::logger::PRIO_WARNING;
   int error_code = EXIT_SUCCESS;
   try {
-  std::string input_filename = "";
+  std::vector<std::string> input_filenames;
   std::string output_filename = "";
-  size_t data_count = 100000000;
-  bool no_waveform = false;
+  std::string output_directory = "";
+  std::string summary_filename = "";
+  std::string statistics_filename = "";
+  std::string output_codec = "";
+  bool merge_inputs = false;
+  unsigned int number_of_jobs = 0;
+  snredbridge::rtd2red_process::config_type rtd2red_cfg;
+  bool follow = false;
+  bool follow_options = false;
+  double flush_interval = 0.0;
+  snredbridge::red_file_follower::config_type follow_cfg;
+  std::vector<std::string> sink_specs;
+  conversion_job job_template;
+  conversion_config & config = job_template.config;
+  snredbridge::udd_file_sequence::config_type & output_cfg = job_template.output;
+  snredbridge::udd_writer::config_type & writer_cfg = output_cfg.writer;
 
   for (int iarg=1; iarg<argc; ++iarg)
     {
@@ -48,22 +245,147 @@ int main (int argc, char *argv[])
       if (arg[0] == '-')
         {
           if ((arg == "-d") || (arg == "--debug"))
-            logging = datatools::logger::PRIO_DEBUG;
+            logging = config.logging = datatools::logger::PRIO_DEBUG;
 
           else if ((arg == "-v") || (arg == "--verbose"))
-            logging = datatools::logger::PRIO_INFORMATION;
+            logging = config.logging = datatools::logger::PRIO_INFORMATION;
 
           else if ((arg=="-i") || (arg=="--input"))
-            input_filename = std::string(argv[++iarg]);
+            add_input_files(argv[++iarg], input_filenames);
+
+          else if (arg == "--input-list")
+            {
+              const std::string list_filename(argv[++iarg]);
+              std::ifstream list_file(list_filename);
+              DT_THROW_IF(!list_file, std::runtime_error, "Cannot open input list '" << list_filename << "'!");
+              std::string line;
+              while (std::getline(list_file, line))
+                if (!line.empty() && line[0] != '#') add_input_files(line, input_filenames);
+            }
 
           else if ((arg=="-o") || (arg=="--output"))
             output_filename = std::string(argv[++iarg]);
 
+          else if (arg == "--output-dir")
+            output_directory = std::string(argv[++iarg]);
+
+          else if (arg == "--merge")
+            merge_inputs = true;
+
+          else if (arg == "--jobs")
+            number_of_jobs = std::strtoul(argv[++iarg], NULL, 10);
+
           else if ((arg == "-n") || (arg == "--max-events"))
-            data_count = std::strtol(argv[++iarg], NULL, 10);
+            config.expected_events = config.data_count = std::strtol(argv[++iarg], NULL, 10);
 
           else if ((arg == "-no-wf") || (arg == "--no-waveform"))
-            no_waveform = true;
+            config.no_waveform = true;
+
+          else if ((arg == "-t") || (arg == "--threads"))
+            config.number_of_threads = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg == "--verify")
+            config.verify = true;
+
+          else if (arg == "--no-fingerprint")
+            config.fingerprint = false;
+
+          else if (arg == "--progress")
+            config.progress_interval = std::strtod(argv[++iarg], NULL);
+
+          else if (arg == "--summary")
+            summary_filename = std::string(argv[++iarg]);
+
+          else if (arg == "--stats")
+            statistics_filename = std::string(argv[++iarg]);
+
+          else if (arg == "--codec")
+            output_codec = std::string(argv[++iarg]);
+
+          else if (arg == "--level")
+            writer_cfg.level = std::strtol(argv[++iarg], NULL, 10);
+
+          else if (arg == "--compression-threads")
+            writer_cfg.compression_threads = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg == "--checkpoint-interval")
+            output_cfg.checkpoint_interval = std::strtod(argv[++iarg], NULL);
+
+          else if (arg == "--checkpoint")
+            output_cfg.checkpoint_filename = std::string(argv[++iarg]);
+
+          else if (arg == "--resume")
+            job_template.resume = true;
+
+          else if (arg == "--max-events-per-file")
+            output_cfg.max_events_per_file = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg == "--max-bytes-per-file")
+            output_cfg.max_bytes_per_file = std::strtoull(argv[++iarg], NULL, 10);
+
+          else if (arg == "--manifest")
+            output_cfg.manifest_filename = std::string(argv[++iarg]);
+
+          else if (arg == "--first")
+            config.first_record = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg == "--last")
+            job_template.end_record = std::strtoul(argv[++iarg], NULL, 10) + 1;
+
+          else if (arg == "--shard")
+            {
+              const std::string shard(argv[++iarg]);
+              const std::size_t slash = shard.find('/');
+              DT_THROW_IF(slash == std::string::npos, std::logic_error, "Invalid shard '" << shard << "', expected i/N!");
+              job_template.shard_index = std::strtoul(shard.substr(0, slash).c_str(), NULL, 10);
+              job_template.shard_count = std::strtoul(shard.substr(slash + 1).c_str(), NULL, 10);
+              DT_THROW_IF(job_template.shard_index >= job_template.shard_count, std::logic_error, "Invalid shard '" << shard << "', expected i/N with i < N!");
+            }
+
+          else if (arg == "--index")
+            job_template.index_filename = std::string(argv[++iarg]);
+
+          else if (arg == "--sink")
+            sink_specs.push_back(argv[++iarg]);
+
+          else if (arg == "--rtd2red")
+            rtd2red_cfg.command = std::string(argv[++iarg]);
+
+          else if (arg == "--archive-red")
+            rtd2red_cfg.archive_filename = std::string(argv[++iarg]);
+
+          else if (arg == "--follow")
+            follow = true;
+
+          else if (arg == "--end-marker")
+            {
+              follow_cfg.end_marker = std::string(argv[++iarg]);
+              follow_options = true;
+            }
+
+          else if (arg == "--idle-timeout")
+            {
+              follow_cfg.idle_timeout = std::strtod(argv[++iarg], NULL);
+              follow_options = true;
+            }
+
+          else if (arg == "--flush-interval")
+            {
+              flush_interval = std::strtod(argv[++iarg], NULL);
+              follow_options = true;
+            }
+
+          else if (arg == "--select")
+            job_template.selection.add_cut(argv[++iarg]);
+
+          else if (arg == "--waveform-mode")
+            config.waveform.mode = snredbridge::waveform_mode_from_string(argv[++iarg]);
+
+          else if (arg == "--roi-before")
+            config.waveform.roi_before = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg == "--roi-after")
+            config.waveform.roi_after = std::strtoul(argv[++iarg], NULL, 10);
 
           else if (arg=="-h" || arg=="--help")
             {
@@ -71,10 +393,52 @@ int main (int argc, char *argv[])
               std::cout << "Usage:   " << argv[0] << " [options]" << std::endl;
               std::cout << std::endl;
               std::cout << "Options:   -h / --help" << std::endl;
-              std::cout << "           -i / --input       RED_FILE" << std::endl;
-              std::cout << "           -o / --output      UDD_FILE" << std::endl;
+              std::cout << "           -i / --input       RED_FILE (repeat for several files, wildcards allowed)" << std::endl;
+              std::cout << "           --input-list       TEXT_FILE with one RED_FILE per line" << std::endl;
+              std::cout << "           -o / --output      UDD_FILE (one input file, or with --merge)" << std::endl;
+              std::cout << "           --output-dir       Directory of the UDD files of several input files (default: .)" << std::endl;
+              std::cout << "           --merge            Convert all the input files into a single UDD_FILE" << std::endl;
+              std::cout << "           --jobs             Number of input files converted in parallel (default: min(files, threads))," << std::endl;
+              std::cout << "                              sharing the conversion and compression threads" << std::endl;
               std::cout << "           -n / --max-events  Max number of events" << std::endl;
               std::cout << "           -no-wf / --no-waveform Do not save the waveform from RED to UDD" << std::endl;
+              std::cout << "           -t / --threads     Number of conversion threads, shared by the jobs (default: 1, no pipeline)" << std::endl;
+              std::cout << "           --verify           Compare each stored UDD event with its RED event" << std::endl;
+              std::cout << "           --no-fingerprint   Do not store the fingerprint of the events in their header" << std::endl;
+              std::cout << "           --progress         Seconds between two progress lines (default: 60, 0: none)" << std::endl;
+              std::cout << "           --summary          JSON_FILE with the run summary" << std::endl;
+              std::cout << "           --stats            JSON_FILE with the run statistics of the converted events (channel rates, spectra...)" << std::endl;
+              std::cout << "           --codec            Output compression: gzip, bzip2 or none (default: from UDD_FILE extension)" << std::endl;
+              std::cout << "           --level            Gzip compression level from 1 (fast) to 9 (small)" << std::endl;
+              std::cout << "           --compression-threads Number of gzip block compression threads (default: 0, by the output module)" << std::endl;
+              std::cout << "           --checkpoint-interval Seconds between two checkpoints, the output is written in numbered parts (default: 0, none)" << std::endl;
+              std::cout << "           --checkpoint       CHECKPOINT_FILE (default: UDD_FILE.checkpoint)" << std::endl;
+              std::cout << "           --resume           Resume the conversion from its last checkpoint" << std::endl;
+              std::cout << "           --max-events-per-file Roll over to a new numbered output file after N events" << std::endl;
+              std::cout << "           --max-bytes-per-file  Roll over to a new numbered output file once it reaches N bytes" << std::endl;
+              std::cout << "           --manifest         JSON_FILE listing the numbered output files (default: UDD_FILE.manifest.json)" << std::endl;
+              std::cout << "           --first            Position of the first RED record to convert (from 0)" << std::endl;
+              std::cout << "           --last             Position of the last RED record to convert" << std::endl;
+              std::cout << "           --shard            i/N: convert the i-th of N equal parts of the RED file (from 0, needs the index)" << std::endl;
+              std::cout << "           --index            INDEX_FILE of the RED file (default: RED_FILE.idx if it exists, see red_bridge_index)" << std::endl;
+              std::cout << "           --sink             \"UDD_FILE[,OPTION=VALUE...]\" additional output written in the same pass (repeat for" << std::endl;
+              std::cout << "                              several outputs). Options: waveform, roi-before, roi-after, select (repeat for" << std::endl;
+              std::cout << "                              several cuts), codec, level, compression-threads (default: as the main output)" << std::endl;
+              std::cout << "           --rtd2red          \"COMMAND\" of the event builder writing the RED records into %RED%," << std::endl;
+              std::cout << "                              converted on the fly without RED file (replaces -i)" << std::endl;
+              std::cout << "           --archive-red      RED_FILE (.data.gz) keeping a copy of the RED records built by --rtd2red" << std::endl;
+              std::cout << "           --follow           Convert the records of the RED file (-i) as they are appended to it" << std::endl;
+              std::cout << "           --end-marker       FILE whose creation ends the run in --follow mode (default: RED_FILE.end)" << std::endl;
+              std::cout << "           --idle-timeout     Seconds without new RED records before the end in --follow mode (default: 600, 0: none)" << std::endl;
+              std::cout << "           --flush-interval   Seconds between two closed numbered output files in --follow mode (default: 0, none)" << std::endl;
+              std::cout << "           --select           Cut on RED events, as \"tracker_hits >= 3\" (repeat for several cuts)" << std::endl;
+              std::cout << "                              Variables:";
+              for (const std::string & variable : snredbridge::event_selection::get_variable_names())
+                std::cout << ' ' << variable;
+              std::cout << std::endl;
+              std::cout << "           --waveform-mode    Waveform storage: full, roi (window around the pulse) or packed (lossless)" << std::endl;
+              std::cout << "           --roi-before       Cells kept before the rising edge in roi mode (default: 32)" << std::endl;
+              std::cout << "           --roi-after        Cells kept after the falling edge in roi mode (default: 96)" << std::endl;
               std::cout << "           -v / --verbose     More logs" << std::endl;
               std::cout << "           -d / --debug       Debug logs" << std::endl;
               std::cout << std::endl;
@@ -86,81 +450,229 @@ int main (int argc, char *argv[])
         }
     }
 
-  if (input_filename.empty())
+  const bool fused_rtd2red = !rtd2red_cfg.command.empty();
+  if (fused_rtd2red)
+    {
+      // The RED records are read once, in order, from a pipe
+      if (!input_filenames.empty() || job_template.resume || job_template.shard_count > 0
+          || config.first_record > 0 || !job_template.index_filename.empty())
+        {
+          std::cerr << "*** ERROR: option --rtd2red excludes options -i, --resume, --shard, --first and --index !" << std::endl;
+          return 1;
+        }
+      if (output_filename.empty())
+        {
+          std::cerr << "*** ERROR: option --rtd2red needs option -o !" << std::endl;
+          return 1;
+        }
+    }
+  else if (!rtd2red_cfg.archive_filename.empty())
+    {
+      std::cerr << "*** ERROR: option --archive-red needs option --rtd2red !" << std::endl;
+      return 1;
+    }
+  else if (input_filenames.empty())
     {
       std::cerr << "*** ERROR: missing input filename !" << std::endl;
       return 1;
     }
 
-  DT_LOG_INFORMATION(logging, "SNREDBridge program : converting SNFEE RED into Falaise datatools::things event record containing EH and UDD banks for each event");
-
-  DT_LOG_DEBUG(logging, "Initialize SNFEE");
-  snfee::initialize();
-
-  /// Configuration for raw data reader
-  snfee::io::multifile_data_reader::config_type reader_cfg;
-  reader_cfg.filenames.push_back(input_filename);
+  if (follow)
+    {
+      // The RED file is read once, in order, from a pipe
+      if (input_filenames.size() != 1 || fused_rtd2red || job_template.resume || job_template.shard_count > 0
+          || config.first_record > 0 || !job_template.index_filename.empty())
+        {
+          std::cerr << "*** ERROR: option --follow needs a single input file and excludes options --rtd2red, --resume, --shard, --first and --index !" << std::endl;
+          return 1;
+        }
+      follow_cfg.filename = input_filenames.front();
+      if (output_filename.empty()) output_filename = default_output_filename(follow_cfg.filename, output_directory);
+      // The output parts closed at each checkpoint are readable while the run goes on
+      if (flush_interval > 0.0) output_cfg.checkpoint_interval = flush_interval;
+    }
+  else if (follow_options)
+    {
+      std::cerr << "*** ERROR: options --end-marker, --idle-timeout and --flush-interval need option --follow !" << std::endl;
+      return 1;
+    }
 
-  // Declare the reader
-  DT_LOG_DEBUG(logging, "Instantiate the RED reader");
-  snfee::io::multifile_data_reader red_source(reader_cfg);
+  if (config.no_waveform) config.waveform.mode = snredbridge::waveform_mode::none;
 
-  // Declare the writer
-  DT_LOG_DEBUG(logging, "Instantiate the DPP writer output module");
+  if (job_template.resume && output_cfg.checkpoint_interval <= 0.0)
+    {
+      std::cerr << "*** ERROR: option --resume needs option --checkpoint-interval !" << std::endl;
+      return 1;
+    }
 
-  // The output module:
-  dpp::output_module writer;
-  writer.set_logging_priority(datatools::logger::PRIO_FATAL);
-  writer.set_name("Writer output module");
-  writer.set_description("Output module for the datatools::things event_record");
-  writer.set_preserve_existing_output(false); // Allowed to erase existing output file
-  writer.set_single_output_file(output_filename);
+  if (!statistics_filename.empty())
+    {
+      // The statistics of the records converted before the checkpoint are lost
+      if (job_template.resume)
+        {
+          std::cerr << "*** ERROR: option --stats excludes option --resume !" << std::endl;
+          return 1;
+        }
+      config.statistics = true;
+    }
 
-  writer.initialize_simple();
-  DT_LOG_DEBUG(logging, "Initialization of the output module is done.");
+  if (input_filenames.size() > 1 && !merge_inputs && !output_filename.empty())
+    {
+      std::cerr << "*** ERROR: option -o needs a single input file or option --merge, use --output-dir !" << std::endl;
+      return 1;
+    }
 
+  if (!sink_specs.empty())
+    {
+      if (input_filenames.size() > 1 && !merge_inputs)
+        {
+          std::cerr << "*** ERROR: option --sink needs a single input file or option --merge !" << std::endl;
+          return 1;
+        }
+      if (output_cfg.checkpoint_interval > 0.0 || job_template.resume)
+        {
+          std::cerr << "*** ERROR: option --sink excludes options --checkpoint-interval, --flush-interval and --resume !" << std::endl;
+          return 1;
+        }
+      // The sinks start from the settings of the main output
+      snredbridge::udd_sink::config_type sink_defaults;
+      sink_defaults.output.writer = writer_cfg;
+      sink_defaults.waveform = config.waveform;
+      sink_defaults.fingerprint = config.fingerprint;
+      for (const std::string & sink_spec : sink_specs)
+        job_template.sinks.push_back(parse_sink(sink_spec, sink_defaults));
+      DT_THROW_IF(job_template.sinks.size() > 64, std::logic_error, "Too many sinks (max: 64)!");
+    }
 
-  // RED counter
-  std::size_t red_counter = 0;
+  DT_LOG_INFORMATION(logging, "SNREDBridge program : converting SNFEE RED into Falaise datatools::things event record containing EH and UDD banks for each event");
 
-  // UDD counter
-  std::size_t udd_counter = 0;
+  DT_LOG_DEBUG(logging, "Initialize SNFEE");
+  snfee::initialize();
 
-  while (red_source.has_record_tag() && red_counter < data_count)
+  // The event builder streams its RED records to the conversion
+  std::unique_ptr<snredbridge::rtd2red_process> rtd2red;
+  if (fused_rtd2red)
     {
-      // Check the serialization tag of the next record:
-      DT_THROW_IF(!red_source.record_tag_is(snfee::data::raw_event_data::SERIAL_TAG),
-                  std::logic_error, "Unexpected record tag '" << red_source.get_record_tag() << "'!");
-
-      // Empty working RED object
-      snfee::data::raw_event_data red;
-
-      // Load the next RED object:
-      red_source.load(red);
-      red_counter++;
+      rtd2red_cfg.archive_level = writer_cfg.level;
+      rtd2red_cfg.archive_threads = std::max(1u, writer_cfg.compression_threads);
+      DT_LOG_INFORMATION(logging, "Start the event builder: " << rtd2red_cfg.command);
+      rtd2red.reset(new snredbridge::rtd2red_process(rtd2red_cfg));
+      input_filenames.push_back(rtd2red->get_red_filename());
+      job_template.config.progress_label = "rtd2red";
+    }
 
-      // Declare a ``datatools::things`` event record
-      DT_LOG_DEBUG(logging, "Declare the datatools::things event record");
-      datatools::things event_record;
-      std::ostringstream namess;
-      namess << "ER_" << udd_counter;
-      event_record.set_name(namess.str());
-      event_record.set_description("An event record composed by an Event Header (EH) and the Unified Digitized Data (UDD) banks");
+  // The records appended to the RED file are streamed to the conversion
+  std::unique_ptr<snredbridge::red_file_follower> follower;
+  if (follow)
+    {
+      follower.reset(new snredbridge::red_file_follower(follow_cfg));
+      DT_LOG_INFORMATION(logging, "Follow the RED file '" << follow_cfg.filename << "' until '"
+                         << follower->get_config().end_marker << "' exists");
+      input_filenames.front() = follower->get_red_filename();
+      job_template.config.progress_label = "follow";
+    }
 
-      // Do the RED to UDD conversion and fill the Event record
-      do_red_to_udd_conversion(red, event_record, no_waveform);
+  // One job per input file, or a single job reading all the files in a row
+  std::vector<conversion_job> jobs;
+  if (merge_inputs || input_filenames.size() == 1)
+    {
+      jobs.push_back(job_template);
+      jobs.back().input_filenames = input_filenames;
+      jobs.back().output.writer.filename = output_filename;
+    }
+  else
+    for (const std::string & input_filename : input_filenames)
+      {
+        jobs.push_back(job_template);
+        jobs.back().input_filenames.push_back(input_filename);
+        jobs.back().output.writer.filename = default_output_filename(input_filename, output_directory);
+        jobs.back().config.progress_label = input_filename;
+      }
+
+  // The codec replaces the compression extension of the output files
+  for (conversion_job & job : jobs)
+    {
+      DT_THROW_IF(job.output.writer.filename.empty(), std::logic_error, "Missing output filename!");
+      if (!output_codec.empty())
+        job.output.writer.filename = snredbridge::filename_with_codec(job.output.writer.filename,
+                                                                      snredbridge::compression_codec_from_string(output_codec));
+    }
 
-      dpp::base_module::process_status status = writer.process(event_record);
+  // The conversion and compression threads are shared by the jobs running
+  // in parallel (no compression thread stays compression by the output module)
+  if (number_of_jobs == 0) number_of_jobs = std::max(1u, config.number_of_threads);
+  number_of_jobs = std::min<std::size_t>(number_of_jobs, jobs.size());
+  const unsigned int threads_per_job = std::max(1u, config.number_of_threads / number_of_jobs);
+  auto share_compression_threads = [number_of_jobs](unsigned int & compression_threads_)
+    {
+      if (compression_threads_ > 0) compression_threads_ = std::max(1u, compression_threads_ / number_of_jobs);
+    };
+  for (conversion_job & job : jobs)
+    {
+      job.config.number_of_threads = threads_per_job;
+      share_compression_threads(job.output.writer.compression_threads);
+      for (snredbridge::udd_sink::config_type & sink_cfg : job.sinks)
+        share_compression_threads(sink_cfg.output.writer.compression_threads);
+    }
+  if (jobs.size() > 1)
+    DT_LOG_INFORMATION(logging, "Converting " << jobs.size() << " input files, " << number_of_jobs
+                       << " at a time with " << threads_per_job << " conversion thread(s) and "
+                       << jobs.front().output.writer.compression_threads << " compression thread(s) each");
 
-      udd_counter++;
-      DT_LOG_DEBUG(logging, "Exit do_red_to_udd_conversion");
+  // Wall time of the conversion loops
+  const snredbridge::stage_timer::clock_type::time_point start_time = snredbridge::stage_timer::clock_type::now();
 
-      // Smart print :
-      // event_record.tree_dump(std::clog, "The event data record composed by EH and UDD banks.");
+  if (number_of_jobs == 1)
+    for (conversion_job & job : jobs) run_conversion_job(job);
+  else
+    {
+      std::atomic<std::size_t> next_job(0);
+      std::vector<std::thread> job_threads;
+      for (unsigned int ithread = 0; ithread < number_of_jobs; ithread++)
+        job_threads.emplace_back([&]
+          {
+            for (std::size_t ijob = next_job++; ijob < jobs.size(); ijob = next_job++)
+              run_conversion_job(jobs[ijob]);
+          });
+      for (auto & job_thread : job_threads) job_thread.join();
+    }
 
+  if (rtd2red)
+    {
+      try {
+        rtd2red->wait();
+        if (rtd2red->was_stopped())
+          DT_LOG_WARNING(logging, "The event builder was stopped before the end of its RED records!");
+        if (!rtd2red_cfg.archive_filename.empty())
+          DT_LOG_INFORMATION(logging, "RED records archived in '" << rtd2red_cfg.archive_filename << "'");
+      }
+      catch (std::exception & x) {
+        DT_LOG_FATAL(logging, x.what());
+        error_code = EXIT_FAILURE;
+      }
+      rtd2red.reset();
+    }
 
-    } // (while red_source.has_record_tag())
+  if (follower)
+    {
+      try {
+        follower->wait();
+        DT_LOG_INFORMATION(logging, "End of the RED file '" << follow_cfg.filename << "' after "
+                           << follower->get_number_of_bytes() << " bytes: " << snredbridge::to_string(follower->get_end()));
+        if (follower->get_end() == snredbridge::follow_end::idle_timeout)
+          DT_LOG_WARNING(logging, "No end-of-run marker '" << follower->get_config().end_marker << "', the RED file did not grow for "
+                         << follow_cfg.idle_timeout << " s!");
+      }
+      catch (std::exception & x) {
+        DT_LOG_FATAL(logging, x.what());
+        error_code = EXIT_FAILURE;
+      }
+      // The results refer to the RED file, not to its pipe
+      jobs.front().input_filenames.front() = follow_cfg.filename;
+      follower.reset();
+    }
 
+  const double wall_time = std::chrono::duration<double>(snredbridge::stage_timer::clock_type::now() - start_time).count();
 
   // Check input RED file and output UDD file and count the number of events in each file
   // In validation program
@@ -168,11 +680,25 @@ int main (int argc, char *argv[])
   // Read UDD file here
 
 
-  std::cout << "Results :" << std::endl;
-  std::cout << "- Worker #0 (input RED)"  << std::endl;
-  std::cout << "  - Processed records : " << red_counter << std::endl;
-  std::cout << "- Worker #1 (output UDD)" << std::endl;
-  std::cout << "  - Stored records    : " << udd_counter << std::endl;
+  for (const conversion_job & job : jobs)
+    {
+      print_job_results(job, jobs.size() > 1);
+      if (!job.error.empty() || job.counters.non_equal > 0) error_code = EXIT_FAILURE;
+    }
+  if (jobs.size() > 1) print_total_results(jobs, wall_time);
+  std::cout << "- Peak RSS : " << snredbridge::get_peak_rss_kb() / 1024 << " MB" << std::endl;
+
+  if (!summary_filename.empty())
+    write_run_summary(summary_filename, jobs, wall_time);
+
+  if (!statistics_filename.empty())
+    {
+      write_run_statistics(statistics_filename, jobs);
+      std::cout << "- Run statistics : " << statistics_filename << std::endl;
+    }
+
+  for (const conversion_job & job : jobs)
+    if (!job.error.empty()) DT_LOG_FATAL(logging, job.error);
 
   snfee::terminate();
 
@@ -192,180 +718,908 @@ int main (int argc, char *argv[])
 }
 
 
+void add_input_files(const std::string & pattern_,
+                     std::vector<std::string> & filenames_)
+{
+  // Patterns not expanded by the shell (quoted, or from an input list)
+  if (pattern_.find_first_of("*?[") == std::string::npos)
+    {
+      filenames_.push_back(pattern_);
+      return;
+    }
+  glob_t matches;
+  const int status = glob(pattern_.c_str(), 0, NULL, &matches);
+  DT_THROW_IF(status == GLOB_NOMATCH, std::runtime_error, "No input file matches '" << pattern_ << "'!");
+  DT_THROW_IF(status != 0, std::runtime_error, "Cannot expand input files '" << pattern_ << "'!");
+  for (std::size_t i = 0; i < matches.gl_pathc; i++) filenames_.push_back(matches.gl_pathv[i]);
+  globfree(&matches);
+  return;
+}
+
+
+std::string default_output_filename(const std::string & input_filename_,
+                                    const std::string & output_directory_)
+{
+  // "snemo_run-815_red-v1.data.gz" -> "snemo_run-815_udd-v1.data.gz"
+  std::string filename = input_filename_.substr(input_filename_.find_last_of('/') + 1);
+  const std::size_t red = filename.rfind("_red");
+  if (red != std::string::npos)
+    filename.replace(red, 4, "_udd");
+  else
+    {
+      const std::size_t dot = filename.find('.');
+      filename.insert(dot == std::string::npos ? filename.size() : dot, "_udd");
+    }
+  return output_directory_.empty() ? filename : output_directory_ + "/" + filename;
+}
+
+
+snredbridge::udd_sink::config_type parse_sink(const std::string & spec_,
+                                              const snredbridge::udd_sink::config_type & defaults_)
+{
+  // "UDD_FILE[,OPTION=VALUE...]", for example
+  // "snemo_run-815_udd-nowf.data.gz,waveform=none,level=6"
+  snredbridge::udd_sink::config_type sink_cfg = defaults_;
+  std::string codec;
+  std::size_t begin = 0;
+  for (std::size_t ifield = 0; begin <= spec_.size(); ifield++)
+    {
+      std::size_t end = spec_.find(',', begin);
+      if (end == std::string::npos) end = spec_.size();
+      const std::string field = spec_.substr(begin, end - begin);
+      begin = end + 1;
+      if (ifield == 0)
+        {
+          sink_cfg.output.writer.filename = field;
+          continue;
+        }
+      const std::size_t equal = field.find('=');
+      DT_THROW_IF(equal == std::string::npos, std::logic_error, "Invalid option '" << field << "' of sink '" << spec_ << "', expected OPTION=VALUE!");
+      const std::string key = field.substr(0, equal);
+      const std::string value = field.substr(equal + 1);
+      if (key == "waveform") sink_cfg.waveform.mode = snredbridge::waveform_mode_from_string(value);
+      else if (key == "roi-before") sink_cfg.waveform.roi_before = std::strtoul(value.c_str(), NULL, 10);
+      else if (key == "roi-after") sink_cfg.waveform.roi_after = std::strtoul(value.c_str(), NULL, 10);
+      else if (key == "select") sink_cfg.cuts.push_back(value);
+      else if (key == "codec") codec = value;
+      else if (key == "level") sink_cfg.output.writer.level = std::strtol(value.c_str(), NULL, 10);
+      else if (key == "compression-threads") sink_cfg.output.writer.compression_threads = std::strtoul(value.c_str(), NULL, 10);
+      else DT_THROW(std::logic_error, "Unknown option '" << key << "' of sink '" << spec_ << "'!");
+    }
+  DT_THROW_IF(sink_cfg.output.writer.filename.empty(), std::logic_error, "Missing output filename of sink '" << spec_ << "'!");
+  if (!codec.empty())
+    sink_cfg.output.writer.filename = snredbridge::filename_with_codec(sink_cfg.output.writer.filename,
+                                                                       snredbridge::compression_codec_from_string(codec));
+  return sink_cfg;
+}
+
+
+void run_conversion_job(conversion_job & job_)
+{
+  const snredbridge::stage_timer::clock_type::time_point start_time = snredbridge::stage_timer::clock_type::now();
+  try {
+    do_conversion_job(job_);
+  }
+  catch (std::exception & x) {
+    job_.error = x.what();
+  }
+  catch (...) {
+    job_.error = "unexpected error !";
+  }
+  job_.wall_time = std::chrono::duration<double>(snredbridge::stage_timer::clock_type::now() - start_time).count();
+  return;
+}
+
+
+void do_conversion_job(conversion_job & job_)
+{
+  conversion_config & config = job_.config;
+  snredbridge::udd_file_sequence::config_type & output_cfg = job_.output;
+  const datatools::logger::priority logging = config.logging;
+  const std::string & input_filename = job_.input_filenames.front();
+  std::string index_filename = job_.index_filename;
+  std::size_t end_record = job_.end_record;
+
+  // Index of the RED file, to start the conversion at any record without
+  // inflating the records before it
+  snredbridge::red_file_index red_index;
+  bool has_index = false;
+  if (job_.input_filenames.size() > 1)
+    DT_THROW_IF(!index_filename.empty(), std::logic_error, "An index is only available for a single RED file!");
+  else if (!index_filename.empty())
+    {
+      red_index.load(index_filename);
+      DT_THROW_IF(!red_index.matches(input_filename), std::runtime_error,
+                  "Index '" << index_filename << "' does not match RED file '" << input_filename << "'!");
+      has_index = true;
+    }
+  else if (snredbridge::get_file_size(snredbridge::red_file_index::default_filename(input_filename)) > 0)
+    {
+      index_filename = snredbridge::red_file_index::default_filename(input_filename);
+      red_index.load(index_filename);
+      has_index = red_index.matches(input_filename);
+      if (!has_index) DT_LOG_WARNING(logging, "Ignoring index '" << index_filename << "' which does not match the RED file!");
+    }
+
+  // Range of records to process
+  if (job_.shard_count > 0)
+    {
+      DT_THROW_IF(!has_index, std::logic_error, "Option --shard needs the index of the RED file (see red_bridge_index)!");
+      const std::size_t records = red_index.get_number_of_records();
+      config.first_record = job_.shard_index * records / job_.shard_count;
+      end_record = (job_.shard_index + 1) * records / job_.shard_count;
+      DT_LOG_INFORMATION(logging, "Shard " << job_.shard_index << "/" << job_.shard_count << " : records ["
+                         << config.first_record << ", " << end_record << ") of " << records);
+    }
+  if (has_index) config.first_record = std::min(config.first_record, red_index.get_number_of_records());
+  if (end_record != std::numeric_limits<std::size_t>::max())
+    {
+      config.data_count = std::min(config.data_count, end_record > config.first_record ? end_record - config.first_record : 0);
+      config.expected_events = config.data_count;
+    }
+  else if (has_index)
+    {
+      // The index counts the records of the file
+      config.expected_events = std::min(config.data_count, red_index.get_number_of_records() - config.first_record);
+    }
+
+  // Resume the conversion after the last record of its last checkpoint
+  const std::string inputs = join_filenames(job_.input_filenames);
+  snredbridge::conversion_checkpoint start;
+  start.input = inputs;
+  start.first_red_record = start.next_red_record = config.first_record;
+  if (job_.resume)
+    {
+      if (output_cfg.checkpoint_filename.empty())
+        output_cfg.checkpoint_filename = snredbridge::conversion_checkpoint::default_filename(output_cfg.writer.filename);
+      start.load(output_cfg.checkpoint_filename);
+      DT_THROW_IF(start.input != inputs, std::logic_error,
+                  "Checkpoint '" << output_cfg.checkpoint_filename << "' is for RED file '" << start.input << "'!");
+      DT_THROW_IF(start.first_red_record != config.first_record, std::logic_error,
+                  "Checkpoint '" << output_cfg.checkpoint_filename << "' is for a conversion starting at record #"
+                  << start.first_red_record << "!");
+      if (start.complete)
+        {
+          job_.already_complete = true;
+          job_.checkpoint = start;
+          return;
+        }
+      const std::size_t done = start.next_red_record - start.first_red_record;
+      config.data_count -= std::min(config.data_count, done);
+      if (config.expected_events > 0) config.expected_events = config.data_count;
+      config.first_record = start.next_red_record;
+      DT_LOG_INFORMATION(logging, "Resume at record #" << config.first_record << " after " << start.udd_records
+                         << " UDD records in " << start.parts.size() << " file(s)");
+    }
+
+  // Declare the writer
+  DT_LOG_DEBUG(logging, "Instantiate the UDD writer for '" << output_cfg.writer.filename << "'");
+  snredbridge::udd_file_sequence writer(output_cfg, start);
+  if (snredbridge::compression_codec_from_filename(output_cfg.writer.filename) == snredbridge::compression_codec::gzip
+      && (output_cfg.writer.level >= 0 || output_cfg.writer.compression_threads > 0))
+    DT_LOG_INFORMATION(logging, "Gzip compression in blocks with " << std::max(1u, output_cfg.writer.compression_threads) << " thread(s)");
+  DT_LOG_DEBUG(logging, "Initialization of the UDD writer is done.");
+
+  // Additional outputs, fed with the RED events read for the main output
+  sink_list sinks;
+  for (snredbridge::udd_sink::config_type sink_cfg : job_.sinks)
+    {
+      // Enough event records for all the events in flight in the conversion
+      // pipeline (see its pool of event records), plus a margin for the
+      // writer thread of the sink
+      sink_cfg.number_of_records = 16 + 9 * config.number_of_threads;
+      snredbridge::conversion_checkpoint sink_start;
+      sink_start.input = inputs;
+      sink_start.first_red_record = sink_start.next_red_record = config.first_record;
+      DT_LOG_DEBUG(logging, "Instantiate the UDD sink for '" << sink_cfg.output.writer.filename << "'");
+      sinks.emplace_back(new snredbridge::udd_sink(sink_cfg, sink_start));
+    }
+
+  // RED and UDD counters
+  conversion_counters & counters = job_.counters;
+
+  if (has_index && config.first_record > 0)
+    {
+      DT_LOG_INFORMATION(logging, "Start at record #" << config.first_record << " through index '" << index_filename << "'");
+      snredbridge::red_indexed_reader red_source(input_filename, red_index, config.first_record);
+      do_conversion(red_source, writer, sinks, job_.selection, config, counters);
+    }
+
+  else
+    {
+      /// Configuration for raw data reader, several files are read in a row
+      snfee::io::multifile_data_reader::config_type reader_cfg;
+      reader_cfg.filenames = job_.input_filenames;
+
+      // Declare the reader
+      DT_LOG_DEBUG(logging, "Instantiate the RED reader");
+      snfee::io::multifile_data_reader red_source(reader_cfg);
+
+      // Without index, the records before the first one are inflated and dropped
+      if (config.first_record > 0)
+        {
+          DT_LOG_WARNING(logging, "No index of the RED file: reading the " << config.first_record << " records before the first one");
+          snredbridge::stage_timer_guard skip_guard(counters.read_timer);
+          snfee::data::raw_event_data red;
+          for (std::size_t i = 0; i < config.first_record && red_source.has_record_tag(); i++)
+            red_source.load(red);
+        }
+      do_conversion(red_source, writer, sinks, job_.selection, config, counters);
+    }
+
+  // Close the output file, so that the compressed stream is fully flushed
+  counters.write_timer.start();
+  writer.close(config.first_record + counters.red);
+  counters.write_timer.stop();
+  for (auto & sink : sinks)
+    {
+      sink->close(config.first_record + counters.red);
+      sink_results results;
+      results.config = sink->get_config();
+      results.selection = sink->get_selection();
+      results.udd = sink->get_number_of_records();
+      results.write_timer = sink->get_write_timer();
+      results.output_filenames = sink->get_filenames();
+      job_.sinks_results.push_back(results);
+    }
+
+  // Output files and settings resolved by the writer
+  job_.output = writer.get_config();
+  job_.output_is_split = writer.is_split();
+  job_.output_has_checkpoints = writer.has_checkpoints();
+  job_.output_filenames = writer.get_filenames();
+  job_.checkpoint = writer.get_checkpoint();
+  return;
+}
+
+
+void write_run_statistics(const std::string & statistics_filename_,
+                          const std::vector<conversion_job> & jobs_)
+{
+  std::ofstream statistics_file(statistics_filename_);
+  DT_THROW_IF(!statistics_file, std::runtime_error, "Cannot open statistics file '" << statistics_filename_ << "'!");
+
+  // The statistics of the input files converted by separate jobs are added
+  snredbridge::run_statistics statistics;
+  for (const conversion_job & job : jobs_) statistics.merge(job.counters.statistics);
+
+  snredbridge::json_writer json(statistics_file);
+  json.begin_object();
+  json.value("program", "red_bridge");
+  json.begin_array("inputs");
+  for (const conversion_job & job : jobs_)
+    for (const std::string & input_filename : job.input_filenames) json.value("", input_filename);
+  json.end_array();
+  statistics.write(json);
+  json.end_object();
+  return;
+}
+
+
+std::string join_filenames(const std::vector<std::string> & filenames_)
+{
+  std::string joined;
+  for (const std::string & filename : filenames_)
+    {
+      if (!joined.empty()) joined += ' ';
+      joined += filename;
+    }
+  return joined;
+}
+
+
+std::size_t get_files_size(const std::vector<std::string> & filenames_)
+{
+  std::size_t size = 0;
+  for (const std::string & filename : filenames_) size += snredbridge::get_file_size(filename);
+  return size;
+}
+
+
+bool event_record_verifier::verify(const snfee::data::raw_event_data & red_,
+                                   const datatools::things & event_record_,
+                                   const conversion_config & config_)
+{
+  roundtrip.process(event_record_, stored_event_record);
+  const bool is_valid = snredbridge::compare_red_event_record(red_, stored_event_record,
+                                                              config_.logging, config_.no_waveform, config_.waveform);
+  if (!is_valid)
+    DT_LOG_WARNING(config_.logging, "Stored EH/UDD event is not equivalent to RED event for run #"
+                   << red_.get_run_id() << " event #" << red_.get_event_id());
+  return is_valid;
+}
+
+
+template <class Reader>
+void do_conversion(Reader & red_source_,
+                   snredbridge::udd_file_sequence & writer_,
+                   sink_list & sinks_,
+                   snredbridge::event_selection & selection_,
+                   const conversion_config & config_,
+                   conversion_counters & counters_)
+{
+  if (config_.number_of_threads > 1)
+    {
+      DT_LOG_INFORMATION(config_.logging, "Running the reader -> converters -> writer pipeline with " << config_.number_of_threads << " conversion threads");
+      do_multithreaded_conversion(red_source_, writer_, sinks_, selection_, config_, counters_);
+    }
+  else
+    do_serial_conversion(red_source_, writer_, sinks_, selection_, config_, counters_);
+  return;
+}
+
+
+template <class Reader>
+void do_serial_conversion(Reader & red_source_,
+                          snredbridge::udd_file_sequence & writer_,
+                          sink_list & sinks_,
+                          snredbridge::event_selection & selection_,
+                          const conversion_config & config_,
+                          conversion_counters & counters_)
+{
+  // Working RED object and ``datatools::things`` event record, reused for each event
+  DT_LOG_DEBUG(config_.logging, "Declare the datatools::things event record");
+  snfee::data::raw_event_data red;
+  datatools::things event_record;
+  event_record_verifier verifier(writer_.get_config().writer.filename);
+  snredbridge::progress_reporter progress(config_.progress_interval, config_.expected_events);
+  progress.set_label(config_.progress_label);
+
+  while (red_source_.has_record_tag() && counters_.red < config_.data_count)
+    {
+      // Check the serialization tag of the next record:
+      DT_THROW_IF(!red_source_.record_tag_is(snfee::data::raw_event_data::SERIAL_TAG),
+                  std::logic_error, "Unexpected record tag '" << red_source_.get_record_tag() << "'!");
+
+      // Load the next RED object. Waveforms are always decoded here, even
+      // with --no-waveform: the RED payload is deserialized as a whole by
+      // SNFEE, which does not offer a way to skip the calo waveforms.
+      counters_.read_timer.start();
+      red_source_.load(red);
+      counters_.read_timer.stop();
+      counters_.red++;
+      progress.update(counters_.red);
+
+      // Rejected events are dropped before any UDD object is built
+      if (selection_.has_cuts() && !selection_.select(red)) continue;
+      counters_.calo_hits += red.get_calo_hits().size();
+      counters_.tracker_hits += red.get_tracker_hits().size();
+
+      // Do the RED to UDD conversion and fill the Event record
+      counters_.conversion_timer.start();
+      snredbridge::prepare_event_record(event_record, counters_.udd);
+      snredbridge::do_red_to_udd_conversion(red, event_record, config_.waveform);
+      if (config_.fingerprint) snredbridge::store_fingerprint(red, config_.waveform, event_record);
+      if (config_.statistics)
+        {
+          counters_.statistics.fill(red);
+          counters_.statistics.fill_sequence(red);
+        }
+      counters_.conversion_timer.stop();
+
+      // Check the event record as it will be stored
+      if (config_.verify)
+        {
+          snredbridge::stage_timer_guard verification_guard(counters_.verification_timer);
+          counters_.verified++;
+          if (!verifier.verify(red, event_record, config_)) counters_.non_equal++;
+        }
+
+      counters_.write_timer.start();
+      writer_.process(event_record, config_.first_record + counters_.red - 1);
+      counters_.write_timer.stop();
+
+      // Additional outputs: converted here, written by their own thread
+      for (auto & sink : sinks_)
+        {
+          if (!sink->select(red)) continue;
+          datatools::things * sink_record = sink->acquire();
+          counters_.conversion_timer.start();
+          sink->convert(red, *sink_record);
+          counters_.conversion_timer.stop();
+          sink->push(sink_record, config_.first_record + counters_.red - 1);
+        }
+
+      counters_.udd++;
+      DT_LOG_DEBUG(config_.logging, "Exit do_red_to_udd_conversion");
+
+      // Smart print :
+      // event_record.tree_dump(std::clog, "The event data record composed by EH and UDD banks.");
+    } // (while red_source_.has_record_tag())
+
+  return;
+}
+
+
+template <class Reader>
+void do_multithreaded_conversion(Reader & red_source_,
+                                 snredbridge::udd_file_sequence & writer_,
+                                 sink_list & sinks_,
+                                 snredbridge::event_selection & selection_,
+                                 const conversion_config & config_,
+                                 conversion_counters & counters_)
+{
+  const unsigned int number_of_threads = config_.number_of_threads;
+
+  // RED event tagged with its position among the selected events and in the input file
+  struct red_job
+  {
+    std::size_t index = 0;
+    std::size_t record = 0;
+    std::unique_ptr<snfee::data::raw_event_data> red;
+    uint64_t sinks_mask = 0; ///< Sinks which selected the event
+  };
+
+  // Converted event record tagged with the position of its RED event
+  struct udd_job
+  {
+    std::size_t index = 0;
+    std::size_t record = 0;
+    std::unique_ptr<datatools::things> event_record;
+    std::vector<datatools::things *> sink_records; ///< Event record of each sink, null if not selected
+    bool verified = false;
+    bool is_valid = true;
+  };
+
+  // Keep a few events in flight per conversion thread
+  const std::size_t queue_capacity = 4 * number_of_threads;
+  snredbridge::bounded_queue<red_job> red_queue(queue_capacity);
+  snredbridge::bounded_queue<udd_job> udd_queue(queue_capacity);
+
+  // Pools of working RED objects and event records, recycled once an event
+  // has been converted (RED) or stored (event record)
+  const std::size_t red_pool_size = queue_capacity + number_of_threads;
+  const std::size_t record_pool_size = 2 * queue_capacity + number_of_threads;
+  snredbridge::bounded_queue<std::unique_ptr<snfee::data::raw_event_data>> red_pool(red_pool_size);
+  snredbridge::bounded_queue<std::unique_ptr<datatools::things>> record_pool(record_pool_size);
+  for (std::size_t i = 0; i < red_pool_size; i++)
+    red_pool.push(std::unique_ptr<snfee::data::raw_event_data>(new snfee::data::raw_event_data));
+  for (std::size_t i = 0; i < record_pool_size; i++)
+    record_pool.push(std::unique_ptr<datatools::things>(new datatools::things));
+
+  // First error raised by any stage, the whole pipeline stops on it
+  std::mutex error_mutex;
+  std::exception_ptr error;
+  std::atomic<bool> failed(false);
+  auto abort_pipeline = [&](std::exception_ptr error_)
+    {
+      {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) error = error_;
+      }
+      failed = true;
+      red_queue.close();
+      udd_queue.close();
+      red_pool.close();
+      record_pool.close();
+      for (auto & sink : sinks_) sink->abort();
+    };
+
+  // Reader stage: inflate and deserialize RED events in input order, drop
+  // the events rejected by the selection. Selected events are numbered
+  // contiguously for the writer.
+  std::size_t red_counter = 0;
+  std::size_t selected_counter = 0;
+  snredbridge::stage_timer read_timer;
+  // The statistics which depend on the order of the events are filled here
+  snredbridge::run_statistics sequence_statistics;
+  // The progress counts the RED records read, as expected_events does
+  snredbridge::progress_reporter progress(config_.progress_interval, config_.expected_events);
+  progress.set_label(config_.progress_label);
+  std::thread reader([&]
+    {
+      try {
+        while (!failed && red_source_.has_record_tag() && red_counter < config_.data_count)
+          {
+            DT_THROW_IF(!red_source_.record_tag_is(snfee::data::raw_event_data::SERIAL_TAG),
+                        std::logic_error, "Unexpected record tag '" << red_source_.get_record_tag() << "'!");
+            red_job job;
+            if (!red_pool.pop(job.red)) break;
+            job.record = config_.first_record + red_counter;
+            read_timer.start();
+            red_source_.load(*job.red);
+            read_timer.stop();
+            red_counter++;
+            progress.update(red_counter);
+            if (selection_.has_cuts() && !selection_.select(*job.red))
+              {
+                red_pool.push(std::move(job.red));
+                continue;
+              }
+            if (config_.statistics) sequence_statistics.fill_sequence(*job.red);
+            job.sinks_mask = 0;
+            for (std::size_t isink = 0; isink < sinks_.size(); isink++)
+              if (sinks_[isink]->select(*job.red)) job.sinks_mask |= uint64_t(1) << isink;
+            job.index = selected_counter++;
+            if (!red_queue.push(std::move(job))) break;
+          }
+        red_queue.close();
+      }
+      catch (...) {
+        abort_pipeline(std::current_exception());
+      }
+    });
+
+  // Conversion stage: the last worker to finish closes the output queue.
+  // A worker takes an event record from the pool before taking a RED event,
+  // so that the event the writer is waiting for never starves for a record.
+  std::atomic<unsigned int> running_workers(number_of_threads);
+  std::mutex merge_mutex;
+  std::vector<std::thread> workers;
+  for (unsigned int iworker = 0; iworker < number_of_threads; iworker++)
+    {
+      workers.emplace_back([&]
+        {
+          // Per worker counters, merged when the worker is done
+          conversion_counters worker_counters;
+          try {
+            event_record_verifier verifier(writer_.get_config().writer.filename);
+            red_job job;
+            udd_job converted;
+            while (!failed
+                   && record_pool.pop(converted.event_record)
+                   && red_queue.pop(job))
+              {
+                converted.index = job.index;
+                converted.record = job.record;
+                worker_counters.calo_hits += job.red->get_calo_hits().size();
+                worker_counters.tracker_hits += job.red->get_tracker_hits().size();
+                worker_counters.conversion_timer.start();
+                snredbridge::prepare_event_record(*converted.event_record, job.index);
+                snredbridge::do_red_to_udd_conversion(*job.red, *converted.event_record, config_.waveform);
+                if (config_.fingerprint) snredbridge::store_fingerprint(*job.red, config_.waveform, *converted.event_record);
+                if (config_.statistics) worker_counters.statistics.fill(*job.red);
+                converted.sink_records.assign(sinks_.size(), nullptr);
+                for (std::size_t isink = 0; isink < sinks_.size(); isink++)
+                  {
+                    if ((job.sinks_mask & (uint64_t(1) << isink)) == 0) continue;
+                    converted.sink_records[isink] = sinks_[isink]->acquire();
+                    if (converted.sink_records[isink] == nullptr) break;
+                    sinks_[isink]->convert(*job.red, *converted.sink_records[isink]);
+                  }
+                worker_counters.conversion_timer.stop();
+                converted.verified = config_.verify;
+                if (config_.verify)
+                  {
+                    snredbridge::stage_timer_guard verification_guard(worker_counters.verification_timer);
+                    converted.is_valid = verifier.verify(*job.red, *converted.event_record, config_);
+                  }
+                red_pool.push(std::move(job.red));
+                if (!udd_queue.push(std::move(converted))) break;
+              }
+          }
+          catch (...) {
+            abort_pipeline(std::current_exception());
+          }
+          {
+            std::lock_guard<std::mutex> lock(merge_mutex);
+            counters_.calo_hits += worker_counters.calo_hits;
+            counters_.tracker_hits += worker_counters.tracker_hits;
+            counters_.conversion_timer.merge(worker_counters.conversion_timer);
+            counters_.verification_timer.merge(worker_counters.verification_timer);
+            counters_.statistics.merge(worker_counters.statistics);
+          }
+          if (--running_workers == 0) udd_queue.close();
+        });
+    }
 
+  // Writer stage (this thread): restore the input order before storing
+  try {
+    std::map<std::size_t, udd_job> pending_records;
+    std::size_t next_index = 0;
+    udd_job converted;
+    while (!failed && udd_queue.pop(converted))
+      {
+        if (converted.verified)
+          {
+            counters_.verified++;
+            if (!converted.is_valid) counters_.non_equal++;
+          }
+        pending_records[converted.index] = std::move(converted);
+        auto found = pending_records.find(next_index);
+        while (found != pending_records.end())
+          {
+            counters_.write_timer.start();
+            writer_.process(*found->second.event_record, found->second.record);
+            counters_.write_timer.stop();
+            for (std::size_t isink = 0; isink < sinks_.size(); isink++)
+              if (found->second.sink_records[isink] != nullptr)
+                sinks_[isink]->push(found->second.sink_records[isink], found->second.record);
+            record_pool.push(std::move(found->second.event_record));
+            pending_records.erase(found);
+            counters_.udd++;
+            next_index++;
+            found = pending_records.find(next_index);
+          }
+      }
+    DT_LOG_DEBUG(config_.logging, "Writer stage is done with " << pending_records.size() << " pending record(s)");
+  }
+  catch (...) {
+    abort_pipeline(std::current_exception());
+  }
+
+  reader.join();
+  for (auto & worker : workers) worker.join();
+  counters_.red = red_counter;
+  counters_.read_timer.merge(read_timer);
+  counters_.statistics.merge(sequence_statistics);
+
+  if (error) std::rethrow_exception(error);
+  return;
+}
 
-void do_red_to_udd_conversion(const snfee::data::raw_event_data red_,
-                              datatools::things & event_record_,
-                              bool no_wf_)
+
+void print_job_results(const conversion_job & job_,
+                       const bool with_input_)
 {
-  // Run number
-  int32_t red_run_id   = red_.get_run_id();
-
-  // Event number
-  int32_t red_event_id = red_.get_event_id();
-
-  // Container of merged TriggerID(s) by event builder
-  const std::set<int32_t> & red_trigger_ids = red_.get_origin_trigger_ids();
-
-  // RED Digitized calo hits
-  const std::vector<snfee::data::calo_digitized_hit> red_calo_hits = red_.get_calo_hits();
-
-  // RED Digitized tracker hits
-  const std::vector<snfee::data::tracker_digitized_hit> red_tracker_hits = red_.get_tracker_hits();
-
-  // Print RED infos
-  // std::cout << "Event #" << red_event_id << " contains "
-  //           << red_trigger_ids.size() << " TriggerID(s) with "
-  //           << red_calo_hits.size() << " calo hit(s) and "
-  //           << red_tracker_hits.size() << " tracker hit(s)"
-  //           << std::endl;
-
-  std::string EH_output_tag  = "EH";
-  std::string UDD_output_tag = "UDD";
-
-  // Empty working EH object
-  // auto & EH = snedm::addToEvent<snemo::datamodel::event_header>(EH_output_tag, event_record_);
-  auto & EH = event_record_.add<snemo::datamodel::event_header>(EH_output_tag);
-
-  // Empty working UDD object
-  // auto & UDD = snedm::addToEvent<snemo::datamodel::unified_digitized_data>(UDD_output_tag, event_record_);
-  auto & UDD = event_record_.add<snemo::datamodel::unified_digitized_data>(UDD_output_tag);
-
-  // Fill Event Header based on RED attributes
-  EH.get_id().set_run_number(red_run_id);
-  EH.get_id().set_event_number(red_event_id);
-  EH.set_generation(snemo::datamodel::event_header::GENERATION_REAL);
-
-  // GO: we have to decide how we handle time and timestamp at Falaise level, commenting for now...
-  // EH.get_timestamp().set_seconds(1268644034);
-  // EH.get_timestamp().set_picoseconds(666);
-
-  // GO: we can add some additional properties to the Event Header
-  // EH.get_properties().store("simulation.bundle", "falaise");
-  // EH.get_properties().store("simulation.version", "0.1");
-  // EH.get_properties().store("author", std::string(getenv("USER")));
-
-
-  // Copy RED attributes to UDD attributes
-  UDD.set_run_id(red_run_id);
-  UDD.set_event_id(red_event_id);
-  UDD.set_reference_timestamp(red_.get_reference_time().get_ticks());
-  UDD.set_origin_trigger_ids(red_trigger_ids);
-  UDD.set_auxiliaries(red_.get_auxiliaries());
-
-  // Scan and copy RED calo digitized hit into UDD calo digitized hit:
-  for (std::size_t ihit = 0; ihit < red_calo_hits.size(); ihit++)
-    {
-      // std::clog << "DEBUG do_red_to_udd_conversion : Calo hit #" << ihit << std::endl;
-      snfee::data::calo_digitized_hit red_calo_hit = red_calo_hits[ihit];
-      snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit = UDD.add_calorimeter_hit();
-      udd_calo_hit.set_geom_id(red_calo_hit.get_geom_id());
-      // EC: fix wrong geom ID type (former bug in SNFEE's src/snfee/data/sncabling_bridge.cc)
-      if (udd_calo_hit.get_geom_id().get_type() == 1301)
-	udd_calo_hit.grab_geom_id().set_type(1302);
-      else if (udd_calo_hit.get_geom_id().get_type() == 1231)
-	udd_calo_hit.grab_geom_id().set_type(1232);
-      else if (udd_calo_hit.get_geom_id().get_type() == 1251)
-	udd_calo_hit.grab_geom_id().set_type(1252);
-      udd_calo_hit.set_hit_id(red_calo_hit.get_hit_id());
-      udd_calo_hit.set_timestamp(red_calo_hit.get_reference_time().get_ticks());
-      std::vector<int16_t> calo_waveform = red_calo_hit.get_waveform();
-      if (!no_wf_) udd_calo_hit.set_waveform(calo_waveform);
-      udd_calo_hit.set_low_threshold_only(red_calo_hit.is_low_threshold_only());
-      udd_calo_hit.set_high_threshold(red_calo_hit.is_high_threshold());
-      udd_calo_hit.set_fcr(red_calo_hit.get_fcr());
-      udd_calo_hit.set_lt_trigger_counter(red_calo_hit.get_lt_trigger_counter());
-      udd_calo_hit.set_lt_time_counter(red_calo_hit.get_lt_time_counter());
-      udd_calo_hit.set_fwmeas_baseline(red_calo_hit.get_fwmeas_baseline());
-      udd_calo_hit.set_fwmeas_peak_amplitude(red_calo_hit.get_fwmeas_peak_amplitude());
-      udd_calo_hit.set_fwmeas_peak_cell(red_calo_hit.get_fwmeas_peak_cell());
-      udd_calo_hit.set_fwmeas_charge(red_calo_hit.get_fwmeas_charge());
-      udd_calo_hit.set_fwmeas_rising_cell(red_calo_hit.get_fwmeas_rising_cell());
-      udd_calo_hit.set_fwmeas_falling_cell(red_calo_hit.get_fwmeas_falling_cell());
-      snemo::datamodel::calorimeter_digitized_hit::rtd_origin the_rtd_origin(red_calo_hit.get_origin().get_hit_number(),
-                                                                             red_calo_hit.get_origin().get_trigger_id());
-      udd_calo_hit.set_origin(the_rtd_origin);
-
-    } // end of for ihit
-
-
-
-  // Scan and copy RED tracker digitized hit into UDD calo digitized hit:
-  for (std::size_t ihit = 0; ihit < red_tracker_hits.size(); ihit++)
-    {
-      // std::clog << "DEBUG do_red_to_udd_conversion : Tracker hit #" << ihit << std::endl;
-      snfee::data::tracker_digitized_hit red_tracker_hit = red_tracker_hits[ihit];
-      snemo::datamodel::tracker_digitized_hit & udd_tracker_hit = UDD.add_tracker_hit();
-      udd_tracker_hit.set_geom_id(red_tracker_hit.get_geom_id());
-      udd_tracker_hit.set_hit_id(red_tracker_hit.get_hit_id());
-
-      // Do the loop on RED GG timestamps and convert them into UDD GG timestamps
-	  const std::vector<snfee::data::tracker_digitized_hit::gg_times> gg_timestamps_v = red_tracker_hit.get_times();
-
-      for (std::size_t iggtime = 0; iggtime < gg_timestamps_v.size(); iggtime++)
+  const conversion_counters & counters = job_.counters;
+  const double wall_time = job_.wall_time;
+  if (with_input_)
+    std::cout << "Results of '" << join_filenames(job_.input_filenames) << "' :" << std::endl;
+  else
+    std::cout << "Results :" << std::endl;
+  if (!job_.error.empty())
+    std::cout << "- Failed : " << job_.error << std::endl;
+  if (job_.already_complete)
+    {
+      std::cout << "- Conversion is already complete with " << job_.checkpoint.udd_records << " UDD records in "
+                << job_.checkpoint.parts.size() << " file(s)" << std::endl;
+      return;
+    }
+  std::cout << "- Worker #0 (input RED)"  << std::endl;
+  std::cout << "  - Processed records : " << counters.red << std::endl;
+  if (job_.selection.has_cuts())
+    {
+      std::cout << "  - Selected records  : " << job_.selection.get_selected() << std::endl;
+      std::cout << "  - Rejected records  : " << job_.selection.get_rejected() << std::endl;
+      for (const auto & cut : job_.selection.get_cut_counters())
+        std::cout << "    - Cut '" << cut.expression << "' : " << cut.passed << " passed / " << cut.tested << " tested" << std::endl;
+    }
+  std::cout << "- Worker #1 (output UDD)" << std::endl;
+  std::cout << "  - Stored records    : " << counters.udd << std::endl;
+  if (job_.output_is_split)
+    std::cout << "  - Output files      : " << job_.output_filenames.size()
+              << " (manifest '" << job_.output.manifest_filename << "')" << std::endl;
+  else if (with_input_)
+    std::cout << "  - Output file       : " << job_.output.writer.filename << std::endl;
+  if (job_.config.verify)
+    {
+      std::cout << "  - Verified records  : " << counters.verified << std::endl;
+      std::cout << "  - Non equal records : " << counters.non_equal << std::endl;
+    }
+  for (const sink_results & sink : job_.sinks_results)
+    {
+      std::cout << "- Sink '" << sink.config.output.writer.filename << "' (waveform mode "
+                << snredbridge::to_string(sink.config.waveform.mode) << ")" << std::endl;
+      if (sink.selection.has_cuts())
+        for (const auto & cut : sink.selection.get_cut_counters())
+          std::cout << "  - Cut '" << cut.expression << "' : " << cut.passed << " passed / " << cut.tested << " tested" << std::endl;
+      std::cout << "  - Stored records    : " << sink.udd << std::endl;
+      print_stage("Write UDD  ", sink.write_timer, wall_time);
+    }
+  std::cout << "- Timing (wall time " << wall_time << " s)" << std::endl;
+  print_stage("Read RED   ", counters.read_timer, wall_time);
+  print_stage("Conversion ", counters.conversion_timer, wall_time);
+  if (job_.config.verify) print_stage("Verification", counters.verification_timer, wall_time);
+  print_stage("Write UDD  ", counters.write_timer, wall_time);
+  if (wall_time > 0.0)
+    std::cout << "  - Rates : " << counters.udd / wall_time << " event(s)/s, "
+              << (counters.calo_hits + counters.tracker_hits) / wall_time << " hit(s)/s" << std::endl;
+  return;
+}
+
+
+void print_total_results(const std::vector<conversion_job> & jobs_,
+                         const double wall_time_)
+{
+  std::size_t failed = 0;
+  std::size_t red = 0;
+  std::size_t udd = 0;
+  std::size_t non_equal = 0;
+  for (const conversion_job & job : jobs_)
+    {
+      if (!job.error.empty()) failed++;
+      red += job.counters.red;
+      udd += job.counters.udd;
+      non_equal += job.counters.non_equal;
+    }
+  std::cout << "Total of " << jobs_.size() << " input files :" << std::endl;
+  if (failed > 0)
+    std::cout << "- Failed conversions : " << failed << std::endl;
+  std::cout << "- Processed RED records : " << red << std::endl;
+  std::cout << "- Stored UDD records    : " << udd << std::endl;
+  if (non_equal > 0)
+    std::cout << "- Non equal records     : " << non_equal << std::endl;
+  std::cout << "- Wall time : " << wall_time_ << " s";
+  if (wall_time_ > 0.0) std::cout << ", " << udd / wall_time_ << " event(s)/s";
+  std::cout << std::endl;
+  return;
+}
+
+
+void print_stage(const std::string & label_,
+                 const snredbridge::stage_timer & timer_,
+                 const double wall_time_)
+{
+  std::cout << "  - " << label_ << " : " << timer_.get_seconds() << " s";
+  if (wall_time_ > 0.0) std::cout << " (" << 100.0 * timer_.get_seconds() / wall_time_ << " % of wall time)";
+  std::cout << std::endl;
+  return;
+}
+
+
+void write_run_summary(const std::string & summary_filename_,
+                       const std::vector<conversion_job> & jobs_,
+                       const double wall_time_)
+{
+  std::ofstream summary_file(summary_filename_);
+  DT_THROW_IF(!summary_file, std::runtime_error, "Cannot open summary file '" << summary_filename_ << "'!");
+
+  snredbridge::json_writer json(summary_file);
+  json.begin_object();
+  json.value("program", "red_bridge");
+  if (jobs_.size() == 1)
+    write_job_summary(json, jobs_.front());
+  else
+    {
+      // Totals over the jobs, then the summary of each job
+      std::size_t red = 0;
+      std::size_t udd = 0;
+      std::size_t failed = 0;
+      std::size_t bytes_in = 0;
+      std::size_t bytes_out = 0;
+      for (const conversion_job & job : jobs_)
+        {
+          red += job.counters.red;
+          udd += job.counters.udd;
+          if (!job.error.empty()) failed++;
+          bytes_in += get_files_size(job.input_filenames);
+          bytes_out += get_files_size(job.output_filenames);
+        }
+      json.value("conversions", jobs_.size());
+      json.value("failed_conversions", failed);
+      json.value("red_records", red);
+      json.value("udd_records", udd);
+      json.value("bytes_in", bytes_in);
+      json.value("bytes_out", bytes_out);
+      json.value("wall_time_s", wall_time_);
+      json.value("events_per_s", udd / (wall_time_ > 0.0 ? wall_time_ : 1.0));
+    }
+  json.value("peak_rss_kb", snredbridge::get_peak_rss_kb());
+  if (jobs_.size() > 1)
+    {
+      json.begin_array("jobs");
+      for (const conversion_job & job : jobs_)
         {
-          // std::clog << "DEBUG do_red_to_udd_conversion : Tracker hit #" << ihit << " Geiger Time #" << iggtime <<  std::endl;
-          // Retrieve RED GG timestamps
-	      const snfee::data::tracker_digitized_hit::gg_times & a_gg_timestamp = gg_timestamps_v[iggtime];
-
-          // Create empty UDD GG timestamps
-          snemo::datamodel::tracker_digitized_hit::gg_times & udd_gg_timestamp = udd_tracker_hit.add_times();
-
-          // Fill UDD anode and cathode timestamps and RTD origin for backtracing
-          snemo::datamodel::tracker_digitized_hit::rtd_origin anode_r0_rtd_origin(a_gg_timestamp.get_anode_origin(snfee::data::tracker_digitized_hit::ANODE_R0).get_hit_number(),
-                                                                                  a_gg_timestamp.get_anode_origin(snfee::data::tracker_digitized_hit::ANODE_R0).get_trigger_id());
-          udd_gg_timestamp.set_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R0,
-                                            anode_r0_rtd_origin);
-          udd_gg_timestamp.set_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R0,
-                                          a_gg_timestamp.get_anode_time(snfee::data::tracker_digitized_hit::ANODE_R0).get_ticks());
-
-          snemo::datamodel::tracker_digitized_hit::rtd_origin anode_r1_rtd_origin(a_gg_timestamp.get_anode_origin(snfee::data::tracker_digitized_hit::ANODE_R1).get_hit_number(),
-                                                                                  a_gg_timestamp.get_anode_origin(snfee::data::tracker_digitized_hit::ANODE_R1).get_trigger_id());
-          udd_gg_timestamp.set_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R1,
-                                            anode_r1_rtd_origin);
-          udd_gg_timestamp.set_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R1,
-                                          a_gg_timestamp.get_anode_time(snfee::data::tracker_digitized_hit::ANODE_R1).get_ticks());
-
-          snemo::datamodel::tracker_digitized_hit::rtd_origin anode_r2_rtd_origin(a_gg_timestamp.get_anode_origin(snfee::data::tracker_digitized_hit::ANODE_R2).get_hit_number(),
-                                                                                  a_gg_timestamp.get_anode_origin(snfee::data::tracker_digitized_hit::ANODE_R2).get_trigger_id());
-          udd_gg_timestamp.set_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R2,
-                                            anode_r2_rtd_origin);
-          udd_gg_timestamp.set_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R2,
-                                          a_gg_timestamp.get_anode_time(snfee::data::tracker_digitized_hit::ANODE_R2).get_ticks());
-
-          snemo::datamodel::tracker_digitized_hit::rtd_origin anode_r3_rtd_origin(a_gg_timestamp.get_anode_origin(snfee::data::tracker_digitized_hit::ANODE_R3).get_hit_number(),
-                                                                                  a_gg_timestamp.get_anode_origin(snfee::data::tracker_digitized_hit::ANODE_R3).get_trigger_id());
-          udd_gg_timestamp.set_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R3,
-                                            anode_r3_rtd_origin);
-          udd_gg_timestamp.set_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R3,
-                                          a_gg_timestamp.get_anode_time(snfee::data::tracker_digitized_hit::ANODE_R3).get_ticks());
-
-          snemo::datamodel::tracker_digitized_hit::rtd_origin anode_r4_rtd_origin(a_gg_timestamp.get_anode_origin(snfee::data::tracker_digitized_hit::ANODE_R4).get_hit_number(),
-                                                                                  a_gg_timestamp.get_anode_origin(snfee::data::tracker_digitized_hit::ANODE_R4).get_trigger_id());
-          udd_gg_timestamp.set_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R4,
-                                            anode_r4_rtd_origin);
-          udd_gg_timestamp.set_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R4,
-                                          a_gg_timestamp.get_anode_time(snfee::data::tracker_digitized_hit::ANODE_R4).get_ticks());
-
-          snemo::datamodel::tracker_digitized_hit::rtd_origin bottom_cathode_rtd_origin(a_gg_timestamp.get_bottom_cathode_origin().get_hit_number(),
-                                                                                        a_gg_timestamp.get_bottom_cathode_origin().get_trigger_id());
-          udd_gg_timestamp.set_bottom_cathode_origin(bottom_cathode_rtd_origin);
-          udd_gg_timestamp.set_bottom_cathode_time(a_gg_timestamp.get_bottom_cathode_time().get_ticks());
-
-
-          snemo::datamodel::tracker_digitized_hit::rtd_origin top_cathode_rtd_origin(a_gg_timestamp.get_top_cathode_origin().get_hit_number(),
-                                                                                     a_gg_timestamp.get_top_cathode_origin().get_trigger_id());
-          udd_gg_timestamp.set_top_cathode_origin(top_cathode_rtd_origin);
-          udd_gg_timestamp.set_top_cathode_time(a_gg_timestamp.get_top_cathode_time().get_ticks());
-
-
-	    } // end of iggtime
-
-    } // end for ihit
-
-  // red_.print_tree(std::clog);
-  // EH.tree_dump(std::clog, "Event header('EH'): ");
-  // UDD.tree_dump(std::clog, "Unified Digitized Data('UDD'): ");
+          json.begin_object();
+          write_job_summary(json, job);
+          json.end_object();
+        }
+      json.end_array();
+    }
+  json.end_object();
+  return;
+}
+
 
+void write_job_summary(snredbridge::json_writer & json_,
+                       const conversion_job & job_)
+{
+  const snredbridge::udd_writer::config_type & writer_cfg = job_.output.writer;
+  const conversion_config & config = job_.config;
+  const conversion_counters & counters = job_.counters;
+  const snredbridge::event_selection & selection = job_.selection;
+  const std::size_t bytes_in = get_files_size(job_.input_filenames);
+  const std::size_t bytes_out = get_files_size(job_.output_filenames);
+  const double wall_time = job_.wall_time;
+  const double rate_denominator = wall_time > 0.0 ? wall_time : 1.0;
+
+  json_.value("input", join_filenames(job_.input_filenames));
+  if (job_.input_filenames.size() > 1)
+    {
+      json_.begin_array("inputs");
+      for (const std::string & input_filename : job_.input_filenames)
+        json_.value("", input_filename);
+      json_.end_array();
+    }
+  json_.value("output", writer_cfg.filename);
+  if (!job_.error.empty()) json_.value("error", job_.error);
+  if (job_.already_complete) json_.value("already_complete", true);
+  if (job_.output_has_checkpoints)
+    json_.value("checkpoint", job_.output.checkpoint_filename);
+  if (job_.output_is_split)
+    {
+      json_.value("manifest", job_.output.manifest_filename);
+      json_.begin_array("output_files");
+      for (const std::string & output_filename : job_.output_filenames)
+        json_.value("", output_filename);
+      json_.end_array();
+    }
+  json_.value("codec", snredbridge::to_string(snredbridge::compression_codec_from_filename(writer_cfg.filename)));
+  if (writer_cfg.level >= 0) json_.value("compression_level", writer_cfg.level);
+  json_.value("compression_threads", writer_cfg.compression_threads);
+  json_.value("threads", config.number_of_threads);
+  json_.value("no_waveform", config.no_waveform);
+  json_.value("waveform_mode", snredbridge::to_string(config.waveform.mode));
+  json_.value("fingerprint", config.fingerprint);
+  json_.value("first_record", config.first_record);
+  json_.value("red_records", counters.red);
+  json_.value("udd_records", counters.udd);
+  if (selection.has_cuts())
+    {
+      json_.value("selected_records", selection.get_selected());
+      json_.value("rejected_records", selection.get_rejected());
+      json_.begin_array("selection");
+      for (const auto & cut : selection.get_cut_counters())
+        {
+          json_.begin_object();
+          json_.value("cut", cut.expression);
+          json_.value("tested", cut.tested);
+          json_.value("passed", cut.passed);
+          json_.end_object();
+        }
+      json_.end_array();
+    }
+  json_.value("calo_hits", counters.calo_hits);
+  json_.value("tracker_hits", counters.tracker_hits);
+  if (config.verify)
+    {
+      json_.value("verified_records", counters.verified);
+      json_.value("non_equal_records", counters.non_equal);
+    }
+  json_.value("bytes_in", bytes_in);
+  json_.value("bytes_out", bytes_out);
+  json_.value("wall_time_s", wall_time);
+  json_.value("events_per_s", counters.udd / rate_denominator);
+  json_.value("hits_per_s", (counters.calo_hits + counters.tracker_hits) / rate_denominator);
+  json_.begin_object("stages");
+  const std::pair<const char *, const snredbridge::stage_timer *> stages[] = {
+    {"read", &counters.read_timer},
+    {"conversion", &counters.conversion_timer},
+    {"verification", &counters.verification_timer},
+    {"write", &counters.write_timer}
+  };
+  for (const auto & stage : stages)
+    {
+      json_.begin_object(stage.first);
+      json_.value("time_s", stage.second->get_seconds());
+      json_.value("calls", stage.second->get_calls());
+      json_.end_object();
+    }
+  json_.end_object();
+  if (!job_.sinks_results.empty())
+    {
+      json_.begin_array("sinks");
+      for (const sink_results & sink : job_.sinks_results)
+        {
+          const snredbridge::udd_writer::config_type & sink_writer_cfg = sink.config.output.writer;
+          json_.begin_object();
+          json_.value("output", sink_writer_cfg.filename);
+          json_.value("codec", snredbridge::to_string(snredbridge::compression_codec_from_filename(sink_writer_cfg.filename)));
+          if (sink_writer_cfg.level >= 0) json_.value("compression_level", sink_writer_cfg.level);
+          json_.value("compression_threads", sink_writer_cfg.compression_threads);
+          json_.value("waveform_mode", snredbridge::to_string(sink.config.waveform.mode));
+          if (sink.selection.has_cuts())
+            {
+              json_.value("selected_records", sink.selection.get_selected());
+              json_.value("rejected_records", sink.selection.get_rejected());
+              json_.begin_array("selection");
+              for (const auto & cut : sink.selection.get_cut_counters())
+                {
+                  json_.begin_object();
+                  json_.value("cut", cut.expression);
+                  json_.value("tested", cut.tested);
+                  json_.value("passed", cut.passed);
+                  json_.end_object();
+                }
+              json_.end_array();
+            }
+          json_.value("udd_records", sink.udd);
+          json_.value("bytes_out", get_files_size(sink.output_filenames));
+          json_.value("write_time_s", sink.write_timer.get_seconds());
+          json_.end_object();
+        }
+      json_.end_array();
+    }
   return;
 }
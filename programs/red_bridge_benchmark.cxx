@@ -0,0 +1,294 @@
+// Standard library:
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/archives_list.h>
+#include <bayeux/datatools/logger.h>
+#include <bayeux/datatools/things.h>
+
+// - SNFEE:
+#include <snfee/snfee.h>
+#include <snfee/data/raw_event_data.h>
+
+// This project:
+#include <snredbridge/red_event_generator.h>
+#include <snredbridge/red_to_udd_conversion.h>
+#include <snredbridge/red_udd_comparison.h>
+#include <snredbridge/udd_writer.h>
+#include <snredbridge/waveform_codec.h>
+
+
+std::size_t red_payload_size(const std::vector<snfee::data::raw_event_data> &);
+
+void print_rate(const std::string &,
+                const std::size_t,
+                const std::size_t,
+                const double);
+
+
+// Number of heap allocations done by the whole process, used to check that
+// the conversion hot path stays (nearly) allocation free. It is only
+// installed in the benchmark: the counter would be contended by all the
+// threads of the converter.
+static std::atomic<std::size_t> heap_allocation_counter(0);
+
+void * operator new(std::size_t size_)
+{
+  heap_allocation_counter.fetch_add(1, std::memory_order_relaxed);
+  void * ptr = std::malloc(size_ == 0 ? 1 : size_);
+  if (ptr == nullptr) throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void * ptr_) noexcept
+{
+  std::free(ptr_);
+}
+
+void operator delete(void * ptr_, std::size_t) noexcept
+{
+  std::free(ptr_);
+}
+
+//----------------------------------------------------------------------
+// MAIN PROGRAM
+//----------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  datatools::logger::priority logging = datatools::logger::PRIO_WARNING;
+  int error_code = EXIT_SUCCESS;
+  try {
+  std::string output_filename = "red_bridge_benchmark_udd.data.gz";
+  size_t data_count = 1000;
+  bool no_waveform = false;
+  snredbridge::waveform_config waveform_cfg;
+  std::string output_codec = "";
+  snredbridge::udd_writer::config_type writer_cfg;
+  snredbridge::red_event_generator::config_type generator_cfg;
+
+  for (int iarg=1; iarg<argc; ++iarg)
+    {
+      std::string arg (argv[iarg]);
+      if (arg[0] == '-')
+        {
+          if ((arg == "-d") || (arg == "--debug"))
+            logging = datatools::logger::PRIO_DEBUG;
+
+          else if ((arg == "-v") || (arg == "--verbose"))
+            logging = datatools::logger::PRIO_INFORMATION;
+
+          else if ((arg=="-o") || (arg=="--output"))
+            output_filename = std::string(argv[++iarg]);
+
+          else if ((arg == "-n") || (arg == "--events"))
+            data_count = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if ((arg == "-no-wf") || (arg == "--no-waveform"))
+            no_waveform = true;
+
+          else if (arg == "--calo-hits")
+            generator_cfg.number_of_calo_hits = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg == "--waveform-length")
+            generator_cfg.waveform_length = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg == "--tracker-hits")
+            generator_cfg.number_of_tracker_hits = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg == "--gg-times")
+            generator_cfg.number_of_gg_times = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg == "--seed")
+            generator_cfg.seed = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg == "--waveform-mode")
+            waveform_cfg.mode = snredbridge::waveform_mode_from_string(argv[++iarg]);
+
+          else if (arg == "--codec")
+            output_codec = std::string(argv[++iarg]);
+
+          else if (arg == "--level")
+            writer_cfg.level = std::strtol(argv[++iarg], NULL, 10);
+
+          else if (arg == "--compression-threads")
+            writer_cfg.compression_threads = std::strtoul(argv[++iarg], NULL, 10);
+
+          else if (arg=="-h" || arg=="--help")
+            {
+              std::cout << std::endl;
+              std::cout << "Usage:   " << argv[0] << " [options]" << std::endl;
+              std::cout << std::endl;
+              std::cout << "Options:   -h / --help" << std::endl;
+              std::cout << "           -o / --output      UDD_FILE written by the serialization benchmark" << std::endl;
+              std::cout << "           -n / --events      Number of synthetic events (default: 1000)" << std::endl;
+              std::cout << "           -no-wf / --no-waveform Do not save the waveform from RED to UDD" << std::endl;
+              std::cout << "           --calo-hits        Number of calo hits per event (default: 10)" << std::endl;
+              std::cout << "           --waveform-length  Number of samples per calo waveform (default: 1024)" << std::endl;
+              std::cout << "           --tracker-hits     Number of tracker hits per event (default: 50)" << std::endl;
+              std::cout << "           --gg-times         Number of GG times per tracker hit (default: 1)" << std::endl;
+              std::cout << "           --seed             Seed of the event generator" << std::endl;
+              std::cout << "           --waveform-mode    Waveform storage: full, roi or packed (default: full)" << std::endl;
+              std::cout << "           --codec            Output compression: gzip, bzip2 or none" << std::endl;
+              std::cout << "           --level            Gzip compression level from 1 (fast) to 9 (small)" << std::endl;
+              std::cout << "           --compression-threads Number of gzip block compression threads" << std::endl;
+              std::cout << "           -v / --verbose     More logs" << std::endl;
+              std::cout << "           -d / --debug       Debug logs" << std::endl;
+              std::cout << std::endl;
+              return 0;
+            }
+
+          else
+            DT_LOG_WARNING(logging, "Ignoring option '" << arg << "' !");
+        }
+    }
+
+  if (no_waveform) waveform_cfg.mode = snredbridge::waveform_mode::none;
+
+  DT_LOG_INFORMATION(logging, "SNREDBridge benchmark : timing the RED to UDD conversion, serialization and validation on synthetic events");
+
+  snfee::initialize();
+
+  typedef std::chrono::steady_clock clock_type;
+
+  // Generate all the RED events before any measurement
+  DT_LOG_DEBUG(logging, "Generate " << data_count << " synthetic RED events");
+  snredbridge::red_event_generator generator(generator_cfg);
+  std::vector<snfee::data::raw_event_data> red_events(data_count);
+  for (auto & red : red_events) generator.generate(red);
+  const std::size_t payload_size = red_payload_size(red_events);
+
+  std::vector<std::unique_ptr<datatools::things>> event_records;
+  event_records.reserve(data_count);
+  for (std::size_t ievent = 0; ievent < data_count; ievent++)
+    event_records.emplace_back(new datatools::things);
+
+  // Conversion
+  DT_LOG_DEBUG(logging, "Benchmark the conversion");
+  clock_type::time_point start = clock_type::now();
+  for (std::size_t ievent = 0; ievent < data_count; ievent++)
+    {
+      snredbridge::prepare_event_record(*event_records[ievent], ievent);
+      snredbridge::do_red_to_udd_conversion(red_events[ievent], *event_records[ievent], waveform_cfg);
+    }
+  const double conversion_time = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  // Heap allocations of a conversion into an event record already used,
+  // as red_bridge does in its loops
+  const std::size_t heap_allocations_at_start = heap_allocation_counter.load();
+  for (std::size_t ievent = 0; ievent < data_count; ievent++)
+    {
+      snredbridge::prepare_event_record(*event_records[ievent], ievent);
+      snredbridge::do_red_to_udd_conversion(red_events[ievent], *event_records[ievent], waveform_cfg);
+    }
+  const double allocations_per_event = data_count > 0 ?
+    double(heap_allocation_counter.load() - heap_allocations_at_start) / data_count : 0.0;
+
+  // Serialization through the output module
+  if (!output_codec.empty())
+    output_filename = snredbridge::filename_with_codec(output_filename,
+                                                       snredbridge::compression_codec_from_string(output_codec));
+  writer_cfg.filename = output_filename;
+  DT_LOG_DEBUG(logging, "Benchmark the serialization into '" << output_filename << "'");
+  double serialization_time = 0.0;
+  {
+    snredbridge::udd_writer writer(writer_cfg);
+    start = clock_type::now();
+    for (std::size_t ievent = 0; ievent < data_count; ievent++)
+      writer.process(*event_records[ievent]);
+    // Closing the output file flushes the compressor
+    writer.reset();
+    serialization_time = std::chrono::duration<double>(clock_type::now() - start).count();
+  }
+  std::ifstream output_file(output_filename, std::ios::binary | std::ios::ate);
+  const std::size_t output_size = output_file ? std::size_t(output_file.tellg()) : 0;
+
+  // Validation
+  DT_LOG_DEBUG(logging, "Benchmark the validation");
+  std::size_t non_equal_counter = 0;
+  start = clock_type::now();
+  for (std::size_t ievent = 0; ievent < data_count; ievent++)
+    {
+      if (!snredbridge::compare_red_event_record(red_events[ievent], *event_records[ievent], logging, no_waveform, waveform_cfg))
+        non_equal_counter++;
+    }
+  const double validation_time = std::chrono::duration<double>(clock_type::now() - start).count();
+
+  std::cout << "Results :" << std::endl;
+  std::cout << "- Events : " << data_count << " with " << generator_cfg.number_of_calo_hits << " calo hit(s) of "
+            << generator_cfg.waveform_length << " sample(s) and " << generator_cfg.number_of_tracker_hits
+            << " tracker hit(s) of " << generator_cfg.number_of_gg_times << " GG time(s)" << std::endl;
+  std::cout << "- RED payload : " << payload_size / 1.0e6 << " MB" << std::endl;
+  std::cout << "- UDD output  : " << output_size / 1.0e6 << " MB" << std::endl;
+  print_rate("Conversion    (RED payload)", data_count, payload_size, conversion_time);
+  print_rate("Serialization (UDD output) ", data_count, output_size, serialization_time);
+  print_rate("Validation    (RED payload)", data_count, payload_size, validation_time);
+  std::cout << "- Heap allocations per event : " << allocations_per_event << " (conversion into a reused event record)" << std::endl;
+  std::cout << "- Non equal events : " << non_equal_counter << std::endl;
+
+  if (non_equal_counter > 0) error_code = EXIT_FAILURE;
+
+  snfee::terminate();
+
+  DT_LOG_INFORMATION(logging, "The end.");
+  }
+
+
+  catch (std::exception & x) {
+    DT_LOG_FATAL(logging, x.what());
+    error_code = EXIT_FAILURE;
+  }
+  catch (...) {
+    DT_LOG_FATAL(logging, "unexpected error !");
+    error_code = EXIT_FAILURE;
+  }
+  return (error_code);
+}
+
+
+std::size_t red_payload_size(const std::vector<snfee::data::raw_event_data> & red_events_)
+{
+  // Uncompressed size of the events stored as in a ".data.gz" RED file: the
+  // serialization tag and the event of each record in a portable binary archive
+  std::ostringstream buffer;
+  {
+    eos::portable_oarchive archive(buffer);
+    for (const auto & red : red_events_)
+      {
+        archive << snfee::data::raw_event_data::SERIAL_TAG;
+        archive << red;
+      }
+  }
+  return static_cast<std::size_t>(buffer.tellp());
+}
+
+
+void print_rate(const std::string & label_,
+                const std::size_t number_of_events_,
+                const std::size_t number_of_bytes_,
+                const double seconds_)
+{
+  std::cout << "- " << label_ << " : ";
+  if (seconds_ <= 0.0)
+    {
+      std::cout << "not measurable" << std::endl;
+      return;
+    }
+  std::cout << number_of_events_ / seconds_ << " events/s, "
+            << number_of_bytes_ / 1.0e6 / seconds_ << " MB/s"
+            << " (" << seconds_ << " s)" << std::endl;
+  return;
+}
@@ -0,0 +1,112 @@
+// Standard library:
+#include <cstdio>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <chrono>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/logger.h>
+
+// - SNFEE:
+#include <snfee/snfee.h>
+
+// This project:
+#include <snredbridge/red_file_index.h>
+
+//----------------------------------------------------------------------
+// MAIN PROGRAM
+//----------------------------------------------------------------------
+
+int main (int argc, char *argv[])
+{
+  datatools::logger::priority logging = datatools::logger::PRIO_WARNING;
+  int error_code = EXIT_SUCCESS;
+  try {
+  std::string input_filename = "";
+  std::string index_filename = "";
+  uint64_t spacing = snredbridge::red_file_index::DEFAULT_SPACING;
+
+  for (int iarg=1; iarg<argc; ++iarg)
+    {
+      std::string arg (argv[iarg]);
+      if (arg[0] == '-')
+        {
+          if ((arg == "-d") || (arg == "--debug"))
+            logging = datatools::logger::PRIO_DEBUG;
+
+          else if ((arg == "-v") || (arg == "--verbose"))
+            logging = datatools::logger::PRIO_INFORMATION;
+
+          else if ((arg=="-i") || (arg=="--input"))
+            input_filename = std::string(argv[++iarg]);
+
+          else if ((arg=="-o") || (arg=="--output"))
+            index_filename = std::string(argv[++iarg]);
+
+          else if (arg == "--spacing")
+            spacing = std::strtoull(argv[++iarg], NULL, 10) * 1024 * 1024;
+
+          else if (arg=="-h" || arg=="--help")
+            {
+              std::cout << std::endl;
+              std::cout << "Usage:   " << argv[0] << " [options]" << std::endl;
+              std::cout << std::endl;
+              std::cout << "Options:   -h / --help" << std::endl;
+              std::cout << "           -i / --input       RED_FILE (gzip compressed)" << std::endl;
+              std::cout << "           -o / --output      INDEX_FILE (default: RED_FILE.idx)" << std::endl;
+              std::cout << "           --spacing          MB of uncompressed data between two checkpoints (default: 16)" << std::endl;
+              std::cout << "           -v / --verbose     More logs" << std::endl;
+              std::cout << "           -d / --debug       Debug logs" << std::endl;
+              std::cout << std::endl;
+              return 0;
+            }
+
+          else
+            DT_LOG_WARNING(logging, "Ignoring option '" << arg << "' !");
+        }
+    }
+
+  if (input_filename.empty())
+    {
+      std::cerr << "*** ERROR: missing input filename !" << std::endl;
+      return 1;
+    }
+  if (index_filename.empty())
+    index_filename = snredbridge::red_file_index::default_filename(input_filename);
+  DT_THROW_IF(spacing == 0, std::logic_error, "Invalid checkpoint spacing!");
+
+  DT_LOG_INFORMATION(logging, "SNREDBridge index : indexing the records of RED file '" << input_filename << "'");
+
+  snfee::initialize();
+
+  const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+  snredbridge::red_file_index index;
+  index.build(input_filename, spacing);
+  index.save(index_filename);
+  const double wall_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+  std::cout << "Index '" << index_filename << "' :" << std::endl;
+  std::cout << "- Records       : " << index.get_number_of_records() << std::endl;
+  std::cout << "- Checkpoints   : " << index.get_number_of_checkpoints() << std::endl;
+  std::cout << "- Prime records : " << index.get_number_of_prime_records() << std::endl;
+  std::cout << "- Wall time     : " << wall_time << " s" << std::endl;
+
+  snfee::terminate();
+
+  DT_LOG_INFORMATION(logging, "The end.");
+  }
+
+
+  catch (std::exception & x) {
+    DT_LOG_FATAL(logging, x.what());
+    error_code = EXIT_FAILURE;
+  }
+  catch (...) {
+    DT_LOG_FATAL(logging, "unexpected error !");
+    error_code = EXIT_FAILURE;
+  }
+  return (error_code);
+}
@@ -1,11 +1,18 @@
 // Standard library:
 #include <cstdio>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
 #include <exception>
 #include <stdexcept>
 #include <memory>
 #include <string>
 #include <vector>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 // Third party:
 // - Bayeux:
@@ -23,11 +30,208 @@
 #include <snfee/io/multifile_data_reader.h>
 #include <snfee/data/raw_event_data.h>
 
+// This project:
+#include <snredbridge/event_matcher.h>
+#include <snredbridge/event_selection.h>
+#include <snredbridge/red_udd_comparison.h>
+#include <snredbridge/event_fingerprint.h>
+#include <snredbridge/bounded_queue.h>
+#include <snredbridge/mismatch_report.h>
+#include <snredbridge/event_sampler.h>
 
-bool compare_red_event_record(const snfee::data::raw_event_data &,
-                              const datatools::things &,
-                              const datatools::logger::priority &,
-                              bool);
+
+/// Settings of the comparison of the matched events
+struct validation_config
+{
+  bool no_waveform = false;
+  snredbridge::waveform_config waveform; ///< Roi margins of the events without fingerprint scheme
+  bool fast = false;
+  bool sampling = false;              ///< Only the sampled events are checked in depth
+  snredbridge::event_sampler sampler;
+};
+
+/// Pair of matched events, numbered in matching order
+struct event_pair
+{
+  std::size_t sequence = 0;
+  std::unique_ptr<snfee::data::raw_event_data> red;
+  std::unique_ptr<datatools::things> event_record;
+};
+
+/// Event read from one of the input streams, with its position in the stream
+template <typename T>
+struct input_event
+{
+  std::size_t position = 0;
+  std::unique_ptr<T> data;
+};
+
+/// Output of the non equivalent events, shared by the comparison workers
+struct mismatch_output
+{
+  snredbridge::mismatch_report * report = nullptr; ///< Differences of the first events in sequence order
+  std::size_t max_display = 0;                     ///< Number of events printed in debug mode
+  std::atomic<std::size_t> displayed{0};
+  std::mutex display_mutex;
+};
+
+/// Results of the comparison of the matched events, one instance per
+/// comparison worker, merged at the end
+struct validation_results
+{
+  std::size_t er_counter = 0;
+  std::size_t eh_counter = 0;
+  std::size_t udd_counter = 0;
+
+  // Non equal events counter during comparison function (for debug purpose)
+  std::size_t non_equal_event_counter = 0;
+
+  // Events validated by their fingerprint, and events compared field by field in fast mode
+  std::size_t fingerprint_match_counter = 0;
+  std::size_t fingerprint_mismatch_counter = 0;
+  std::size_t fingerprint_missing_counter = 0;
+  // Stored fingerprints which are not the one of the RED event
+  std::size_t fingerprint_stale_counter = 0;
+
+  // Events checked in depth and events only checked by their IDs and numbers of hits in sampling mode
+  std::size_t deep_counter = 0;
+  std::size_t deep_non_equal_counter = 0;
+  std::size_t cheap_counter = 0;
+  std::size_t cheap_non_equal_counter = 0;
+
+  // Mismatches of each field, over all the events compared field by field
+  snredbridge::field_mismatch_counters field_mismatches;
+
+  /// Add the results of another worker
+  void merge(const validation_results & other_)
+  {
+    er_counter += other_.er_counter;
+    eh_counter += other_.eh_counter;
+    udd_counter += other_.udd_counter;
+    non_equal_event_counter += other_.non_equal_event_counter;
+    fingerprint_match_counter += other_.fingerprint_match_counter;
+    fingerprint_mismatch_counter += other_.fingerprint_mismatch_counter;
+    fingerprint_missing_counter += other_.fingerprint_missing_counter;
+    fingerprint_stale_counter += other_.fingerprint_stale_counter;
+    deep_counter += other_.deep_counter;
+    deep_non_equal_counter += other_.deep_non_equal_counter;
+    cheap_counter += other_.cheap_counter;
+    cheap_non_equal_counter += other_.cheap_non_equal_counter;
+    field_mismatches.merge(other_.field_mismatches);
+  }
+};
+
+/// Check a pair of matched events, by their fingerprint in fast mode, else
+/// field by field. In sampling mode, the events which are not sampled are
+/// only checked by their IDs and numbers of hits.
+void compare_event_pair(const event_pair & pair_,
+                        const validation_config & config_,
+                        validation_results & results_,
+                        mismatch_output & output_,
+                        const datatools::logger::priority & logging_)
+{
+  const std::string EH_tag  = "EH";
+  const std::string UDD_tag = "UDD";
+  const snfee::data::raw_event_data & red = *pair_.red;
+  const datatools::things & event_record = *pair_.event_record;
+  DT_LOG_DEBUG(logging_, "Find corresponding EH/UDD event for " << snredbridge::event_key::from_red(red));
+  results_.er_counter++;
+  bool is_valid = false;
+  bool is_checked = false;
+  const bool is_deep = !config_.sampling || config_.sampler.is_sampled(snredbridge::event_key::from_red(red));
+
+  // The fingerprint scheme stored at conversion gives the waveform storage,
+  // else the roi margins of the options are used
+  const auto & EH = event_record.get<snemo::datamodel::event_header>(EH_tag);
+  snredbridge::event_fingerprint stored_fingerprint;
+  snredbridge::waveform_config waveform_cfg = config_.waveform;
+  const bool has_fingerprint = snredbridge::fetch_fingerprint(EH, stored_fingerprint, waveform_cfg);
+  if (!has_fingerprint) waveform_cfg = config_.waveform;
+
+  // The stored value must be the fingerprint of the RED event, else the RED
+  // event changed since the conversion or the stored value is corrupted
+  snredbridge::event_fingerprint red_fingerprint;
+  if (has_fingerprint && is_deep)
+    {
+      red_fingerprint = snredbridge::compute_red_fingerprint(red, waveform_cfg);
+      if (red_fingerprint != stored_fingerprint)
+        {
+          DT_LOG_WARNING(logging_, "Stored fingerprint of " << snredbridge::event_key::from_red(red)
+                         << " is not the one of the RED event");
+          results_.fingerprint_stale_counter++;
+        }
+    }
+
+  if (!is_deep)
+    {
+      // Neither the hits nor the waveforms are looked at
+      results_.cheap_counter++;
+      is_valid = snredbridge::compare_red_event_summary(red, event_record, logging_, &results_.field_mismatches);
+      if (!is_valid) results_.cheap_non_equal_counter++;
+      is_checked = true;
+    }
+  else results_.deep_counter++;
+  if (config_.fast && !is_checked)
+    {
+      // The UDD bank, with its waveforms decoded, must have the fingerprint
+      // of the RED event: the stored value itself only tells that the RED
+      // event did not change, see above.
+      if (!has_fingerprint)
+        results_.fingerprint_missing_counter++;
+      else
+        {
+          bool is_same = false;
+          try {
+            const auto & UDD = event_record.get<snemo::datamodel::unified_digitized_data>(UDD_tag);
+            is_same = EH.get_id().get_run_number() == red.get_run_id()
+              && EH.get_id().get_event_number() == red.get_event_id()
+              && snredbridge::compute_udd_fingerprint(UDD, waveform_cfg) == red_fingerprint;
+          }
+          catch (std::exception & x) {
+            DT_LOG_WARNING(logging_, snredbridge::event_key::from_red(red) << ": " << x.what());
+          }
+          if (is_same)
+            {
+              results_.fingerprint_match_counter++;
+              is_valid = is_checked = true;
+            }
+          else
+            {
+              DT_LOG_WARNING(logging_, "Fingerprint mismatch for " << snredbridge::event_key::from_red(red) << ", comparing the fields");
+              results_.fingerprint_mismatch_counter++;
+            }
+        }
+    }
+  if (!is_checked)
+    is_valid = snredbridge::compare_red_event_record(red, event_record, logging_, config_.no_waveform, waveform_cfg,
+                                                     &results_.field_mismatches);
+  if (is_deep && !is_valid) results_.deep_non_equal_counter++;
+  if (is_valid) {
+    results_.eh_counter++;
+    results_.udd_counter++;
+  }
+  else {
+    results_.non_equal_event_counter++;
+    // Only the non equal events of lowest sequences are reported, the
+    // differences of the others are not collected
+    if (output_.report != nullptr && output_.report->accepts(pair_.sequence))
+      {
+        std::vector<snredbridge::field_difference> differences;
+        snredbridge::compare_red_event_record(red, event_record, logging_, config_.no_waveform, waveform_cfg, nullptr, &differences);
+        output_.report->add(snredbridge::event_key::from_red(red), pair_.sequence, std::move(differences));
+      }
+    if (output_.max_display != 0 && output_.displayed++ < output_.max_display)
+      {
+        std::lock_guard<std::mutex> lock(output_.display_mutex);
+        DT_LOG_DEBUG(logging_, "Display RED and UDD non equal events");
+        red.print_tree(std::clog);
+        event_record.get<snemo::datamodel::unified_digitized_data>(UDD_tag).print_tree(std::clog);
+      }
+  }
+  // The events of lower sequences found non equal can now be written
+  if (output_.report != nullptr) output_.report->mark_done(pair_.sequence);
+  return;
+}
 
 
 //----------------------------------------------------------------------
@@ -43,7 +247,13 @@ int main (int argc, char *argv[])
     std::string input_red_filename = "";
     std::string input_udd_filename = "";
     size_t data_count = 100000000;
-    bool no_waveform = false;
+    size_t match_window = 256;
+    unsigned int number_of_threads = 1;
+    snredbridge::mismatch_report::config_type report_cfg;
+    double sample_fraction = 1.0;
+    uint64_t sample_seed = 0;
+    validation_config config;
+    snredbridge::event_selection selection;
 
     for (int iarg=1; iarg<argc; ++iarg)
       {
@@ -68,7 +278,39 @@ int main (int argc, char *argv[])
               data_count = std::strtol(argv[++iarg], NULL, 10);
 
             else if ((arg == "-no-wf") || (arg == "--no-waveform"))
-              no_waveform = true;
+              config.no_waveform = true;
+
+            else if (arg == "--roi-before")
+              config.waveform.roi_before = std::strtoul(argv[++iarg], NULL, 10);
+
+            else if (arg == "--roi-after")
+              config.waveform.roi_after = std::strtoul(argv[++iarg], NULL, 10);
+
+            else if ((arg == "-w") || (arg == "--match-window"))
+              match_window = std::strtoul(argv[++iarg], NULL, 10);
+
+            else if (arg == "--select")
+              selection.add_cut(argv[++iarg]);
+
+            else if (arg == "--fast")
+              config.fast = true;
+
+            else if ((arg == "-t") || (arg == "--threads"))
+              number_of_threads = std::strtoul(argv[++iarg], NULL, 10);
+
+            else if (arg == "--report")
+              report_cfg.filename = argv[++iarg];
+
+            else if (arg == "--report-events")
+              report_cfg.max_events = std::strtoul(argv[++iarg], NULL, 10);
+
+            else if (arg == "--sample") {
+              sample_fraction = std::strtod(argv[++iarg], NULL);
+              config.sampling = true;
+            }
+
+            else if (arg == "--sample-seed")
+              sample_seed = std::strtoull(argv[++iarg], NULL, 10);
 
             else if (arg=="-h" || arg=="--help")
               {
@@ -80,6 +322,21 @@ int main (int argc, char *argv[])
                 std::cout << "           -iudd / --input-udd    UDD_FILE" << std::endl;
                 std::cout << "           -n    / --max-events   Max number of events" << std::endl;
                 std::cout << "           -no-wf / --no-waveform Do compare the waveform between RED and UDD" << std::endl;
+                std::cout << "           --roi-before           Cells before the pulse of the roi waveforms of the events without" << std::endl;
+                std::cout << "                                  fingerprint scheme (default: 32)" << std::endl;
+                std::cout << "           --roi-after            Cells after the pulse of the roi waveforms of the events without" << std::endl;
+                std::cout << "                                  fingerprint scheme (default: 96)" << std::endl;
+                std::cout << "           -w    / --match-window Max number of unmatched events kept per stream (default: 256)" << std::endl;
+                std::cout << "           --select               Cut used by red_bridge on RED events (repeat for several cuts)" << std::endl;
+                std::cout << "           --fast                 Compare the fingerprints stored by red_bridge, with a full comparison" << std::endl;
+                std::cout << "                                  of the events only if they differ or are missing" << std::endl;
+                std::cout << "           -t    / --threads      Number of comparison threads, the RED and UDD files being" << std::endl;
+                std::cout << "                                  read on two more threads (default: 1, no thread)" << std::endl;
+                std::cout << "           --report               JSON file with the differences of the first non equal events" << std::endl;
+                std::cout << "           --report-events        Number of non equal events reported or printed in debug mode (default: 100)" << std::endl;
+                std::cout << "           --sample               Fraction of the events checked in depth, the other ones being only" << std::endl;
+                std::cout << "                                  checked by their IDs and numbers of hits" << std::endl;
+                std::cout << "           --sample-seed          Seed of the selection of the sampled events (default: 0)" << std::endl;
                 std::cout << std::endl;
                 return 0;
               }
@@ -95,6 +352,22 @@ int main (int argc, char *argv[])
         return 1;
       }
 
+    if (number_of_threads == 0)
+      {
+        std::cerr << "*** ERROR: invalid number of threads !" << std::endl;
+        return 1;
+      }
+
+    if (config.sampling)
+      {
+        if (!(sample_fraction >= 0.0 && sample_fraction <= 1.0))
+          {
+            std::cerr << "*** ERROR: invalid fraction of sampled events !" << std::endl;
+            return 1;
+          }
+        config.sampler = snredbridge::event_sampler(sample_fraction, sample_seed);
+      }
+
     snfee::initialize();
 
 
@@ -118,112 +391,258 @@ int main (int argc, char *argv[])
     reader.initialize_simple();
     DT_LOG_DEBUG(logging, "Initialization of the UDD input module is done.");
 
-    std::string EH_tag  = "EH";
-    std::string UDD_tag = "UDD";
-
     // RED counter
     std::size_t red_counter = 0;
 
-    // ER counter
-    std::size_t er_counter = 0;
+    // The maximum number of RED events is reached
+    bool red_limit_reached = false;
 
-    // EH counter
-    std::size_t eh_counter = 0;
+    // UDD records read so far
+    std::size_t udd_record_counter = 0;
 
-    // UDD counter
-    std::size_t udd_counter = 0;
-
-    // Missing event counter (for debug purpose)
-    std::size_t missing_event_counter = 0;
+    // Read the next selected RED event, false at the end of the RED stream
+    // Events rejected by red_bridge are not expected in the UDD file
+    auto read_red = [&](input_event<snfee::data::raw_event_data> & event_)
+      {
+        while (red_source.has_record_tag() && red_counter < data_count)
+          {
+            std::unique_ptr<snfee::data::raw_event_data> red(new snfee::data::raw_event_data);
+            red_source.load(*red);
+            const std::size_t position = red_counter++;
+            if (!selection.has_cuts() || selection.select(*red))
+              {
+                event_.position = position;
+                event_.data = std::move(red);
+                return true;
+              }
+          }
+        red_limit_reached = red_counter >= data_count;
+        return false;
+      };
 
-    // Non equal events counter during comparison function (for debug purpose)
-    std::size_t non_equal_event_counter = 0;
+    // Read the next UDD event record, false at the end of the UDD stream
+    bool udd_is_terminated = false;
+    auto read_udd = [&](input_event<datatools::things> & event_)
+      {
+        if (udd_is_terminated) return false;
+        std::unique_ptr<datatools::things> event_record(new datatools::things);
+        dpp::base_module::process_status status = reader.process(*event_record);
+        if (status != dpp::base_module::PROCESS_OK) {
+          DT_LOG_DEBUG(logging, "Cannot process another event record, status is " << status);
+          return false;
+        }
+        if (reader.is_terminated()) udd_is_terminated = true;
+        event_.position = udd_record_counter++;
+        event_.data = std::move(event_record);
+        return true;
+      };
+
+    // Results of each comparison worker
+    const bool is_threaded = number_of_threads > 1;
+    std::vector<validation_results> worker_results(number_of_threads);
+
+    // Report of the non equal events
+    std::unique_ptr<snredbridge::mismatch_report> report;
+    if (!report_cfg.filename.empty()) report.reset(new snredbridge::mismatch_report(report_cfg));
+    mismatch_output output;
+    output.report = report.get();
+    output.max_display = is_debug ? report_cfg.max_events : 0;
+
+    // In threaded mode, the RED and UDD files are read by their own thread,
+    // the main thread matches the events and the comparison workers check the
+    // pairs. The first error stops all the threads and is thrown at the end.
+    const std::size_t queue_capacity = 16 * number_of_threads;
+    snredbridge::bounded_queue<input_event<snfee::data::raw_event_data>> red_queue(queue_capacity);
+    snredbridge::bounded_queue<input_event<datatools::things>> udd_queue(queue_capacity);
+    snredbridge::bounded_queue<event_pair> pair_queue(queue_capacity);
+    std::vector<std::thread> threads;
+    std::mutex error_mutex;
+    std::exception_ptr thread_error;
+    auto stop_pipeline = [&](std::exception_ptr error_)
+      {
+        {
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if (!thread_error) thread_error = error_;
+        }
+        red_queue.close();
+        udd_queue.close();
+        pair_queue.close();
+      };
 
-    std::vector<snfee::data::raw_event_data> list_of_non_equal_red_events;
-    std::vector<snemo::datamodel::unified_digitized_data> list_of_non_equal_udd_events;
+    std::function<bool(input_event<snfee::data::raw_event_data> &)> next_red = read_red;
+    std::function<bool(input_event<datatools::things> &)> next_udd = read_udd;
+    std::function<void()> stop_udd = [] {};
 
-    // Check number of events in each data format
-    while (red_source.has_record_tag() && red_counter < data_count)
+    if (is_threaded)
       {
-        // Check and analyze 1 RED event and 1 UDD event
-        // For 1 RED event, must have 1 event record with 1 event header and 1 UDD event for a given RUN ID, same EVENT ID
-
-        // Empty working RED object
-        snfee::data::raw_event_data red;
-        red_source.load(red);
-        red_counter++;
-
-        int32_t red_run_id   = red.get_run_id();
-        int32_t red_event_id = red.get_event_id();
-
-        bool find_corresponding_udd_event = false;
-        datatools::things event_record;
-
-        while (!reader.is_terminated() || !find_corresponding_udd_event) {
-          // Empty working UDD object
-          dpp::base_module::process_status status = reader.process(event_record);
-          if (status != dpp::base_module::PROCESS_OK) {
-            DT_LOG_DEBUG(logging, "Cannot process another event record, status is " << status);
-            break;
-          }
-          //event_record.tree_dump(std::clog, "An event record:");
-
-          auto & EH  = event_record.get<snemo::datamodel::event_header>(EH_tag);
-          auto & UDD = event_record.get<snemo::datamodel::unified_digitized_data>(UDD_tag);
+        threads.emplace_back([&]
+          {
+            try {
+              input_event<snfee::data::raw_event_data> event;
+              while (read_red(event) && red_queue.push(std::move(event))) {}
+            }
+            catch (...) {
+              stop_pipeline(std::current_exception());
+            }
+            red_queue.close();
+          });
+        threads.emplace_back([&]
+          {
+            try {
+              input_event<datatools::things> event;
+              while (read_udd(event) && udd_queue.push(std::move(event))) {}
+            }
+            catch (...) {
+              stop_pipeline(std::current_exception());
+            }
+            udd_queue.close();
+          });
+        for (unsigned int iworker = 0; iworker < number_of_threads; iworker++)
+          threads.emplace_back([&, iworker]
+            {
+              try {
+                event_pair pair;
+                while (pair_queue.pop(pair)) compare_event_pair(pair, config, worker_results[iworker], output, logging);
+              }
+              catch (...) {
+                stop_pipeline(std::current_exception());
+              }
+            });
+        next_red = [&](input_event<snfee::data::raw_event_data> & event_) { return red_queue.pop(event_); };
+        next_udd = [&](input_event<datatools::things> & event_) { return udd_queue.pop(event_); };
+        stop_udd = [&] { udd_queue.close(); };
+      }
 
-          // Search for corresponding ER event with proper runID and eventID
-          if (EH.get_id().get_run_number() == red_run_id && EH.get_id().get_event_number() == red_event_id
-              && UDD.get_run_id() == red_run_id && UDD.get_event_id() == red_event_id) {
-            DT_LOG_DEBUG(logging, "Find corresponding EH/UDD event for run #" << red_run_id <<  " event #" << red_event_id);
-            find_corresponding_udd_event = true;
-          }
-        } // end of while UDD
-
-        if (find_corresponding_udd_event) {
-          er_counter++;
-          bool is_valid = compare_red_event_record(red, event_record, logging, no_waveform);
-          if (is_valid) {
-            eh_counter++;
-            udd_counter++;
-          }
-          else {
-            // Save non equal RED and UDD events for potential display in debug mode
-            list_of_non_equal_red_events.push_back(red);
-            list_of_non_equal_udd_events.push_back(event_record.get<snemo::datamodel::unified_digitized_data>(UDD_tag));
-            non_equal_event_counter++;
+    // For 1 RED event, must have 1 event record with 1 event header and 1 UDD event for a given RUN ID, same EVENT ID.
+    // Both streams are read side by side and the matcher pairs the events whatever their order.
+    snredbridge::event_matcher matcher(match_window);
 
-          }
-        }
+    std::size_t pair_counter = 0;
+    matcher.set_pair_callback([&](std::unique_ptr<snfee::data::raw_event_data> red_,
+                                  std::unique_ptr<datatools::things> event_record_)
+      {
+        event_pair pair;
+        pair.sequence = pair_counter++;
+        pair.red = std::move(red_);
+        pair.event_record = std::move(event_record_);
+        if (!is_threaded) compare_event_pair(pair, config, worker_results[0], output, logging);
+        else pair_queue.push(std::move(pair));
+      });
+
+    matcher.set_missing_callback([&](const snredbridge::event_key & key_, const std::size_t position_)
+      {
+        DT_LOG_WARNING(logging, "Did not find corresponding EH/UDD event for " << key_ << " (RED record #" << position_ << ")");
+      });
 
-        else {
-          DT_LOG_WARNING(logging, "Did not find corresponding EH/UDD event for run #" << red_run_id <<  " event #" << red_event_id);
-          missing_event_counter++;
-        }
+    matcher.set_extra_callback([&](const snredbridge::event_key & key_, const std::size_t position_)
+      {
+        DT_LOG_WARNING(logging, "Did not find corresponding RED event for " << key_ << " (UDD record #" << position_ << ")");
+      });
+
+    try {
+      // The streams are consumed alternately, so that the matching does not
+      // depend on the speed of the reader threads
+      bool red_is_done = false;
+      bool udd_is_done = false;
+      // UDD records read after the last RED event
+      std::size_t udd_after_red = 0;
+      while (true)
+        {
+          // With a maximum number of RED events, the UDD stream is read until
+          // all of them are matched, or until the window is passed: the RED
+          // events still waiting are then missing
+          if (red_is_done && red_limit_reached && !udd_is_done
+              && (matcher.get_number_of_pending_red() == 0 || udd_after_red > match_window))
+            {
+              udd_is_done = true;
+              stop_udd();
+            }
+          if (red_is_done && udd_is_done) break;
 
-        event_record.clear();
-      }
+          if (!red_is_done)
+            {
+              input_event<snfee::data::raw_event_data> red;
+              if (next_red(red)) matcher.add_red(std::move(red.data), red.position);
+              else red_is_done = true;
+            }
 
+          if (!udd_is_done)
+            {
+              input_event<datatools::things> event_record;
+              if (next_udd(event_record))
+                {
+                  matcher.add_udd(std::move(event_record.data), event_record.position);
+                  if (red_is_done) udd_after_red++;
+                }
+              else udd_is_done = true;
+            }
+        }
+    }
+    catch (...) {
+      stop_pipeline(std::current_exception());
+    }
+    pair_queue.close();
+    for (std::thread & thread : threads) thread.join();
+    if (thread_error) std::rethrow_exception(thread_error);
+
+    // Merge the results of the workers in a fixed order
+    validation_results results;
+    for (const validation_results & worker_result : worker_results) results.merge(worker_result);
+    if (report) report->close(results.field_mismatches, results.non_equal_event_counter);
+
+    // Remaining unmatched events are missing or extra
+    matcher.flush();
+    const snredbridge::event_matcher::counters & match_counters = matcher.get_counters();
 
     std::cout << "Results :" << std::endl;
     std::cout << "- Worker #0 (input RED)" << std::endl;
     std::cout << "  - RED events    : " << red_counter << std::endl;
+    if (selection.has_cuts())
+      std::cout << "  - Selected      : " << selection.get_selected() << std::endl;
     std::cout << "- Worker #1 (output ER)" << std::endl;
-    std::cout << "  - Event Records : " << er_counter << std::endl;
+    std::cout << "  - Event Records : " << results.er_counter << std::endl;
     std::cout << "  - Contains (EH and UDD banks)" << std::endl;
-    std::cout << "    - Event header : " << eh_counter << std::endl;
-    std::cout << "    - UDD events   : " << udd_counter << std::endl;
-    std::cout << "- Missing events     : " << missing_event_counter << std::endl;
-    std::cout << "- Non equal events   : " << non_equal_event_counter << std::endl;
+    std::cout << "    - Event header : " << results.eh_counter << std::endl;
+    std::cout << "    - UDD events   : " << results.udd_counter << std::endl;
+    std::cout << "- Missing events     : " << match_counters.missing << std::endl;
+    std::cout << "- Extra events       : " << match_counters.extra << std::endl;
+    std::cout << "- Duplicated events  : " << match_counters.duplicated_red << " (RED) "
+              << match_counters.duplicated_udd << " (UDD)" << std::endl;
+    std::cout << "- Non equal events   : " << results.non_equal_event_counter << std::endl;
+    std::cout << "- Stale fingerprints : " << results.fingerprint_stale_counter << " (RED changed since conversion)" << std::endl;
+    const snredbridge::field_mismatch_counters & field_mismatches = results.field_mismatches;
+    if (field_mismatches.get_total_mismatches() != 0)
+      {
+        std::cout << "- Non equal fields" << std::endl;
+        for (std::size_t ifield = 0; ifield < field_mismatches.get_number_of_fields(); ifield++)
+          if (field_mismatches.get_mismatches(ifield) != 0)
+            std::cout << "  - " << field_mismatches.get_field_name(ifield) << " : "
+                      << field_mismatches.get_mismatches(ifield) << std::endl;
+      }
+    if (config.fast)
+      {
+        std::cout << "- Fingerprints" << std::endl;
+        std::cout << "  - Matching         : " << results.fingerprint_match_counter << std::endl;
+        std::cout << "  - Not matching     : " << results.fingerprint_mismatch_counter << " (compared field by field)" << std::endl;
+        std::cout << "  - Missing          : " << results.fingerprint_missing_counter << " (compared field by field)" << std::endl;
+      }
 
-    if (is_debug && non_equal_event_counter != 0)
+    if (config.sampling)
       {
-        DT_LOG_DEBUG(logging, "Display RED and UDD non equal events");
-        for (std::size_t i = 0; i < non_equal_event_counter; i++) {
-          list_of_non_equal_red_events[i].print_tree(std::clog);
-          list_of_non_equal_udd_events[i].print_tree(std::clog);
-        }
+        // The mismatch rate is estimated from the events checked in depth
+        const snredbridge::rate_interval interval = snredbridge::wilson_interval(results.deep_non_equal_counter, results.deep_counter);
+        std::cout << "- Sampling (fraction " << config.sampler.get_fraction()
+                  << ", seed " << config.sampler.get_seed() << ")" << std::endl;
+        std::cout << "  - Deep checks      : " << results.deep_counter << " (" << results.deep_non_equal_counter << " non equal)" << std::endl;
+        std::cout << "  - Cheap checks     : " << results.cheap_counter << " (" << results.cheap_non_equal_counter << " non equal)" << std::endl;
+        std::cout << "  - Mismatch rate    : "
+                  << (results.deep_counter == 0 ? 0.0 : double(results.deep_non_equal_counter) / results.deep_counter)
+                  << " (95% CL interval [" << interval.low << ", " << interval.high << "])" << std::endl;
       }
 
+    if (report)
+      std::cout << "- Reported events    : " << report->get_number_of_events() << " in " << report_cfg.filename << std::endl;
+
     snfee::terminate();
 
     DT_LOG_INFORMATION(logging, "The end.");
@@ -239,231 +658,3 @@ int main (int argc, char *argv[])
   }
   return (error_code);
 }
-
-
-
-bool compare_red_event_record(const snfee::data::raw_event_data & red_,
-                              const datatools::things & event_record_,
-                              const datatools::logger::priority & logging_,
-                              bool no_wf_)
-{
-  DT_LOG_DEBUG(logging_, "Entering compare_red_event_record.");
-  bool red_er_is_equivalent = false;
-  // event_record_.tree_dump(std::clog, "An event record:");
-
-  std::string EH_tag  = "EH";
-  std::string UDD_tag = "UDD";
-  auto & EH  = event_record_.get<snemo::datamodel::event_header>(EH_tag);
-  auto & UDD = event_record_.get<snemo::datamodel::unified_digitized_data>(UDD_tag);
-
-  // red_.print_tree(std::clog);
-  // EH.tree_dump(std::clog, "Event header('EH'): ");
-  // UDD.tree_dump(std::clog, "Unified Digitized Data('UDD'): ");
-
-  // Compare RED attributes with EH / UDD ones
-  bool is_event_header_equivalent = false;
-  // Check Run ID, Event ID and Generation
-  if (EH.get_id().get_run_number() == red_.get_run_id()
-      && EH.get_id().get_event_number() == red_.get_event_id()
-      && EH.is_real()) {
-    DT_LOG_DEBUG(logging_, "Corresponding EH is valid.");
-    is_event_header_equivalent = true;
-  }
-
-  bool is_udd_global_equivalent = false;
-  if (UDD.get_run_id() == red_.get_run_id()
-      && UDD.get_event_id() == red_.get_event_id()
-      && UDD.get_reference_timestamp() == red_.get_reference_time().get_ticks()
-      && UDD.get_origin_trigger_ids() == red_.get_origin_trigger_ids()) {
-    DT_LOG_DEBUG(logging_, "Corresponding UDD global is valid.");
-    is_udd_global_equivalent = true;
-  }
-
-  bool is_calo_equivalent = false;
-
-  // RED Digitized calo hits
-  const std::vector<snfee::data::calo_digitized_hit> red_calo_hits = red_.get_calo_hits();
-
-  std::size_t number_red_calo_hits = red_calo_hits.size();
-  std::size_t number_udd_calo_hits = UDD.get_calorimeter_hits().size();
-  if (number_red_calo_hits == 0 && number_udd_calo_hits == 0) is_calo_equivalent = true;
-
-  DT_LOG_DEBUG(logging_, "Number of RED calo hits = " << number_red_calo_hits);
-  DT_LOG_DEBUG(logging_, "Number of UDD calo hits = " << number_udd_calo_hits);
-
-  std::vector<bool> list_calos_corresponding;
-
-  if (number_red_calo_hits == number_udd_calo_hits) {
-
-    for (std::size_t ihit = 0; ihit < red_calo_hits.size(); ihit++) {
-      snfee::data::calo_digitized_hit red_calo_hit = red_calo_hits[ihit];
-      bool is_corresponding_udd_calo_find = false;
-      std::size_t udd_calo_counter = 0;
-
-      snemo::datamodel::calorimeter_digitized_hit udd_calo_hit;
-
-      while (!is_corresponding_udd_calo_find && udd_calo_counter < number_udd_calo_hits) {
-        udd_calo_hit = UDD.get_calorimeter_hits()[udd_calo_counter].get();
-
-        if (udd_calo_hit.get_geom_id() ==  red_calo_hit.get_geom_id()
-            && udd_calo_hit.get_hit_id() == red_calo_hit.get_hit_id()) is_corresponding_udd_calo_find = true;
-        udd_calo_counter++;
-      }
-
-      bool is_corresponding_calo_valid = false;
-
-      // Compare calo hit per attributes
-      // create a vector of a boolean for each calo hit already checked
-      if (is_corresponding_udd_calo_find) {
-
-        if (!no_wf_){
-          if (udd_calo_hit.get_geom_id() == red_calo_hit.get_geom_id()
-              && udd_calo_hit.get_hit_id()  == red_calo_hit.get_hit_id()
-              && udd_calo_hit.get_timestamp() == red_calo_hit.get_reference_time().get_ticks()
-              && udd_calo_hit.get_waveform()  == red_calo_hit.get_waveform()
-              && udd_calo_hit.is_low_threshold_only() == red_calo_hit.is_low_threshold_only()
-              && udd_calo_hit.is_high_threshold() == red_calo_hit.is_high_threshold()
-              && udd_calo_hit.get_fcr() == red_calo_hit.get_fcr()
-              && udd_calo_hit.get_lt_trigger_counter() == red_calo_hit.get_lt_trigger_counter()
-              && udd_calo_hit.get_lt_time_counter() == red_calo_hit.get_lt_time_counter()
-              && udd_calo_hit.get_fwmeas_baseline() == red_calo_hit.get_fwmeas_baseline()
-              && udd_calo_hit.get_fwmeas_peak_amplitude() == red_calo_hit.get_fwmeas_peak_amplitude()
-              && udd_calo_hit.get_fwmeas_peak_cell() == red_calo_hit.get_fwmeas_peak_cell()
-              && udd_calo_hit.get_fwmeas_charge() == red_calo_hit.get_fwmeas_charge()
-              && udd_calo_hit.get_fwmeas_rising_cell() == red_calo_hit.get_fwmeas_rising_cell()
-              && udd_calo_hit.get_fwmeas_falling_cell() == red_calo_hit.get_fwmeas_falling_cell()
-              && udd_calo_hit.get_origin().get_hit_number() == red_calo_hit.get_origin().get_hit_number()
-              && udd_calo_hit.get_origin().get_trigger_id() == red_calo_hit.get_origin().get_trigger_id()) {
-            DT_LOG_DEBUG(logging_, "Corresponding UDD calo is valid.");
-            is_corresponding_calo_valid = true;
-          }
-        } else {
-          if (udd_calo_hit.get_geom_id() == red_calo_hit.get_geom_id()
-              && udd_calo_hit.get_hit_id()  == red_calo_hit.get_hit_id()
-              && udd_calo_hit.get_timestamp() == red_calo_hit.get_reference_time().get_ticks()
-              && udd_calo_hit.is_low_threshold_only() == red_calo_hit.is_low_threshold_only()
-              && udd_calo_hit.is_high_threshold() == red_calo_hit.is_high_threshold()
-              && udd_calo_hit.get_fcr() == red_calo_hit.get_fcr()
-              && udd_calo_hit.get_lt_trigger_counter() == red_calo_hit.get_lt_trigger_counter()
-              && udd_calo_hit.get_lt_time_counter() == red_calo_hit.get_lt_time_counter()
-              && udd_calo_hit.get_fwmeas_baseline() == red_calo_hit.get_fwmeas_baseline()
-              && udd_calo_hit.get_fwmeas_peak_amplitude() == red_calo_hit.get_fwmeas_peak_amplitude()
-              && udd_calo_hit.get_fwmeas_peak_cell() == red_calo_hit.get_fwmeas_peak_cell()
-              && udd_calo_hit.get_fwmeas_charge() == red_calo_hit.get_fwmeas_charge()
-              && udd_calo_hit.get_fwmeas_rising_cell() == red_calo_hit.get_fwmeas_rising_cell()
-              && udd_calo_hit.get_fwmeas_falling_cell() == red_calo_hit.get_fwmeas_falling_cell()
-              && udd_calo_hit.get_origin().get_hit_number() == red_calo_hit.get_origin().get_hit_number()
-              && udd_calo_hit.get_origin().get_trigger_id() == red_calo_hit.get_origin().get_trigger_id()) {
-            DT_LOG_DEBUG(logging_, "Corresponding UDD calo is valid.");
-            is_corresponding_calo_valid = true;
-          }
-        }
-      }
-
-      list_calos_corresponding.push_back(is_corresponding_calo_valid);
-
-    } // end of calo red ihit
-
-  } // end of if n_red_calo == n_udd_calo
-
-  if (!list_calos_corresponding.empty()) is_calo_equivalent = std::all_of(list_calos_corresponding.begin(), list_calos_corresponding.end(), [](bool v) { return v; });
-  DT_LOG_DEBUG(logging_, "Calo is equivalent = " << is_calo_equivalent);
-
-  bool is_tracker_equivalent = false;
-
-  // RED Digitized tracker hits
-  const std::vector<snfee::data::tracker_digitized_hit> red_tracker_hits = red_.get_tracker_hits();
-
-  std::size_t number_red_tracker_hits = red_tracker_hits.size();
-  std::size_t number_udd_tracker_hits = UDD.get_tracker_hits().size();
-  if (number_red_tracker_hits == 0 && number_udd_tracker_hits == 0) is_tracker_equivalent = true;
-
-  DT_LOG_DEBUG(logging_, "Number of RED tracker hits = " << number_red_tracker_hits);
-  DT_LOG_DEBUG(logging_, "Number of UDD tracker hits = " << number_udd_tracker_hits);
-
-  std::vector<bool> list_trackers_corresponding;
-
-  if (number_red_tracker_hits == number_udd_tracker_hits) {
-
-    for (std::size_t ihit = 0; ihit < red_tracker_hits.size(); ihit++) {
-      snfee::data::tracker_digitized_hit red_tracker_hit = red_tracker_hits[ihit];
-      bool is_corresponding_udd_tracker_find = false;
-      std::size_t udd_tracker_counter = 0;
-
-      snemo::datamodel::tracker_digitized_hit udd_tracker_hit;
-
-      while (!is_corresponding_udd_tracker_find && udd_tracker_counter < number_udd_tracker_hits) {
-        udd_tracker_hit = UDD.get_tracker_hits()[udd_tracker_counter].get();
-
-        if (udd_tracker_hit.get_geom_id() ==  red_tracker_hit.get_geom_id()
-            && udd_tracker_hit.get_hit_id() == red_tracker_hit.get_hit_id()) is_corresponding_udd_tracker_find = true;
-        udd_tracker_counter++;
-      }
-
-      bool is_corresponding_tracker_valid = false;
-
-      // Compare tracker hit per attributes
-      // create a vector of a boolean for each tracker hit already checked
-
-      // GO Note/Warning, number of GG times are the same for now between RED and UDD but it might not be the case in a near future
-      // if we change the event builder algorithm and decide to remove the 'deduplication' for tracker hits.
-      // Not sure how it will impact RED format and then get propagated to UDD format
-      if (is_corresponding_udd_tracker_find
-          && red_tracker_hit.get_times().size() == udd_tracker_hit.get_times().size()) {
-
-        std::vector<bool> list_timestamps_corresponding;
-        bool is_corresponding_timestamp_valid = false;
-        for (std::size_t iggtime = 0; iggtime < red_tracker_hit.get_times().size(); iggtime++)
-          {
-            DT_LOG_DEBUG(logging_, "Corresponding UDD tracker is valid.");
-            // Retrieve RED and UDD GG timestamps
-            const snfee::data::tracker_digitized_hit::gg_times      & red_gg_timestamp = red_tracker_hit.get_times()[iggtime];
-            const snemo::datamodel::tracker_digitized_hit::gg_times & udd_gg_timestamp = udd_tracker_hit.get_times()[iggtime];
-            is_corresponding_tracker_valid = true;
-            if (udd_tracker_hit.get_geom_id() ==  red_tracker_hit.get_geom_id()
-                && udd_tracker_hit.get_hit_id() == red_tracker_hit.get_hit_id()
-                && udd_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R0).get_hit_number() == red_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R0).get_hit_number()
-                && udd_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R0).get_trigger_id() == red_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R0).get_trigger_id()
-                && udd_gg_timestamp.get_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R0) == red_gg_timestamp.get_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R0).get_ticks()
-                && udd_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R1).get_hit_number() == red_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R1).get_hit_number()
-                && udd_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R1).get_trigger_id() == red_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R1).get_trigger_id()
-                && udd_gg_timestamp.get_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R1) == red_gg_timestamp.get_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R1).get_ticks()
-                && udd_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R2).get_hit_number() == red_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R2).get_hit_number()
-                && udd_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R2).get_trigger_id() == red_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R2).get_trigger_id()
-                && udd_gg_timestamp.get_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R2) == red_gg_timestamp.get_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R2).get_ticks()
-                && udd_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R3).get_hit_number() == red_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R3).get_hit_number()
-                && udd_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R3).get_trigger_id() == red_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R3).get_trigger_id()
-                && udd_gg_timestamp.get_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R3) == red_gg_timestamp.get_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R3).get_ticks()
-                && udd_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R4).get_hit_number() == red_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R4).get_hit_number()
-                && udd_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R4).get_trigger_id() == red_gg_timestamp.get_anode_origin(snemo::datamodel::tracker_digitized_hit::ANODE_R4).get_trigger_id()
-                && udd_gg_timestamp.get_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R4) == red_gg_timestamp.get_anode_time(snemo::datamodel::tracker_digitized_hit::ANODE_R4).get_ticks()
-                && udd_gg_timestamp.get_bottom_cathode_origin().get_hit_number() == red_gg_timestamp.get_bottom_cathode_origin().get_hit_number()
-                && udd_gg_timestamp.get_bottom_cathode_origin().get_trigger_id() == red_gg_timestamp.get_bottom_cathode_origin().get_trigger_id()
-                && udd_gg_timestamp.get_bottom_cathode_time() == red_gg_timestamp.get_bottom_cathode_time().get_ticks()
-                && udd_gg_timestamp.get_top_cathode_origin().get_hit_number() == red_gg_timestamp.get_top_cathode_origin().get_hit_number()
-                && udd_gg_timestamp.get_top_cathode_origin().get_trigger_id() == red_gg_timestamp.get_top_cathode_origin().get_trigger_id()
-                && udd_gg_timestamp.get_top_cathode_time() == red_gg_timestamp.get_top_cathode_time().get_ticks())
-              is_corresponding_timestamp_valid = true;
-          }
-        list_timestamps_corresponding.push_back(is_corresponding_timestamp_valid);
-        if (!list_timestamps_corresponding.empty()) is_corresponding_tracker_valid = std::all_of(list_timestamps_corresponding.begin(), list_timestamps_corresponding.end(), [](bool v) { return v; });
-        list_trackers_corresponding.push_back(is_corresponding_tracker_valid);
-      } // end of is_corresponding_udd
-
-    } // end of tracker red ihit
-
-  } // end of if n_red_calo == n_udd_calo
-
-  if (!list_trackers_corresponding.empty()) is_tracker_equivalent = std::all_of(list_trackers_corresponding.begin(), list_trackers_corresponding.end(), [](bool v) { return v; });
-  DT_LOG_DEBUG(logging_, "Tracker is equivalent = " << is_tracker_equivalent);
-
-  DT_LOG_DEBUG(logging_, "EH is equivalent = " << is_event_header_equivalent
-               << " UDD global is equivalent = " << is_udd_global_equivalent
-               << " UDD Calo is equivalent = " << is_calo_equivalent
-               << " UDD Tracker is equivalent = " << is_tracker_equivalent);
-  if (is_event_header_equivalent && is_udd_global_equivalent && is_calo_equivalent && is_tracker_equivalent) red_er_is_equivalent = true;
-  DT_LOG_DEBUG(logging_, "RED is equivalent to Event Record = " << red_er_is_equivalent);
-
-
-  return red_er_is_equivalent;
-}
@@ -21,6 +21,14 @@ load_mysnemo_dev_setup
 
 NUMBER_OF_EVENTS=100000000
 
+# Compare each UDD event with its RED event during the conversion (--verify),
+# set to 0 to run the separate red_bridge_validation pass instead
+VERIFY_IN_CONVERSION=1
+REDBRIDGE_VERIFY_OPTION=""
+if [ ${VERIFY_IN_CONVERSION} -eq 1 ]; then
+    REDBRIDGE_VERIFY_OPTION="--verify"
+fi
+
 SNFEE_RTD2RED_PATH="/sps/nemo/scratch/golivier/software/SNFEE/install.d/bin"
 SNFEE_RTD2RED_SOFT="${SNFEE_RTD2RED_PATH}/snfee-rtd2red"
 SNREDBRIDGE_PATH="/sps/nemo/scratch/golivier/software/SNREDBridge/install.d/bin/"
@@ -86,12 +94,12 @@ REDBRIDGE_VALIDATION_SOFTTRIGGER_LOG_FILE="${RTD2RED_OUTPUT_SOFTTRIGGER}/snemo_r
 
 ls ${RED_DELTATDC_FILE} -lh
 if [ $? -eq 0 ]; then
-    ${SNREDBRIDGE_SOFT} -i ${RED_DELTATDC_FILE} -o ${UDD_DELTATDC_FILE} -n ${NUMBER_OF_EVENTS} > "${REDBRIDGE_DELTATDC_LOG_FILE}" 2>&1
+    ${SNREDBRIDGE_SOFT} -i ${RED_DELTATDC_FILE} -o ${UDD_DELTATDC_FILE} -n ${NUMBER_OF_EVENTS} ${REDBRIDGE_VERIFY_OPTION} > "${REDBRIDGE_DELTATDC_LOG_FILE}" 2>&1
 fi
 
 ls ${RED_SOFTTRIGGER_FILE} -lh
 if [ $? -eq 0 ]; then
-    ${SNREDBRIDGE_SOFT} -i ${RED_SOFTTRIGGER_FILE} -o ${UDD_SOFTTRIGGER_FILE} -n ${NUMBER_OF_EVENTS} > "${REDBRIDGE_SOFTTRIGGER_LOG_FILE}" 2>&1
+    ${SNREDBRIDGE_SOFT} -i ${RED_SOFTTRIGGER_FILE} -o ${UDD_SOFTTRIGGER_FILE} -n ${NUMBER_OF_EVENTS} ${REDBRIDGE_VERIFY_OPTION} > "${REDBRIDGE_SOFTTRIGGER_LOG_FILE}" 2>&1
 fi
 
 # echo "Touching UDD files for debug purpose"
@@ -100,11 +108,11 @@ fi
 
 
 ls ${UDD_DELTATDC_FILE} -lh
-if [ $? -eq 0 ]; then
+if [ $? -eq 0 ] && [ ${VERIFY_IN_CONVERSION} -eq 0 ]; then
     ${SNREDBRIDGE_VALIDATION_SOFT} -ired ${RED_DELTATDC_FILE} -iudd ${UDD_DELTATDC_FILE} -n ${NUMBER_OF_EVENTS} > "${REDBRIDGE_VALIDATION_DELTATDC_LOG_FILE}" 2>&1
 fi
 
 ls ${UDD_SOFTTRIGGER_FILE} -lh
-if [ $? -eq 0 ]; then
+if [ $? -eq 0 ] && [ ${VERIFY_IN_CONVERSION} -eq 0 ]; then
     ${SNREDBRIDGE_VALIDATION_SOFT} -ired ${RED_SOFTTRIGGER_FILE} -iudd ${UDD_SOFTTRIGGER_FILE} -n ${NUMBER_OF_EVENTS} > "${REDBRIDGE_VALIDATION_SOFTTRIGGER_LOG_FILE}" 2>&1
 fi
@@ -0,0 +1,71 @@
+/// \file snredbridge/bounded_queue.h
+/// Blocking FIFO queue of bounded capacity, shared by the threads of the
+/// conversion and validation pipelines
+
+#ifndef SNREDBRIDGE_BOUNDED_QUEUE_H
+#define SNREDBRIDGE_BOUNDED_QUEUE_H
+
+// Standard library:
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace snredbridge {
+
+  /// Bounded FIFO queue connecting two stages of the multi-threaded pipelines.
+  /// Producers block while the queue is full, consumers block while it is empty.
+  /// Once closed, push() fails and pop() fails as soon as the queue is drained.
+  template <typename T>
+  class bounded_queue
+  {
+  public:
+
+    explicit bounded_queue(const std::size_t capacity_)
+      : _capacity_(capacity_ == 0 ? 1 : capacity_)
+    {
+    }
+
+    bool push(T && item_)
+    {
+      std::unique_lock<std::mutex> lock(_mutex_);
+      _not_full_.wait(lock, [this] { return _closed_ || _items_.size() < _capacity_; });
+      if (_closed_) return false;
+      _items_.push_back(std::move(item_));
+      _not_empty_.notify_one();
+      return true;
+    }
+
+    bool pop(T & item_)
+    {
+      std::unique_lock<std::mutex> lock(_mutex_);
+      _not_empty_.wait(lock, [this] { return _closed_ || !_items_.empty(); });
+      if (_items_.empty()) return false;
+      item_ = std::move(_items_.front());
+      _items_.pop_front();
+      _not_full_.notify_one();
+      return true;
+    }
+
+    void close()
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      _closed_ = true;
+      _not_full_.notify_all();
+      _not_empty_.notify_all();
+    }
+
+  private:
+
+    const std::size_t _capacity_;
+    bool _closed_ = false;
+    std::deque<T> _items_;
+    std::mutex _mutex_;
+    std::condition_variable _not_full_;
+    std::condition_variable _not_empty_;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_BOUNDED_QUEUE_H
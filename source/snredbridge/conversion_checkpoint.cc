@@ -0,0 +1,116 @@
+// Ourselves:
+#include <snredbridge/conversion_checkpoint.h>
+
+// Standard library:
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+// System:
+#include <fcntl.h>
+#include <unistd.h>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    const std::string CHECKPOINT_MAGIC = "snredbridge_checkpoint";
+    const int CHECKPOINT_VERSION = 1;
+
+  } // namespace
+
+  std::string conversion_checkpoint::default_filename(const std::string & output_filename_)
+  {
+    return output_filename_ + ".checkpoint";
+  }
+
+  void conversion_checkpoint::save(const std::string & filename_) const
+  {
+    // Write a temporary file, then replace the previous checkpoint by it: a
+    // job killed while writing leaves the previous checkpoint untouched
+    const std::string temporary_filename = filename_ + ".tmp";
+    {
+      std::ofstream file(temporary_filename);
+      DT_THROW_IF(!file, std::runtime_error, "Cannot create checkpoint file '" << temporary_filename << "'!");
+      file << CHECKPOINT_MAGIC << ' ' << CHECKPOINT_VERSION << '\n';
+      file << "input " << input << '\n';
+      file << "first_red_record " << first_red_record << '\n';
+      file << "next_red_record " << next_red_record << '\n';
+      file << "udd_records " << udd_records << '\n';
+      file << "complete " << (complete ? 1 : 0) << '\n';
+      for (const part_type & part : parts)
+        file << "part " << part.first_udd_record << ' ' << part.udd_records << ' '
+             << part.first_red_record << ' ' << part.end_red_record << ' '
+             << part.first_run_id << ' ' << part.first_event_id << ' '
+             << part.last_run_id << ' ' << part.last_event_id << ' ' << part.filename << '\n';
+      file.close();
+      DT_THROW_IF(!file, std::runtime_error, "Cannot write checkpoint file '" << temporary_filename << "'!");
+    }
+    sync_file(temporary_filename);
+    DT_THROW_IF(std::rename(temporary_filename.c_str(), filename_.c_str()) != 0, std::runtime_error,
+                "Cannot replace checkpoint file '" << filename_ << "'!");
+    return;
+  }
+
+  void conversion_checkpoint::load(const std::string & filename_)
+  {
+    std::ifstream file(filename_);
+    DT_THROW_IF(!file, std::runtime_error, "Cannot open checkpoint file '" << filename_ << "'!");
+    std::string magic;
+    int version = 0;
+    file >> magic >> version;
+    DT_THROW_IF(magic != CHECKPOINT_MAGIC, std::runtime_error, "File '" << filename_ << "' is not a checkpoint file!");
+    DT_THROW_IF(version != CHECKPOINT_VERSION, std::runtime_error,
+                "Unsupported version " << version << " of checkpoint file '" << filename_ << "'!");
+
+    *this = conversion_checkpoint();
+    std::string line;
+    while (std::getline(file, line))
+      {
+        if (line.empty()) continue;
+        std::istringstream line_stream(line);
+        std::string key;
+        line_stream >> key;
+        if (key == "input")
+          {
+            line_stream >> std::ws;
+            std::getline(line_stream, input);
+          }
+        else if (key == "first_red_record") line_stream >> first_red_record;
+        else if (key == "next_red_record") line_stream >> next_red_record;
+        else if (key == "udd_records") line_stream >> udd_records;
+        else if (key == "complete") line_stream >> complete;
+        else if (key == "part")
+          {
+            part_type part;
+            line_stream >> part.first_udd_record >> part.udd_records
+                        >> part.first_red_record >> part.end_red_record
+                        >> part.first_run_id >> part.first_event_id
+                        >> part.last_run_id >> part.last_event_id >> std::ws;
+            std::getline(line_stream, part.filename);
+            parts.push_back(part);
+          }
+        else
+          DT_THROW(std::runtime_error, "Unknown entry '" << key << "' in checkpoint file '" << filename_ << "'!");
+        DT_THROW_IF(line_stream.fail(), std::runtime_error,
+                    "Invalid line '" << line << "' in checkpoint file '" << filename_ << "'!");
+      }
+    return;
+  }
+
+  void sync_file(const std::string & filename_)
+  {
+    const int fd = ::open(filename_.c_str(), O_RDONLY);
+    DT_THROW_IF(fd < 0, std::runtime_error, "Cannot open file '" << filename_ << "' to sync it!");
+    const int status = ::fsync(fd);
+    ::close(fd);
+    DT_THROW_IF(status != 0, std::runtime_error, "Cannot sync file '" << filename_ << "' to the disk!");
+    return;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,71 @@
+/// \file snredbridge/conversion_checkpoint.h
+/// State of a conversion saved at each checkpoint, to resume it later
+
+#ifndef SNREDBRIDGE_CONVERSION_CHECKPOINT_H
+#define SNREDBRIDGE_CONVERSION_CHECKPOINT_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace snredbridge {
+
+  /// \brief State of a conversion at a checkpoint
+  ///
+  /// At a checkpoint, the current UDD output file is closed: the checkpoint
+  /// lists the complete output files and the position of the next RED record
+  /// to convert. The checkpoint file is a small text file:
+  /// \code
+  /// snredbridge_checkpoint 1
+  /// input /data/snemo_run-815_red-v1.data.gz
+  /// first_red_record 0
+  /// next_red_record 18250
+  /// udd_records 18250
+  /// complete 0
+  /// part 0 10000 0 10000 815 0 815 9999 snemo_run-815_udd-v1_part0000.data.gz
+  /// part 10000 8250 10000 18250 815 10000 815 18249 snemo_run-815_udd-v1_part0001.data.gz
+  /// \endcode
+  /// Each part line gives the first UDD record, the number of UDD records,
+  /// the range of RED records [first, end), the run and event IDs of the
+  /// first and last events and the file name.
+  struct conversion_checkpoint
+  {
+    /// Complete UDD output file
+    struct part_type
+    {
+      std::string filename;
+      std::size_t first_udd_record = 0; ///< Position of the first UDD record in the whole output
+      std::size_t udd_records = 0;      ///< Number of UDD records in the file
+      std::size_t first_red_record = 0; ///< Position of the RED record of the first UDD record
+      std::size_t end_red_record = 0;   ///< Position after the RED record of the last UDD record
+      int32_t first_run_id = -1;        ///< Run ID of the first event
+      int32_t first_event_id = -1;      ///< Event ID of the first event
+      int32_t last_run_id = -1;         ///< Run ID of the last event
+      int32_t last_event_id = -1;       ///< Event ID of the last event
+    };
+
+    std::string input;                ///< RED file
+    std::size_t first_red_record = 0; ///< Position of the first RED record of the conversion
+    std::size_t next_red_record = 0;  ///< Position of the next RED record to convert
+    std::size_t udd_records = 0;      ///< UDD records in the complete output files
+    bool complete = false;            ///< The conversion is done
+    std::vector<part_type> parts;     ///< Complete output files
+
+    /// Default checkpoint file of a conversion ("<UDD file>.checkpoint")
+    static std::string default_filename(const std::string & output_filename_);
+
+    /// Store the checkpoint, the file is replaced atomically and synced to disk
+    void save(const std::string & filename_) const;
+
+    /// Load a checkpoint
+    void load(const std::string & filename_);
+  };
+
+  /// Flush the data of a file to the disk
+  void sync_file(const std::string & filename_);
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_CONVERSION_CHECKPOINT_H
@@ -0,0 +1,288 @@
+// Ourselves:
+#include <snredbridge/event_fingerprint.h>
+
+// Standard library:
+#include <cstdlib>
+#include <set>
+#include <sstream>
+#include <vector>
+
+// This project:
+#include <snredbridge/field_mapping.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    /// Version 2: fields hashed in the order of the tables of snredbridge/field_mapping.h
+    const int FINGERPRINT_VERSION = 2;
+
+    const uint64_t PRIME_1 = 0x9e3779b185ebca87ULL;
+    const uint64_t PRIME_2 = 0xc2b2ae3d27d4eb4fULL;
+    const uint64_t PRIME_3 = 0x165667b19e3779f9ULL;
+    const uint64_t PRIME_4 = 0x85ebca77c2b2ae63ULL;
+
+    uint64_t rotate_left(const uint64_t value_, const int bits_)
+    {
+      return (value_ << bits_) | (value_ >> (64 - bits_));
+    }
+
+    uint64_t word(const int64_t value_)
+    {
+      return static_cast<uint64_t>(value_);
+    }
+
+    void add_waveform(fingerprint_hasher & hasher_,
+                      const snfee::data::calo_digitized_hit & red_calo_hit_,
+                      const waveform_config & config_)
+    {
+      const std::vector<int16_t> & samples = red_calo_hit_.get_waveform();
+      std::size_t first = 0;
+      std::size_t last = samples.size();
+      switch (config_.mode)
+        {
+        case waveform_mode::none:
+          return;
+        case waveform_mode::roi:
+          pulse_window(red_calo_hit_, config_.roi_before, config_.roi_after, first, last);
+          break;
+        case waveform_mode::full:
+        case waveform_mode::packed:
+          // The packed encoding is lossless, the samples are the same as in full mode
+          break;
+        }
+      hasher_.add(first);
+      hasher_.add_samples(samples.data() + first, last - first);
+      return;
+    }
+
+    /// Same words as add_waveform() for the RED samples stored in the UDD hit
+    void add_udd_waveform(fingerprint_hasher & hasher_,
+                          const snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit_,
+                          const waveform_config & config_)
+    {
+      static thread_local std::vector<int16_t> samples;
+      std::size_t first_cell = 0;
+      decode_waveform(udd_calo_hit_, samples, first_cell);
+      // Without waveform storage, samples stored anyway make the fingerprints differ
+      if (config_.mode == waveform_mode::none && samples.empty()) return;
+      hasher_.add(first_cell);
+      hasher_.add_samples(samples.data(), samples.size());
+      return;
+    }
+
+    std::string scheme_string(const waveform_config & config_)
+    {
+      std::ostringstream scheme;
+      scheme << FINGERPRINT_VERSION << '/' << to_string(config_.mode);
+      if (config_.mode == waveform_mode::roi) scheme << '/' << config_.roi_before << '/' << config_.roi_after;
+      return scheme.str();
+    }
+
+    bool parse_scheme(const std::string & scheme_, waveform_config & config_)
+    {
+      std::vector<std::string> fields;
+      std::istringstream scheme(scheme_);
+      std::string field;
+      while (std::getline(scheme, field, '/')) fields.push_back(field);
+      if (fields.size() < 2 || fields[0] != std::to_string(FINGERPRINT_VERSION)) return false;
+      waveform_config config;
+      if (fields[1] == "none") config.mode = waveform_mode::none;
+      else if (fields[1] == "full") config.mode = waveform_mode::full;
+      else if (fields[1] == "packed") config.mode = waveform_mode::packed;
+      else if (fields[1] == "roi" && fields.size() == 4)
+        {
+          config.mode = waveform_mode::roi;
+          config.roi_before = std::strtoul(fields[2].c_str(), NULL, 10);
+          config.roi_after = std::strtoul(fields[3].c_str(), NULL, 10);
+        }
+      else return false;
+      config_ = config;
+      return true;
+    }
+
+  } // namespace
+
+  uint64_t fingerprint_mix(uint64_t value_)
+  {
+    value_ ^= value_ >> 33;
+    value_ *= 0xff51afd7ed558ccdULL;
+    value_ ^= value_ >> 33;
+    value_ *= 0xc4ceb9fe1a85ec53ULL;
+    value_ ^= value_ >> 33;
+    return value_;
+  }
+
+  const std::string FINGERPRINT_KEY = "snredbridge.fingerprint";
+  const std::string FINGERPRINT_SCHEME_KEY = "snredbridge.fingerprint_scheme";
+
+  bool event_fingerprint::operator==(const event_fingerprint & other_) const
+  {
+    return high == other_.high && low == other_.low;
+  }
+
+  bool event_fingerprint::operator!=(const event_fingerprint & other_) const
+  {
+    return !(*this == other_);
+  }
+
+  std::string event_fingerprint::to_string() const
+  {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(32, '0');
+    for (int i = 0; i < 16; i++)
+      {
+        text[15 - i] = digits[(high >> (4 * i)) & 0xf];
+        text[31 - i] = digits[(low >> (4 * i)) & 0xf];
+      }
+    return text;
+  }
+
+  bool event_fingerprint::from_string(const std::string & text_, event_fingerprint & fingerprint_)
+  {
+    if (text_.size() != 32) return false;
+    event_fingerprint fingerprint;
+    for (std::size_t i = 0; i < 32; i++)
+      {
+        const char c = text_[i];
+        uint64_t digit = 0;
+        if (c >= '0' && c <= '9') digit = c - '0';
+        else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+        else return false;
+        uint64_t & half = i < 16 ? fingerprint.high : fingerprint.low;
+        half = (half << 4) | digit;
+      }
+    fingerprint_ = fingerprint;
+    return true;
+  }
+
+  void fingerprint_hasher::add(const uint64_t value_)
+  {
+    _lane_a_ = rotate_left(_lane_a_ ^ (value_ * PRIME_2), 31) * PRIME_1;
+    _lane_b_ = rotate_left(_lane_b_ + (value_ * PRIME_3), 27) * PRIME_1 + PRIME_4;
+    _words_++;
+    return;
+  }
+
+  void fingerprint_hasher::add_samples(const int16_t * samples_, const std::size_t size_)
+  {
+    add(size_);
+    // Four samples per word
+    std::size_t isample = 0;
+    for (; isample + 4 <= size_; isample += 4)
+      add(uint64_t(uint16_t(samples_[isample]))
+          | (uint64_t(uint16_t(samples_[isample + 1])) << 16)
+          | (uint64_t(uint16_t(samples_[isample + 2])) << 32)
+          | (uint64_t(uint16_t(samples_[isample + 3])) << 48));
+    uint64_t tail = 0;
+    for (int shift = 0; isample < size_; isample++, shift += 16)
+      tail |= uint64_t(uint16_t(samples_[isample])) << shift;
+    if (size_ % 4 != 0) add(tail);
+    return;
+  }
+
+  event_fingerprint fingerprint_hasher::finish() const
+  {
+    event_fingerprint fingerprint;
+    fingerprint.high = fingerprint_mix(_lane_a_ ^ fingerprint_mix(_words_));
+    fingerprint.low = fingerprint_mix(_lane_b_ + fingerprint.high);
+    return fingerprint;
+  }
+
+  event_fingerprint compute_red_fingerprint(const snfee::data::raw_event_data & red_,
+                                            const waveform_config & waveform_config_)
+  {
+    fingerprint_hasher hasher;
+    hasher.add(word(red_.get_run_id()));
+    hasher.add(word(red_.get_event_id()));
+    hasher.add(word(red_.get_reference_time().get_ticks()));
+    const std::set<int32_t> & trigger_ids = red_.get_origin_trigger_ids();
+    hasher.add(trigger_ids.size());
+    for (const int32_t trigger_id : trigger_ids) hasher.add(word(trigger_id));
+
+    const std::vector<snfee::data::calo_digitized_hit> & calo_hits = red_.get_calo_hits();
+    hasher.add(calo_hits.size());
+    for (const snfee::data::calo_digitized_hit & calo_hit : calo_hits)
+      {
+        mapping::calo_hit_fields::hash(hasher, calo_hit);
+        add_waveform(hasher, calo_hit, waveform_config_);
+      }
+
+    const std::vector<snfee::data::tracker_digitized_hit> & tracker_hits = red_.get_tracker_hits();
+    hasher.add(tracker_hits.size());
+    for (const snfee::data::tracker_digitized_hit & tracker_hit : tracker_hits)
+      {
+        mapping::tracker_hit_fields::hash(hasher, tracker_hit);
+        const std::vector<snfee::data::tracker_digitized_hit::gg_times> & gg_times = tracker_hit.get_times();
+        hasher.add(gg_times.size());
+        for (const snfee::data::tracker_digitized_hit::gg_times & gg_time : gg_times)
+          mapping::gg_times_fields::hash(hasher, gg_time);
+      }
+    return hasher.finish();
+  }
+
+  event_fingerprint compute_udd_fingerprint(const snemo::datamodel::unified_digitized_data & udd_,
+                                            const waveform_config & waveform_config_)
+  {
+    // Same words in the same order as compute_red_fingerprint()
+    fingerprint_hasher hasher;
+    hasher.add(word(udd_.get_run_id()));
+    hasher.add(word(udd_.get_event_id()));
+    hasher.add(word(udd_.get_reference_timestamp()));
+    const std::set<int32_t> & trigger_ids = udd_.get_origin_trigger_ids();
+    hasher.add(trigger_ids.size());
+    for (const int32_t trigger_id : trigger_ids) hasher.add(word(trigger_id));
+
+    const auto & calo_hits = udd_.get_calorimeter_hits();
+    hasher.add(calo_hits.size());
+    for (const auto & calo_handle : calo_hits)
+      {
+        const snemo::datamodel::calorimeter_digitized_hit & calo_hit = calo_handle.get();
+        mapping::calo_hit_fields::hash(hasher, calo_hit);
+        add_udd_waveform(hasher, calo_hit, waveform_config_);
+      }
+
+    const auto & tracker_hits = udd_.get_tracker_hits();
+    hasher.add(tracker_hits.size());
+    for (const auto & tracker_handle : tracker_hits)
+      {
+        const snemo::datamodel::tracker_digitized_hit & tracker_hit = tracker_handle.get();
+        mapping::tracker_hit_fields::hash(hasher, tracker_hit);
+        const std::vector<snemo::datamodel::tracker_digitized_hit::gg_times> & gg_times = tracker_hit.get_times();
+        hasher.add(gg_times.size());
+        for (const snemo::datamodel::tracker_digitized_hit::gg_times & gg_time : gg_times)
+          mapping::gg_times_fields::hash(hasher, gg_time);
+      }
+    return hasher.finish();
+  }
+
+  void store_fingerprint(const snfee::data::raw_event_data & red_,
+                         const waveform_config & waveform_config_,
+                         snemo::datamodel::event_header & event_header_)
+  {
+    datatools::properties & properties = event_header_.get_properties();
+    properties.update_string(FINGERPRINT_KEY, compute_red_fingerprint(red_, waveform_config_).to_string());
+    properties.update_string(FINGERPRINT_SCHEME_KEY, scheme_string(waveform_config_));
+    return;
+  }
+
+  void store_fingerprint(const snfee::data::raw_event_data & red_,
+                         const waveform_config & waveform_config_,
+                         datatools::things & event_record_)
+  {
+    static const std::string eh_tag = "EH";
+    store_fingerprint(red_, waveform_config_, event_record_.grab<snemo::datamodel::event_header>(eh_tag));
+    return;
+  }
+
+  bool fetch_fingerprint(const snemo::datamodel::event_header & event_header_,
+                         event_fingerprint & fingerprint_,
+                         waveform_config & waveform_config_)
+  {
+    const datatools::properties & properties = event_header_.get_properties();
+    if (!properties.has_key(FINGERPRINT_KEY) || !properties.has_key(FINGERPRINT_SCHEME_KEY)) return false;
+    return parse_scheme(properties.fetch_string(FINGERPRINT_SCHEME_KEY), waveform_config_)
+      && event_fingerprint::from_string(properties.fetch_string(FINGERPRINT_KEY), fingerprint_);
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,117 @@
+/// \file snredbridge/event_fingerprint.h
+/// 128 bits fingerprint of the content of a RED event as converted into UDD,
+/// stored in the event header to validate UDD files without a full comparison
+
+#ifndef SNREDBRIDGE_EVENT_FINGERPRINT_H
+#define SNREDBRIDGE_EVENT_FINGERPRINT_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/things.h>
+
+// - Falaise:
+#include <falaise/snemo/datamodels/event_header.h>
+#include <falaise/snemo/datamodels/unified_digitized_data.h>
+
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+// This project:
+#include <snredbridge/waveform_codec.h>
+
+namespace snredbridge {
+
+  /// \brief Fingerprint of an event
+  ///
+  /// The fingerprint hashes the fields of a RED event copied into the EH and
+  /// UDD banks, in a canonical order: run and event IDs, reference time,
+  /// trigger IDs, then each calo hit (with its waveform as stored by the
+  /// waveform mode) and each tracker hit with its GG times, the fields of the
+  /// hits in the order of the tables of snredbridge/field_mapping.h. Two conversions
+  /// of the same RED event with the same waveform storage have the same
+  /// fingerprint. It is not a cryptographic hash: it detects corrupted or
+  /// mismatched events, not forged ones.
+  struct event_fingerprint
+  {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    bool operator==(const event_fingerprint & other_) const;
+    bool operator!=(const event_fingerprint & other_) const;
+
+    /// Hexadecimal form (32 digits)
+    std::string to_string() const;
+
+    /// Parse the hexadecimal form, false if it is not valid
+    static bool from_string(const std::string & text_, event_fingerprint & fingerprint_);
+  };
+
+  /// Finalization mixer of MurmurHash3: each bit of the result depends on
+  /// all the bits of the value
+  uint64_t fingerprint_mix(uint64_t value_);
+
+  /// \brief Incremental hash of 64 bits words into a fingerprint
+  ///
+  /// Two independent 64 bits lanes, finalized with the MurmurHash3 mixer.
+  class fingerprint_hasher
+  {
+  public:
+
+    /// Add a word
+    void add(const uint64_t value_);
+
+    /// Add a sequence of samples, preceded by its size
+    void add_samples(const int16_t * samples_, const std::size_t size_);
+
+    /// Fingerprint of the words added so far
+    event_fingerprint finish() const;
+
+  private:
+
+    uint64_t _lane_a_ = 0x9e3779b97f4a7c15ULL;
+    uint64_t _lane_b_ = 0x243f6a8885a308d3ULL;
+    uint64_t _words_ = 0;
+  };
+
+  /// Name of the event header property holding the fingerprint
+  extern const std::string FINGERPRINT_KEY;
+
+  /// Name of the event header property holding the fingerprint scheme
+  /// (version and waveform storage, as "2/roi/32/96")
+  extern const std::string FINGERPRINT_SCHEME_KEY;
+
+  /// Fingerprint of a RED event converted with a waveform storage
+  event_fingerprint compute_red_fingerprint(const snfee::data::raw_event_data & red_,
+                                            const waveform_config & waveform_config_);
+
+  /// Fingerprint of the content of a UDD bank, with the waveforms decoded
+  /// from their storage. It is the fingerprint of the RED event the bank was
+  /// converted from with the same waveform storage, unless the UDD content
+  /// differs. Throws if a stored waveform cannot be decoded.
+  event_fingerprint compute_udd_fingerprint(const snemo::datamodel::unified_digitized_data & udd_,
+                                            const waveform_config & waveform_config_);
+
+  /// Store the fingerprint of the RED event converted into an event header
+  void store_fingerprint(const snfee::data::raw_event_data & red_,
+                         const waveform_config & waveform_config_,
+                         snemo::datamodel::event_header & event_header_);
+
+  /// Same as above, into the "EH" bank of an event record
+  void store_fingerprint(const snfee::data::raw_event_data & red_,
+                         const waveform_config & waveform_config_,
+                         datatools::things & event_record_);
+
+  /// Fingerprint stored in an event header and the waveform storage it was
+  /// computed with, false if there is none or its scheme is not supported
+  bool fetch_fingerprint(const snemo::datamodel::event_header & event_header_,
+                         event_fingerprint & fingerprint_,
+                         waveform_config & waveform_config_);
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_EVENT_FINGERPRINT_H
@@ -0,0 +1,258 @@
+// Ourselves:
+#include <snredbridge/event_matcher.h>
+
+// Standard library:
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+// Third party:
+// - Falaise:
+#include <falaise/snemo/datamodels/event_header.h>
+
+namespace snredbridge {
+
+  event_key::event_key(const int32_t run_id_, const int32_t event_id_)
+    : run_id(run_id_)
+    , event_id(event_id_)
+  {
+    return;
+  }
+
+  event_key event_key::from_red(const snfee::data::raw_event_data & red_)
+  {
+    return event_key(red_.get_run_id(), red_.get_event_id());
+  }
+
+  event_key event_key::from_event_record(const datatools::things & event_record_)
+  {
+    const auto & EH = event_record_.get<snemo::datamodel::event_header>("EH");
+    return event_key(EH.get_id().get_run_number(), EH.get_id().get_event_number());
+  }
+
+  bool event_key::operator<(const event_key & other_) const
+  {
+    if (run_id != other_.run_id) return run_id < other_.run_id;
+    return event_id < other_.event_id;
+  }
+
+  bool event_key::operator==(const event_key & other_) const
+  {
+    return run_id == other_.run_id && event_id == other_.event_id;
+  }
+
+  std::ostream & operator<<(std::ostream & out_, const event_key & key_)
+  {
+    out_ << "run #" << key_.run_id << " event #" << key_.event_id;
+    return out_;
+  }
+
+  // ---------------------------------------------------------------------
+
+  const std::size_t event_key_registry::MIN_BITMAP_SIZE;
+  const std::size_t event_key_registry::MAX_BITMAP_SIZE;
+
+  bool event_key_registry::insert(const event_key & key_)
+  {
+    std::vector<bool> & event_ids = _event_ids_per_run_[key_.run_id];
+    const std::size_t index = key_.event_id;
+    if (key_.event_id >= 0 && index >= event_ids.size())
+      {
+        // Doubling the bitmap covers the next IDs of a run, an ID beyond it
+        // goes to the set
+        const std::size_t size = std::min(std::max(MIN_BITMAP_SIZE, 2 * event_ids.size()), MAX_BITMAP_SIZE);
+        if (index < size)
+          {
+            const std::size_t old_size = event_ids.size();
+            event_ids.resize(size, false);
+            // The keys of the set now in the bitmap move into it
+            auto first = _sparse_keys_.lower_bound(event_key(key_.run_id, static_cast<int32_t>(old_size)));
+            auto last = _sparse_keys_.lower_bound(event_key(key_.run_id, static_cast<int32_t>(size)));
+            for (auto sparse = first; sparse != last; ++sparse) event_ids[sparse->event_id] = true;
+            _sparse_keys_.erase(first, last);
+          }
+      }
+    if (key_.event_id < 0 || index >= event_ids.size())
+      {
+        if (!_sparse_keys_.insert(key_).second) return false;
+        _size_++;
+        return true;
+      }
+    if (event_ids[index]) return false;
+    event_ids[index] = true;
+    _size_++;
+    return true;
+  }
+
+  bool event_key_registry::contains(const event_key & key_) const
+  {
+    auto found = _event_ids_per_run_.find(key_.run_id);
+    const std::size_t index = key_.event_id;
+    if (key_.event_id >= 0 && found != _event_ids_per_run_.end() && index < found->second.size())
+      return found->second[index];
+    return _sparse_keys_.count(key_) > 0;
+  }
+
+  std::size_t event_key_registry::size() const
+  {
+    return _size_;
+  }
+
+  // ---------------------------------------------------------------------
+
+  event_matcher::event_matcher(const std::size_t window_)
+    : _window_(window_ == 0 ? 1 : window_)
+  {
+    return;
+  }
+
+  void event_matcher::set_match_callback(const match_callback & callback_)
+  {
+    _match_callback_ = callback_;
+    return;
+  }
+
+  void event_matcher::set_pair_callback(const pair_callback & callback_)
+  {
+    _pair_callback_ = callback_;
+    return;
+  }
+
+  void event_matcher::set_missing_callback(const unmatched_callback & callback_)
+  {
+    _missing_callback_ = callback_;
+    return;
+  }
+
+  void event_matcher::set_extra_callback(const unmatched_callback & callback_)
+  {
+    _extra_callback_ = callback_;
+    return;
+  }
+
+  void event_matcher::add_red(std::unique_ptr<snfee::data::raw_event_data> red_, const std::size_t position_)
+  {
+    const event_key key = event_key::from_red(*red_);
+    const std::size_t sequence = _red_sequence_++;
+    if (!_red_keys_.insert(key))
+      {
+        _counters_.duplicated_red++;
+        return;
+      }
+
+    auto found = _pending_udd_.find(key);
+    if (found != _pending_udd_.end())
+      {
+        _counters_.matched++;
+        if (_pair_callback_) _pair_callback_(std::move(red_), std::move(found->second.data));
+        else if (_match_callback_) _match_callback_(*red_, *found->second.data);
+        _pending_udd_order_.erase(found->second.sequence);
+        _pending_udd_.erase(found);
+        return;
+      }
+
+    _evict_aged_red_();
+    if (_pending_red_.size() >= _window_) _evict_red_();
+    pending_event<snfee::data::raw_event_data> & pending = _pending_red_[key];
+    pending.position = position_;
+    pending.sequence = sequence;
+    pending.data = std::move(red_);
+    _pending_red_order_.emplace(sequence, key);
+    return;
+  }
+
+  void event_matcher::add_udd(std::unique_ptr<datatools::things> event_record_, const std::size_t position_)
+  {
+    const event_key key = event_key::from_event_record(*event_record_);
+    const std::size_t sequence = _udd_sequence_++;
+    if (!_udd_keys_.insert(key))
+      {
+        _counters_.duplicated_udd++;
+        return;
+      }
+
+    auto found = _pending_red_.find(key);
+    if (found != _pending_red_.end())
+      {
+        _counters_.matched++;
+        if (_pair_callback_) _pair_callback_(std::move(found->second.data), std::move(event_record_));
+        else if (_match_callback_) _match_callback_(*found->second.data, *event_record_);
+        _pending_red_order_.erase(found->second.sequence);
+        _pending_red_.erase(found);
+        return;
+      }
+
+    _evict_aged_udd_();
+    if (_pending_udd_.size() >= _window_) _evict_udd_();
+    pending_event<datatools::things> & pending = _pending_udd_[key];
+    pending.position = position_;
+    pending.sequence = sequence;
+    pending.data = std::move(event_record_);
+    _pending_udd_order_.emplace(sequence, key);
+    return;
+  }
+
+  void event_matcher::flush()
+  {
+    while (!_pending_red_.empty()) _evict_red_();
+    while (!_pending_udd_.empty()) _evict_udd_();
+    _pending_red_order_.clear();
+    _pending_udd_order_.clear();
+    return;
+  }
+
+  std::size_t event_matcher::get_number_of_pending_red() const
+  {
+    return _pending_red_.size();
+  }
+
+  std::size_t event_matcher::get_number_of_pending_udd() const
+  {
+    return _pending_udd_.size();
+  }
+
+  const event_matcher::counters & event_matcher::get_counters() const
+  {
+    return _counters_;
+  }
+
+  void event_matcher::_evict_red_()
+  {
+    if (_pending_red_order_.empty()) return;
+    const auto oldest = _pending_red_order_.begin();
+    auto found = _pending_red_.find(oldest->second);
+    _counters_.missing++;
+    if (_missing_callback_) _missing_callback_(oldest->second, found->second.position);
+    _pending_red_.erase(found);
+    _pending_red_order_.erase(oldest);
+    return;
+  }
+
+  void event_matcher::_evict_udd_()
+  {
+    if (_pending_udd_order_.empty()) return;
+    const auto oldest = _pending_udd_order_.begin();
+    auto found = _pending_udd_.find(oldest->second);
+    _counters_.extra++;
+    if (_extra_callback_) _extra_callback_(oldest->second, found->second.position);
+    _pending_udd_.erase(found);
+    _pending_udd_order_.erase(oldest);
+    return;
+  }
+
+  void event_matcher::_evict_aged_red_()
+  {
+    // More than window RED events were added after the oldest waiting one
+    while (!_pending_red_order_.empty() && _red_sequence_ - 1 - _pending_red_order_.begin()->first > _window_)
+      _evict_red_();
+    return;
+  }
+
+  void event_matcher::_evict_aged_udd_()
+  {
+    while (!_pending_udd_order_.empty() && _udd_sequence_ - 1 - _pending_udd_order_.begin()->first > _window_)
+      _evict_udd_();
+    return;
+  }
+
+} // namespace snredbridge
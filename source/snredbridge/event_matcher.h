@@ -0,0 +1,173 @@
+/// \file snredbridge/event_matcher.h
+/// Pairing of RED events with UDD event records by (run ID, event ID),
+/// whatever the order of the events in each stream
+
+#ifndef SNREDBRIDGE_EVENT_MATCHER_H
+#define SNREDBRIDGE_EVENT_MATCHER_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/things.h>
+
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+namespace snredbridge {
+
+  /// Identifier of an event in a data stream
+  struct event_key
+  {
+    int32_t run_id = -1;
+    int32_t event_id = -1;
+
+    event_key() = default;
+    event_key(const int32_t run_id_, const int32_t event_id_);
+
+    /// Key of a RED event
+    static event_key from_red(const snfee::data::raw_event_data & red_);
+
+    /// Key of an event record, taken from its "EH" bank
+    static event_key from_event_record(const datatools::things & event_record_);
+
+    bool operator<(const event_key & other_) const;
+    bool operator==(const event_key & other_) const;
+  };
+
+  std::ostream & operator<<(std::ostream & out_, const event_key & key_);
+
+  /// Set of the event keys already seen in a stream, stored as one bit per
+  /// event ID for each run. The bitmap of a run only grows by doubling from
+  /// the IDs already seen, up to a maximum size: negative IDs and IDs far
+  /// beyond the bitmap (corrupted ones for example) are kept in a set, so that
+  /// a single large ID does not allocate the bits of all the IDs below it.
+  class event_key_registry
+  {
+  public:
+
+    /// Insert a key, return false if it was already registered
+    bool insert(const event_key & key_);
+
+    /// Check if a key is registered
+    bool contains(const event_key & key_) const;
+
+    /// Number of registered keys
+    std::size_t size() const;
+
+    /// Event IDs from 0 always stored in the bitmap
+    static const std::size_t MIN_BITMAP_SIZE = 1 << 16;
+
+    /// Maximum bits of the bitmap of a run (16 MiB)
+    static const std::size_t MAX_BITMAP_SIZE = std::size_t(1) << 27;
+
+  private:
+
+    std::map<int32_t, std::vector<bool>> _event_ids_per_run_;
+    std::set<event_key> _sparse_keys_; ///< Keys with a negative event ID or beyond the bitmap of their run
+    std::size_t _size_ = 0;
+  };
+
+  /// \brief Matching engine for RED and UDD streams
+  ///
+  /// RED events and UDD event records are fed in any order, in a single pass
+  /// over each stream. An event is handed to the match callback as soon as
+  /// its counterpart from the other stream is available. Unmatched events
+  /// wait in a bounded window: an event is reported missing (RED event
+  /// without UDD record) or extra (UDD record without RED event) once more
+  /// than window events were added after it to its stream. The memory stays
+  /// bounded even if an early event never finds its counterpart. Events
+  /// already seen in the same stream are reported as duplicated and not
+  /// matched.
+  class event_matcher
+  {
+  public:
+
+    typedef std::function<void(const snfee::data::raw_event_data &, const datatools::things &)> match_callback;
+    typedef std::function<void(const event_key &, const std::size_t)> unmatched_callback;
+    typedef std::function<void(std::unique_ptr<snfee::data::raw_event_data>,
+                               std::unique_ptr<datatools::things>)> pair_callback;
+
+    /// Counters of the matching
+    struct counters
+    {
+      std::size_t matched = 0;        ///< Pairs of RED and UDD events
+      std::size_t missing = 0;        ///< RED events without UDD event record
+      std::size_t extra = 0;          ///< UDD event records without RED event
+      std::size_t duplicated_red = 0; ///< RED events already seen in the RED stream
+      std::size_t duplicated_udd = 0; ///< UDD event records already seen in the UDD stream
+    };
+
+    /// Constructor with the maximum number of unmatched events kept per stream
+    explicit event_matcher(const std::size_t window_ = 256);
+
+    void set_match_callback(const match_callback & callback_);
+
+    /// Hand over the matched events instead of calling the match callback,
+    /// for a processing on another thread
+    void set_pair_callback(const pair_callback & callback_);
+
+    void set_missing_callback(const unmatched_callback & callback_);
+    void set_extra_callback(const unmatched_callback & callback_);
+
+    /// Add the RED event read at a given position of the RED stream
+    void add_red(std::unique_ptr<snfee::data::raw_event_data> red_, const std::size_t position_);
+
+    /// Add the event record read at a given position of the UDD stream
+    void add_udd(std::unique_ptr<datatools::things> event_record_, const std::size_t position_);
+
+    /// Report all events still waiting for their counterpart (end of both streams)
+    void flush();
+
+    /// Number of RED events waiting for their UDD event record
+    std::size_t get_number_of_pending_red() const;
+
+    /// Number of UDD event records waiting for their RED event
+    std::size_t get_number_of_pending_udd() const;
+
+    const counters & get_counters() const;
+
+  private:
+
+    template <typename T>
+    struct pending_event
+    {
+      std::size_t position = 0;
+      std::size_t sequence = 0; ///< Number of events added to the stream before
+      std::unique_ptr<T> data;
+    };
+
+    /// Report the oldest waiting event
+    void _evict_red_();
+    void _evict_udd_();
+
+    /// Report the waiting events older than the window
+    void _evict_aged_red_();
+    void _evict_aged_udd_();
+
+    std::size_t _window_;
+    match_callback _match_callback_;
+    pair_callback _pair_callback_;
+    unmatched_callback _missing_callback_;
+    unmatched_callback _extra_callback_;
+    event_key_registry _red_keys_;
+    event_key_registry _udd_keys_;
+    std::map<event_key, pending_event<snfee::data::raw_event_data>> _pending_red_;
+    std::map<event_key, pending_event<datatools::things>> _pending_udd_;
+    std::map<std::size_t, event_key> _pending_red_order_; ///< Waiting RED events by sequence, oldest first
+    std::map<std::size_t, event_key> _pending_udd_order_; ///< Waiting UDD events by sequence, oldest first
+    std::size_t _red_sequence_ = 0; ///< Number of RED events added
+    std::size_t _udd_sequence_ = 0; ///< Number of UDD event records added
+    counters _counters_;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_EVENT_MATCHER_H
@@ -0,0 +1,68 @@
+// Ourselves:
+#include <snredbridge/event_record_roundtrip.h>
+
+// Third party:
+// - Boost:
+#include <boost/serialization/nvp.hpp>
+
+// - Bayeux:
+#include <bayeux/datatools/archives_list.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    /// Store the event record as the Bayeux data writer does, then load it back
+    template <typename OArchive, typename IArchive>
+    void store_and_load(std::stringstream & buffer_,
+                        const datatools::things & event_record_,
+                        datatools::things & copy_,
+                        std::size_t & size_)
+    {
+      {
+        OArchive archive(buffer_);
+        archive << boost::serialization::make_nvp("record", event_record_);
+      }
+      size_ = buffer_.tellp();
+      copy_.clear();
+      {
+        IArchive archive(buffer_);
+        archive >> boost::serialization::make_nvp("record", copy_);
+      }
+      return;
+    }
+
+  } // namespace
+
+  event_record_roundtrip::event_record_roundtrip(const archive_format format_)
+    : _format_(format_)
+  {
+    return;
+  }
+
+  void event_record_roundtrip::process(const datatools::things & event_record_,
+                                       datatools::things & copy_)
+  {
+    _buffer_.str(std::string());
+    _buffer_.clear();
+    switch (_format_)
+      {
+      case archive_format::portable_binary:
+        store_and_load<eos::portable_oarchive, eos::portable_iarchive>(_buffer_, event_record_, copy_, _last_size_);
+        break;
+      case archive_format::text:
+        store_and_load<boost::archive::text_oarchive, boost::archive::text_iarchive>(_buffer_, event_record_, copy_, _last_size_);
+        break;
+      case archive_format::xml:
+        store_and_load<boost::archive::xml_oarchive, boost::archive::xml_iarchive>(_buffer_, event_record_, copy_, _last_size_);
+        break;
+      }
+    return;
+  }
+
+  std::size_t event_record_roundtrip::get_last_size() const
+  {
+    return _last_size_;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,49 @@
+/// \file snredbridge/event_record_roundtrip.h
+/// In-memory serialization round trip of datatools::things event records
+
+#ifndef SNREDBRIDGE_EVENT_RECORD_ROUNDTRIP_H
+#define SNREDBRIDGE_EVENT_RECORD_ROUNDTRIP_H
+
+// Standard library:
+#include <cstddef>
+#include <sstream>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/things.h>
+
+// This project:
+#include <snredbridge/udd_writer.h>
+
+namespace snredbridge {
+
+  /// \brief Serialization round trip of event records through a memory buffer
+  ///
+  /// The event record is stored with the Boost archive used by the dpp output
+  /// module for the output file, then loaded back into another event record.
+  /// The buffer is kept from one event to the next.
+  class event_record_roundtrip
+  {
+  public:
+
+    /// Constructor with the archive of the output file, see
+    /// archive_format_from_filename()
+    explicit event_record_roundtrip(const archive_format format_ = archive_format::portable_binary);
+
+    /// Store an event record into the buffer and load it back into copy_
+    void process(const datatools::things & event_record_,
+                 datatools::things & copy_);
+
+    /// Size in bytes of the last serialized event record
+    std::size_t get_last_size() const;
+
+  private:
+
+    archive_format _format_;
+    std::stringstream _buffer_;
+    std::size_t _last_size_ = 0;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_EVENT_RECORD_ROUNDTRIP_H
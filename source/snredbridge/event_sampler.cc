@@ -0,0 +1,65 @@
+// Ourselves:
+#include <snredbridge/event_sampler.h>
+
+// Standard library:
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+// This project:
+#include <snredbridge/event_fingerprint.h>
+
+namespace snredbridge {
+
+  event_sampler::event_sampler(const double fraction_, const uint64_t seed_)
+    : _fraction_(fraction_)
+    , _seed_(seed_)
+    , _threshold_(0)
+  {
+    DT_THROW_IF(!(fraction_ >= 0.0 && fraction_ <= 1.0), std::logic_error,
+                "Invalid fraction of sampled events " << fraction_ << "!");
+    _all_ = fraction_ >= 1.0;
+    if (!_all_) _threshold_ = static_cast<uint64_t>(std::ldexp(fraction_, 64));
+    return;
+  }
+
+  bool event_sampler::is_sampled(const event_key & key_) const
+  {
+    if (_all_) return true;
+    const uint64_t key = (uint64_t(uint32_t(key_.run_id)) << 32) | uint64_t(uint32_t(key_.event_id));
+    const uint64_t seed = fingerprint_mix(_seed_ + 0x9e3779b97f4a7c15ULL);
+    return fingerprint_mix(fingerprint_mix(key ^ seed)) < _threshold_;
+  }
+
+  double event_sampler::get_fraction() const
+  {
+    return _fraction_;
+  }
+
+  uint64_t event_sampler::get_seed() const
+  {
+    return _seed_;
+  }
+
+  rate_interval wilson_interval(const std::size_t failures_,
+                                const std::size_t trials_,
+                                const double z_)
+  {
+    rate_interval interval;
+    if (trials_ == 0) return interval;
+    const double n = static_cast<double>(trials_);
+    const double p = static_cast<double>(failures_) / n;
+    const double z2 = z_ * z_;
+    const double denominator = 1.0 + z2 / n;
+    const double center = (p + z2 / (2.0 * n)) / denominator;
+    const double half_width = z_ * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) / denominator;
+    interval.low = std::max(0.0, center - half_width);
+    interval.high = std::min(1.0, center + half_width);
+    return interval;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,60 @@
+/// \file snredbridge/event_sampler.h
+/// Reproducible sampling of the events checked in depth by the validation
+
+#ifndef SNREDBRIDGE_EVENT_SAMPLER_H
+#define SNREDBRIDGE_EVENT_SAMPLER_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+
+// This project:
+#include <snredbridge/event_matcher.h>
+
+namespace snredbridge {
+
+  /// \brief Sampling of events by their key
+  ///
+  /// An event is sampled if a hash of its (run ID, event ID) and of the seed
+  /// falls below the fraction. The selection does not depend on the order or
+  /// the number of the events, nor on the files they are read from: the same
+  /// fraction and seed always sample the same events of a run, and the
+  /// events sampled with a fraction are also sampled with a larger one.
+  class event_sampler
+  {
+  public:
+
+    /// Constructor with the fraction of sampled events, in [0, 1]
+    explicit event_sampler(const double fraction_ = 1.0, const uint64_t seed_ = 0);
+
+    /// Check if an event is sampled
+    bool is_sampled(const event_key & key_) const;
+
+    double get_fraction() const;
+
+    uint64_t get_seed() const;
+
+  private:
+
+    double _fraction_;
+    uint64_t _seed_;
+    uint64_t _threshold_; ///< Events with a hash below are sampled
+    bool _all_ = true;
+  };
+
+  /// Confidence interval of a rate
+  struct rate_interval
+  {
+    double low = 0.0;
+    double high = 1.0;
+  };
+
+  /// Wilson score interval of a rate from a number of failures among trials,
+  /// for a confidence level given by z_ (1.96 for 95%)
+  rate_interval wilson_interval(const std::size_t failures_,
+                                const std::size_t trials_,
+                                const double z_ = 1.96);
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_EVENT_SAMPLER_H
@@ -0,0 +1,195 @@
+// Ourselves:
+#include <snredbridge/event_selection.h>
+
+// Standard library:
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    std::string trim(const std::string & text_)
+    {
+      const std::size_t first = text_.find_first_not_of(" \t");
+      if (first == std::string::npos) return "";
+      const std::size_t last = text_.find_last_not_of(" \t");
+      return text_.substr(first, last - first + 1);
+    }
+
+  } // namespace
+
+  const std::vector<std::string> & event_selection::get_variable_names()
+  {
+    // Same order as variable_type
+    static const std::vector<std::string> names = {
+      "run_id",
+      "event_id",
+      "calo_hits",
+      "high_threshold_calo_hits",
+      "low_threshold_only_calo_hits",
+      "tracker_hits",
+      "gg_times",
+      "trigger_ids",
+      "trigger_id"
+    };
+    return names;
+  }
+
+  void event_selection::add_cut(const std::string & expression_)
+  {
+    // Two characters operators are searched first
+    static const std::vector<std::pair<std::string, operator_type>> operators = {
+      {"==", OP_EQUAL},
+      {"!=", OP_NOT_EQUAL},
+      {"<=", OP_LESS_EQUAL},
+      {">=", OP_GREATER_EQUAL},
+      {"<", OP_LESS},
+      {">", OP_GREATER}
+    };
+    std::size_t op_position = std::string::npos;
+    std::size_t op_length = 0;
+    operator_type op = OP_EQUAL;
+    for (const auto & candidate : operators)
+      {
+        op_position = expression_.find(candidate.first);
+        if (op_position != std::string::npos)
+          {
+            op_length = candidate.first.size();
+            op = candidate.second;
+            break;
+          }
+      }
+    DT_THROW_IF(op_position == std::string::npos, std::logic_error,
+                "Missing comparison operator in cut '" << expression_ << "'!");
+
+    const std::string variable_name = trim(expression_.substr(0, op_position));
+    const std::string value_text = trim(expression_.substr(op_position + op_length));
+
+    const std::vector<std::string> & names = get_variable_names();
+    std::size_t ivariable = 0;
+    while (ivariable < names.size() && names[ivariable] != variable_name) ivariable++;
+    DT_THROW_IF(ivariable == names.size(), std::logic_error,
+                "Unknown variable '" << variable_name << "' in cut '" << expression_ << "'!");
+
+    char * value_end = nullptr;
+    const long long value = std::strtoll(value_text.c_str(), &value_end, 10);
+    DT_THROW_IF(value_text.empty() || *value_end != '\0', std::logic_error,
+                "Invalid integer value '" << value_text << "' in cut '" << expression_ << "'!");
+
+    cut_type new_cut;
+    new_cut.variable = static_cast<variable_type>(ivariable);
+    new_cut.op = op;
+    new_cut.value = value;
+    new_cut.counters.expression = variable_name + " " + expression_.substr(op_position, op_length) + " " + value_text;
+    _cuts_.push_back(new_cut);
+    return;
+  }
+
+  bool event_selection::has_cuts() const
+  {
+    return !_cuts_.empty();
+  }
+
+  bool event_selection::select(const snfee::data::raw_event_data & red_)
+  {
+    for (cut_type & cut : _cuts_)
+      {
+        cut.counters.tested++;
+        if (!_pass_(cut, red_))
+          {
+            _rejected_++;
+            return false;
+          }
+        cut.counters.passed++;
+      }
+    _selected_++;
+    return true;
+  }
+
+  std::vector<event_selection::cut_counters> event_selection::get_cut_counters() const
+  {
+    std::vector<cut_counters> counters;
+    counters.reserve(_cuts_.size());
+    for (const cut_type & cut : _cuts_) counters.push_back(cut.counters);
+    return counters;
+  }
+
+  std::size_t event_selection::get_selected() const
+  {
+    return _selected_;
+  }
+
+  std::size_t event_selection::get_rejected() const
+  {
+    return _rejected_;
+  }
+
+  bool event_selection::_compare_(const int64_t left_, const operator_type op_, const int64_t right_)
+  {
+    switch (op_)
+      {
+      case OP_EQUAL: return left_ == right_;
+      case OP_NOT_EQUAL: return left_ != right_;
+      case OP_LESS: return left_ < right_;
+      case OP_LESS_EQUAL: return left_ <= right_;
+      case OP_GREATER: return left_ > right_;
+      case OP_GREATER_EQUAL: return left_ >= right_;
+      }
+    return false;
+  }
+
+  bool event_selection::_pass_(const cut_type & cut_, const snfee::data::raw_event_data & red_)
+  {
+    int64_t value = 0;
+    switch (cut_.variable)
+      {
+      case VAR_RUN_ID:
+        value = red_.get_run_id();
+        break;
+
+      case VAR_EVENT_ID:
+        value = red_.get_event_id();
+        break;
+
+      case VAR_CALO_HITS:
+        value = red_.get_calo_hits().size();
+        break;
+
+      case VAR_HIGH_THRESHOLD_CALO_HITS:
+        for (const auto & calo_hit : red_.get_calo_hits())
+          if (calo_hit.is_high_threshold()) value++;
+        break;
+
+      case VAR_LOW_THRESHOLD_ONLY_CALO_HITS:
+        for (const auto & calo_hit : red_.get_calo_hits())
+          if (calo_hit.is_low_threshold_only()) value++;
+        break;
+
+      case VAR_TRACKER_HITS:
+        value = red_.get_tracker_hits().size();
+        break;
+
+      case VAR_GG_TIMES:
+        for (const auto & tracker_hit : red_.get_tracker_hits())
+          value += tracker_hit.get_times().size();
+        break;
+
+      case VAR_TRIGGER_IDS:
+        value = red_.get_origin_trigger_ids().size();
+        break;
+
+      case VAR_TRIGGER_ID:
+        for (const int32_t trigger_id : red_.get_origin_trigger_ids())
+          if (_compare_(trigger_id, cut_.op, cut_.value)) return true;
+        return false;
+      }
+    return _compare_(value, cut_.op, cut_.value);
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,118 @@
+/// \file snredbridge/event_selection.h
+/// Selection of RED events with simple cuts, evaluated before the conversion
+
+#ifndef SNREDBRIDGE_EVENT_SELECTION_H
+#define SNREDBRIDGE_EVENT_SELECTION_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Third party:
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+namespace snredbridge {
+
+  /// \brief Selection of RED events
+  ///
+  /// A selection is a list of cuts, all of them must pass for an event to be
+  /// selected. Each cut compares a variable of the RED event with an integer:
+  /// \code
+  /// high_threshold_calo_hits >= 1
+  /// tracker_hits > 5
+  /// trigger_id == 1234
+  /// \endcode
+  ///
+  /// Variables:
+  /// - run_id, event_id
+  /// - calo_hits, high_threshold_calo_hits, low_threshold_only_calo_hits
+  /// - tracker_hits, gg_times (GG times of all tracker hits)
+  /// - trigger_ids (number of origin trigger IDs)
+  /// - trigger_id (passes if any of the origin trigger IDs passes)
+  ///
+  /// Operators: ==, !=, <, <=, >, >=
+  ///
+  /// Cuts are evaluated in order and the evaluation stops at the first failed
+  /// cut, so that the counters of a cut give the events it rejected among the
+  /// events which passed the previous cuts.
+  class event_selection
+  {
+  public:
+
+    /// Counters of a cut
+    struct cut_counters
+    {
+      std::string expression;  ///< Cut as given to add_cut()
+      std::size_t tested = 0;  ///< Events which passed the previous cuts
+      std::size_t passed = 0;  ///< Events which also passed this cut
+    };
+
+    /// Add a cut, throws if the expression is not valid
+    void add_cut(const std::string & expression_);
+
+    /// Check if the selection has any cut
+    bool has_cuts() const;
+
+    /// Check if an event passes all the cuts and update the counters
+    bool select(const snfee::data::raw_event_data & red_);
+
+    /// Counters of each cut
+    std::vector<cut_counters> get_cut_counters() const;
+
+    /// Number of selected events
+    std::size_t get_selected() const;
+
+    /// Number of rejected events
+    std::size_t get_rejected() const;
+
+    /// Names of the variables of the cuts
+    static const std::vector<std::string> & get_variable_names();
+
+  private:
+
+    enum variable_type
+      {
+        VAR_RUN_ID,
+        VAR_EVENT_ID,
+        VAR_CALO_HITS,
+        VAR_HIGH_THRESHOLD_CALO_HITS,
+        VAR_LOW_THRESHOLD_ONLY_CALO_HITS,
+        VAR_TRACKER_HITS,
+        VAR_GG_TIMES,
+        VAR_TRIGGER_IDS,
+        VAR_TRIGGER_ID
+      };
+
+    enum operator_type
+      {
+        OP_EQUAL,
+        OP_NOT_EQUAL,
+        OP_LESS,
+        OP_LESS_EQUAL,
+        OP_GREATER,
+        OP_GREATER_EQUAL
+      };
+
+    struct cut_type
+    {
+      variable_type variable;
+      operator_type op;
+      int64_t value;
+      cut_counters counters;
+    };
+
+    static bool _compare_(const int64_t left_, const operator_type op_, const int64_t right_);
+
+    static bool _pass_(const cut_type & cut_, const snfee::data::raw_event_data & red_);
+
+    std::vector<cut_type> _cuts_;
+    std::size_t _selected_ = 0;
+    std::size_t _rejected_ = 0;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_EVENT_SELECTION_H
@@ -0,0 +1,527 @@
+/// \file snredbridge/field_mapping.h
+/// Compile time tables of the fields copied from the RED hits into the UDD
+/// hits, shared by the conversion, the comparison and the fingerprint
+
+#ifndef SNREDBRIDGE_FIELD_MAPPING_H
+#define SNREDBRIDGE_FIELD_MAPPING_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+// Third party:
+// - Falaise:
+#include <falaise/snemo/datamodels/calorimeter_digitized_hit.h>
+#include <falaise/snemo/datamodels/tracker_digitized_hit.h>
+
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+namespace snredbridge {
+
+  /// \brief Mapping of the RED fields onto the UDD fields
+  ///
+  /// Each field of a hit is described by a type with static functions:
+  /// \code
+  /// struct field
+  /// {
+  ///   static constexpr const char * name();
+  ///   static void copy(const Red &, Udd &);         // conversion
+  ///   static bool equal(const Red &, const Udd &);  // comparison
+  ///   static std::string red_text(const Red &);     // mismatch report
+  ///   static std::string udd_text(const Udd &);
+  ///   template <class Hasher>
+  ///   static void hash(Hasher &, const Red &);      // fingerprint (Hasher::add(uint64_t))
+  ///   template <class Hasher>
+  ///   static void hash(Hasher &, const Udd &);      // same words as the RED value it was copied from
+  /// };
+  /// \endcode
+  /// A field_list of such types is a table: its functions apply all the
+  /// fields in order and are expanded at compile time, without any loop or
+  /// indirect call. A new field is added to a table once, and the conversion,
+  /// the comparison, the mismatch counters and the fingerprint all follow.
+  ///
+  /// The waveform of the calo hits, whose storage depends on the waveform
+  /// mode, and the GG times of the tracker hits, a collection, are not in the
+  /// tables.
+  namespace mapping {
+
+    /// Table of fields
+    template <class... Fields>
+    struct field_list
+    {
+      static constexpr std::size_t size = sizeof...(Fields);
+
+      /// Names of the fields, in order
+      static const char * const * names()
+      {
+        static const char * const the_names[] = {Fields::name()..., nullptr};
+        return the_names;
+      }
+
+      /// Copy all the fields
+      template <class Red, class Udd>
+      static void copy(const Red & red_, Udd & udd_)
+      {
+        const int expand[] = {0, (Fields::copy(red_, udd_), 0)...};
+        (void) expand;
+      }
+
+      /// Check that all the fields are equal, stops at the first different one
+      template <class Red, class Udd>
+      static bool equal(const Red & red_, const Udd & udd_)
+      {
+        bool is_equal = true;
+        const int expand[] = {0, (is_equal = is_equal && Fields::equal(red_, udd_), 0)...};
+        (void) expand;
+        return is_equal;
+      }
+
+      /// Position of the first different field, size if all the fields are equal
+      template <class Red, class Udd>
+      static std::size_t first_mismatch(const Red & red_, const Udd & udd_)
+      {
+        std::size_t position = 0;
+        bool is_equal = true;
+        const int expand[] = {0, (is_equal = is_equal && Fields::equal(red_, udd_), position += is_equal, 0)...};
+        (void) expand;
+        return position;
+      }
+
+      /// Compare all the fields and increment the counter of each different
+      /// field, returns the number of different fields
+      template <class Red, class Udd>
+      static std::size_t count_mismatches(const Red & red_, const Udd & udd_, std::size_t * counters_)
+      {
+        std::size_t mismatches = 0;
+        std::size_t position = 0;
+        const int expand[] = {0, (Fields::equal(red_, udd_) ? 0 : (counters_[position]++, mismatches++), position++, 0)...};
+        (void) expand;
+        return mismatches;
+      }
+
+      /// Call callback_(name, RED value, UDD value) for each different field
+      template <class Red, class Udd, class Callback>
+      static void describe_mismatches(const Red & red_, const Udd & udd_, Callback && callback_)
+      {
+        const int expand[] = {0, (Fields::equal(red_, udd_) ? 0 : (callback_(Fields::name(), Fields::red_text(red_), Fields::udd_text(udd_)), 0))...};
+        (void) expand;
+      }
+
+      /// Hash all the fields of a RED or a UDD hit
+      template <class Hasher, class Hit>
+      static void hash(Hasher & hasher_, const Hit & hit_)
+      {
+        const int expand[] = {0, (Fields::hash(hasher_, hit_), 0)...};
+        (void) expand;
+      }
+    };
+
+    template <class... Fields>
+    constexpr std::size_t field_list<Fields...>::size;
+
+    typedef snfee::data::calo_digitized_hit red_calo_hit;
+    typedef snemo::datamodel::calorimeter_digitized_hit udd_calo_hit;
+    typedef snfee::data::tracker_digitized_hit red_tracker_hit;
+    typedef snemo::datamodel::tracker_digitized_hit udd_tracker_hit;
+    typedef snfee::data::tracker_digitized_hit::gg_times red_gg_times;
+    typedef snemo::datamodel::tracker_digitized_hit::gg_times udd_gg_times;
+
+    /// Geometry ID type as converted: fix of the wrong calo geometry ID types
+    /// (former bug in SNFEE's src/snfee/data/sncabling_bridge.cc)
+    inline uint32_t converted_geom_type(const uint32_t type_)
+    {
+      switch (type_)
+        {
+        case 1301: return 1302;
+        case 1231: return 1232;
+        case 1251: return 1252;
+        default: return type_;
+        }
+    }
+
+    /// Check that a UDD geometry ID is the RED one with the expected type
+    inline bool same_geom_id(const geomtools::geom_id & red_,
+                             const geomtools::geom_id & udd_,
+                             const uint32_t type_)
+    {
+      if (udd_.get_type() != type_ || udd_.get_depth() != red_.get_depth()) return false;
+      for (uint32_t idepth = 0; idepth < red_.get_depth(); idepth++)
+        if (udd_.get(idepth) != red_.get(idepth)) return false;
+      return true;
+    }
+
+    /// Geometry ID printed with a given type
+    inline std::string geom_id_text(const geomtools::geom_id & geom_id_, const uint32_t type_)
+    {
+      geomtools::geom_id the_geom_id = geom_id_;
+      the_geom_id.set_type(type_);
+      std::ostringstream text;
+      text << the_geom_id;
+      return text.str();
+    }
+
+    template <class Hasher>
+    void hash_geom_id(Hasher & hasher_, const geomtools::geom_id & geom_id_, const uint32_t type_)
+    {
+      hasher_.add(type_);
+      hasher_.add(geom_id_.get_depth());
+      for (uint32_t idepth = 0; idepth < geom_id_.get_depth(); idepth++)
+        hasher_.add(geom_id_.get(idepth));
+    }
+
+    template <class RedOrigin, class UddOrigin>
+    bool same_origin(const RedOrigin & red_, const UddOrigin & udd_)
+    {
+      return udd_.get_hit_number() == red_.get_hit_number()
+        && udd_.get_trigger_id() == red_.get_trigger_id();
+    }
+
+    /// Origin as "hit number/trigger ID"
+    template <class Origin>
+    std::string origin_text(const Origin & origin_)
+    {
+      return std::to_string(origin_.get_hit_number()) + "/" + std::to_string(origin_.get_trigger_id());
+    }
+
+    template <class Hasher, class Origin>
+    void hash_origin(Hasher & hasher_, const Origin & origin_)
+    {
+      hasher_.add(static_cast<uint64_t>(int64_t(origin_.get_hit_number())));
+      hasher_.add(static_cast<uint64_t>(int64_t(origin_.get_trigger_id())));
+    }
+
+    /// Field whose RED value is copied as is by a UDD setter. The values are
+    /// integers (or flags), hashed as 64 bits words.
+#define SNREDBRIDGE_SCALAR_FIELD(NAME, LABEL, RED, UDD, RED_VALUE, UDD_VALUE, UDD_SETTER) \
+    struct NAME                                                         \
+    {                                                                   \
+      static constexpr const char * name() { return LABEL; }            \
+      static void copy(const RED & red_, UDD & udd_) { udd_.UDD_SETTER(red_.RED_VALUE); } \
+      static bool equal(const RED & red_, const UDD & udd_) { return udd_.UDD_VALUE == red_.RED_VALUE; } \
+      static std::string red_text(const RED & red_) { return std::to_string(static_cast<long long>(red_.RED_VALUE)); } \
+      static std::string udd_text(const UDD & udd_) { return std::to_string(static_cast<long long>(udd_.UDD_VALUE)); } \
+      template <class Hasher>                                           \
+      static void hash(Hasher & hasher_, const RED & red_) { hasher_.add(static_cast<uint64_t>(int64_t(red_.RED_VALUE))); } \
+      template <class Hasher>                                           \
+      static void hash(Hasher & hasher_, const UDD & udd_) { hasher_.add(static_cast<uint64_t>(int64_t(udd_.UDD_VALUE))); } \
+    }
+
+    // Calorimeter hit
+
+    struct calo_geom_id
+    {
+      static constexpr const char * name() { return "geom_id"; }
+      static void copy(const red_calo_hit & red_, udd_calo_hit & udd_)
+      {
+        udd_.set_geom_id(red_.get_geom_id());
+        const uint32_t type = converted_geom_type(red_.get_geom_id().get_type());
+        if (type != red_.get_geom_id().get_type()) udd_.grab_geom_id().set_type(type);
+      }
+      static bool equal(const red_calo_hit & red_, const udd_calo_hit & udd_)
+      {
+        return same_geom_id(red_.get_geom_id(), udd_.get_geom_id(), converted_geom_type(red_.get_geom_id().get_type()));
+      }
+      static std::string red_text(const red_calo_hit & red_)
+      {
+        return geom_id_text(red_.get_geom_id(), converted_geom_type(red_.get_geom_id().get_type()));
+      }
+      static std::string udd_text(const udd_calo_hit & udd_)
+      {
+        return geom_id_text(udd_.get_geom_id(), udd_.get_geom_id().get_type());
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const red_calo_hit & red_)
+      {
+        hash_geom_id(hasher_, red_.get_geom_id(), converted_geom_type(red_.get_geom_id().get_type()));
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const udd_calo_hit & udd_)
+      {
+        hash_geom_id(hasher_, udd_.get_geom_id(), udd_.get_geom_id().get_type());
+      }
+    };
+
+    SNREDBRIDGE_SCALAR_FIELD(calo_hit_id, "hit_id", red_calo_hit, udd_calo_hit,
+                             get_hit_id(), get_hit_id(), set_hit_id);
+    SNREDBRIDGE_SCALAR_FIELD(calo_timestamp, "timestamp", red_calo_hit, udd_calo_hit,
+                             get_reference_time().get_ticks(), get_timestamp(), set_timestamp);
+    SNREDBRIDGE_SCALAR_FIELD(calo_low_threshold_only, "low_threshold_only", red_calo_hit, udd_calo_hit,
+                             is_low_threshold_only(), is_low_threshold_only(), set_low_threshold_only);
+    SNREDBRIDGE_SCALAR_FIELD(calo_high_threshold, "high_threshold", red_calo_hit, udd_calo_hit,
+                             is_high_threshold(), is_high_threshold(), set_high_threshold);
+    SNREDBRIDGE_SCALAR_FIELD(calo_fcr, "fcr", red_calo_hit, udd_calo_hit,
+                             get_fcr(), get_fcr(), set_fcr);
+    SNREDBRIDGE_SCALAR_FIELD(calo_lt_trigger_counter, "lt_trigger_counter", red_calo_hit, udd_calo_hit,
+                             get_lt_trigger_counter(), get_lt_trigger_counter(), set_lt_trigger_counter);
+    SNREDBRIDGE_SCALAR_FIELD(calo_lt_time_counter, "lt_time_counter", red_calo_hit, udd_calo_hit,
+                             get_lt_time_counter(), get_lt_time_counter(), set_lt_time_counter);
+    SNREDBRIDGE_SCALAR_FIELD(calo_fwmeas_baseline, "fwmeas_baseline", red_calo_hit, udd_calo_hit,
+                             get_fwmeas_baseline(), get_fwmeas_baseline(), set_fwmeas_baseline);
+    SNREDBRIDGE_SCALAR_FIELD(calo_fwmeas_peak_amplitude, "fwmeas_peak_amplitude", red_calo_hit, udd_calo_hit,
+                             get_fwmeas_peak_amplitude(), get_fwmeas_peak_amplitude(), set_fwmeas_peak_amplitude);
+    SNREDBRIDGE_SCALAR_FIELD(calo_fwmeas_peak_cell, "fwmeas_peak_cell", red_calo_hit, udd_calo_hit,
+                             get_fwmeas_peak_cell(), get_fwmeas_peak_cell(), set_fwmeas_peak_cell);
+    SNREDBRIDGE_SCALAR_FIELD(calo_fwmeas_charge, "fwmeas_charge", red_calo_hit, udd_calo_hit,
+                             get_fwmeas_charge(), get_fwmeas_charge(), set_fwmeas_charge);
+    SNREDBRIDGE_SCALAR_FIELD(calo_fwmeas_rising_cell, "fwmeas_rising_cell", red_calo_hit, udd_calo_hit,
+                             get_fwmeas_rising_cell(), get_fwmeas_rising_cell(), set_fwmeas_rising_cell);
+    SNREDBRIDGE_SCALAR_FIELD(calo_fwmeas_falling_cell, "fwmeas_falling_cell", red_calo_hit, udd_calo_hit,
+                             get_fwmeas_falling_cell(), get_fwmeas_falling_cell(), set_fwmeas_falling_cell);
+
+    struct calo_origin
+    {
+      static constexpr const char * name() { return "origin"; }
+      static void copy(const red_calo_hit & red_, udd_calo_hit & udd_)
+      {
+        udd_.set_origin(udd_calo_hit::rtd_origin(red_.get_origin().get_hit_number(),
+                                                 red_.get_origin().get_trigger_id()));
+      }
+      static bool equal(const red_calo_hit & red_, const udd_calo_hit & udd_)
+      {
+        return same_origin(red_.get_origin(), udd_.get_origin());
+      }
+      static std::string red_text(const red_calo_hit & red_)
+      {
+        return origin_text(red_.get_origin());
+      }
+      static std::string udd_text(const udd_calo_hit & udd_)
+      {
+        return origin_text(udd_.get_origin());
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const red_calo_hit & red_)
+      {
+        hash_origin(hasher_, red_.get_origin());
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const udd_calo_hit & udd_)
+      {
+        hash_origin(hasher_, udd_.get_origin());
+      }
+    };
+
+    /// Fields of the calorimeter hits, cheap comparisons first
+    typedef field_list<calo_geom_id,
+                       calo_hit_id,
+                       calo_timestamp,
+                       calo_low_threshold_only,
+                       calo_high_threshold,
+                       calo_fcr,
+                       calo_lt_trigger_counter,
+                       calo_lt_time_counter,
+                       calo_fwmeas_baseline,
+                       calo_fwmeas_peak_amplitude,
+                       calo_fwmeas_peak_cell,
+                       calo_fwmeas_charge,
+                       calo_fwmeas_rising_cell,
+                       calo_fwmeas_falling_cell,
+                       calo_origin> calo_hit_fields;
+
+    // Tracker hit
+
+    struct tracker_geom_id
+    {
+      static constexpr const char * name() { return "geom_id"; }
+      static void copy(const red_tracker_hit & red_, udd_tracker_hit & udd_)
+      {
+        udd_.set_geom_id(red_.get_geom_id());
+      }
+      static bool equal(const red_tracker_hit & red_, const udd_tracker_hit & udd_)
+      {
+        return udd_.get_geom_id() == red_.get_geom_id();
+      }
+      static std::string red_text(const red_tracker_hit & red_)
+      {
+        return geom_id_text(red_.get_geom_id(), red_.get_geom_id().get_type());
+      }
+      static std::string udd_text(const udd_tracker_hit & udd_)
+      {
+        return geom_id_text(udd_.get_geom_id(), udd_.get_geom_id().get_type());
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const red_tracker_hit & red_)
+      {
+        hash_geom_id(hasher_, red_.get_geom_id(), red_.get_geom_id().get_type());
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const udd_tracker_hit & udd_)
+      {
+        hash_geom_id(hasher_, udd_.get_geom_id(), udd_.get_geom_id().get_type());
+      }
+    };
+
+    SNREDBRIDGE_SCALAR_FIELD(tracker_hit_id, "hit_id", red_tracker_hit, udd_tracker_hit,
+                             get_hit_id(), get_hit_id(), set_hit_id);
+
+    /// Fields of the tracker hits, without their GG times
+    typedef field_list<tracker_geom_id,
+                       tracker_hit_id> tracker_hit_fields;
+
+    // GG times of a tracker hit
+
+    constexpr const char * anode_origin_name(const std::size_t anode_)
+    {
+      return anode_ == 0 ? "anode_r0_origin" : anode_ == 1 ? "anode_r1_origin" : anode_ == 2 ? "anode_r2_origin"
+        : anode_ == 3 ? "anode_r3_origin" : "anode_r4_origin";
+    }
+
+    constexpr const char * anode_time_name(const std::size_t anode_)
+    {
+      return anode_ == 0 ? "anode_r0_time" : anode_ == 1 ? "anode_r1_time" : anode_ == 2 ? "anode_r2_time"
+        : anode_ == 3 ? "anode_r3_time" : "anode_r4_time";
+    }
+
+    template <std::size_t Anode>
+    struct gg_anode_origin
+    {
+      static constexpr const char * name() { return anode_origin_name(Anode); }
+      static void copy(const red_gg_times & red_, udd_gg_times & udd_)
+      {
+        udd_.set_anode_origin(Anode, udd_tracker_hit::rtd_origin(red_.get_anode_origin(Anode).get_hit_number(),
+                                                                 red_.get_anode_origin(Anode).get_trigger_id()));
+      }
+      static bool equal(const red_gg_times & red_, const udd_gg_times & udd_)
+      {
+        return same_origin(red_.get_anode_origin(Anode), udd_.get_anode_origin(Anode));
+      }
+      static std::string red_text(const red_gg_times & red_)
+      {
+        return origin_text(red_.get_anode_origin(Anode));
+      }
+      static std::string udd_text(const udd_gg_times & udd_)
+      {
+        return origin_text(udd_.get_anode_origin(Anode));
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const red_gg_times & red_)
+      {
+        hash_origin(hasher_, red_.get_anode_origin(Anode));
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const udd_gg_times & udd_)
+      {
+        hash_origin(hasher_, udd_.get_anode_origin(Anode));
+      }
+    };
+
+    template <std::size_t Anode>
+    struct gg_anode_time
+    {
+      static constexpr const char * name() { return anode_time_name(Anode); }
+      static void copy(const red_gg_times & red_, udd_gg_times & udd_)
+      {
+        udd_.set_anode_time(Anode, red_.get_anode_time(Anode).get_ticks());
+      }
+      static bool equal(const red_gg_times & red_, const udd_gg_times & udd_)
+      {
+        return udd_.get_anode_time(Anode) == red_.get_anode_time(Anode).get_ticks();
+      }
+      static std::string red_text(const red_gg_times & red_)
+      {
+        return std::to_string(static_cast<long long>(red_.get_anode_time(Anode).get_ticks()));
+      }
+      static std::string udd_text(const udd_gg_times & udd_)
+      {
+        return std::to_string(static_cast<long long>(udd_.get_anode_time(Anode)));
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const red_gg_times & red_)
+      {
+        hasher_.add(static_cast<uint64_t>(int64_t(red_.get_anode_time(Anode).get_ticks())));
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const udd_gg_times & udd_)
+      {
+        hasher_.add(static_cast<uint64_t>(int64_t(udd_.get_anode_time(Anode))));
+      }
+    };
+
+    struct gg_bottom_cathode_origin
+    {
+      static constexpr const char * name() { return "bottom_cathode_origin"; }
+      static void copy(const red_gg_times & red_, udd_gg_times & udd_)
+      {
+        udd_.set_bottom_cathode_origin(udd_tracker_hit::rtd_origin(red_.get_bottom_cathode_origin().get_hit_number(),
+                                                                   red_.get_bottom_cathode_origin().get_trigger_id()));
+      }
+      static bool equal(const red_gg_times & red_, const udd_gg_times & udd_)
+      {
+        return same_origin(red_.get_bottom_cathode_origin(), udd_.get_bottom_cathode_origin());
+      }
+      static std::string red_text(const red_gg_times & red_)
+      {
+        return origin_text(red_.get_bottom_cathode_origin());
+      }
+      static std::string udd_text(const udd_gg_times & udd_)
+      {
+        return origin_text(udd_.get_bottom_cathode_origin());
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const red_gg_times & red_)
+      {
+        hash_origin(hasher_, red_.get_bottom_cathode_origin());
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const udd_gg_times & udd_)
+      {
+        hash_origin(hasher_, udd_.get_bottom_cathode_origin());
+      }
+    };
+
+    SNREDBRIDGE_SCALAR_FIELD(gg_bottom_cathode_time, "bottom_cathode_time", red_gg_times, udd_gg_times,
+                             get_bottom_cathode_time().get_ticks(), get_bottom_cathode_time(), set_bottom_cathode_time);
+
+    struct gg_top_cathode_origin
+    {
+      static constexpr const char * name() { return "top_cathode_origin"; }
+      static void copy(const red_gg_times & red_, udd_gg_times & udd_)
+      {
+        udd_.set_top_cathode_origin(udd_tracker_hit::rtd_origin(red_.get_top_cathode_origin().get_hit_number(),
+                                                                red_.get_top_cathode_origin().get_trigger_id()));
+      }
+      static bool equal(const red_gg_times & red_, const udd_gg_times & udd_)
+      {
+        return same_origin(red_.get_top_cathode_origin(), udd_.get_top_cathode_origin());
+      }
+      static std::string red_text(const red_gg_times & red_)
+      {
+        return origin_text(red_.get_top_cathode_origin());
+      }
+      static std::string udd_text(const udd_gg_times & udd_)
+      {
+        return origin_text(udd_.get_top_cathode_origin());
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const red_gg_times & red_)
+      {
+        hash_origin(hasher_, red_.get_top_cathode_origin());
+      }
+      template <class Hasher>
+      static void hash(Hasher & hasher_, const udd_gg_times & udd_)
+      {
+        hash_origin(hasher_, udd_.get_top_cathode_origin());
+      }
+    };
+
+    SNREDBRIDGE_SCALAR_FIELD(gg_top_cathode_time, "top_cathode_time", red_gg_times, udd_gg_times,
+                             get_top_cathode_time().get_ticks(), get_top_cathode_time(), set_top_cathode_time);
+
+#undef SNREDBRIDGE_SCALAR_FIELD
+
+    /// Fields of the GG times, anodes R0 to R4 then cathodes
+    typedef field_list<gg_anode_origin<0>, gg_anode_time<0>,
+                       gg_anode_origin<1>, gg_anode_time<1>,
+                       gg_anode_origin<2>, gg_anode_time<2>,
+                       gg_anode_origin<3>, gg_anode_time<3>,
+                       gg_anode_origin<4>, gg_anode_time<4>,
+                       gg_bottom_cathode_origin, gg_bottom_cathode_time,
+                       gg_top_cathode_origin, gg_top_cathode_time> gg_times_fields;
+
+  } // namespace mapping
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_FIELD_MAPPING_H
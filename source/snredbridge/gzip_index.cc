@@ -0,0 +1,285 @@
+// Ourselves:
+#include <snredbridge/gzip_index.h>
+
+// Standard library:
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+// - zlib:
+#include <zlib.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    /// Size of the deflate dictionary
+    const std::size_t WINDOW_SIZE = 32768;
+
+    /// Size of the compressed input buffer
+    const std::size_t INPUT_SIZE = 65536;
+
+    /// Window bits of inflateInit2 for raw deflate data and for gzip members
+    const int RAW_WINDOW_BITS = -15;
+    const int GZIP_WINDOW_BITS = 15 + 16;
+
+  } // namespace
+
+  struct gzip_inflater::stream_type
+  {
+    z_stream z;
+  };
+
+  gzip_inflater::gzip_inflater(const std::string & filename_,
+                               const gzip_checkpoint & from_)
+    : _stream_(new stream_type)
+    , _input_(INPUT_SIZE)
+  {
+    _file_ = std::fopen(filename_.c_str(), "rb");
+    DT_THROW_IF(_file_ == nullptr, std::runtime_error, "Cannot open gzip file '" << filename_ << "'!");
+    std::memset(&_stream_->z, 0, sizeof(z_stream));
+    _raw_ = !from_.member_start;
+    int status = inflateInit2(&_stream_->z, _raw_ ? RAW_WINDOW_BITS : GZIP_WINDOW_BITS);
+    if (status != Z_OK)
+      {
+        std::fclose(_file_);
+        DT_THROW(std::runtime_error, "Cannot initialize the gzip inflater (zlib error " << status << ")!");
+      }
+    _uncompressed_offset_ = from_.uncompressed_offset;
+    _last_checkpoint_offset_ = from_.uncompressed_offset;
+
+    const uint64_t start = from_.compressed_offset - (from_.bits > 0 ? 1 : 0);
+    DT_THROW_IF(fseeko(_file_, start, SEEK_SET) != 0, std::runtime_error,
+                "Cannot seek to offset " << start << " of gzip file '" << filename_ << "'!");
+    _input_end_offset_ = start;
+    if (from_.bits > 0)
+      {
+        const int byte = std::fgetc(_file_);
+        DT_THROW_IF(byte == EOF, std::runtime_error, "Unexpected end of gzip file '" << filename_ << "'!");
+        _input_end_offset_++;
+        inflatePrime(&_stream_->z, from_.bits, byte >> (8 - from_.bits));
+      }
+    if (_raw_ && !from_.window.empty())
+      inflateSetDictionary(&_stream_->z,
+                           reinterpret_cast<const Bytef *>(from_.window.data()),
+                           from_.window.size());
+  }
+
+  gzip_inflater::~gzip_inflater()
+  {
+    inflateEnd(&_stream_->z);
+    if (_file_ != nullptr) std::fclose(_file_);
+  }
+
+  void gzip_inflater::record_checkpoints(std::vector<gzip_checkpoint> & checkpoints_,
+                                         const uint64_t spacing_)
+  {
+    _checkpoints_ = &checkpoints_;
+    _spacing_ = spacing_;
+    _window_.assign(WINDOW_SIZE, 0);
+    _window_position_ = 0;
+    _window_size_ = 0;
+    return;
+  }
+
+  std::size_t gzip_inflater::read(char * data_, const std::size_t size_)
+  {
+    z_stream & z = _stream_->z;
+    std::size_t produced = 0;
+    while (produced < size_ && !_end_)
+      {
+        if (z.avail_in == 0 && !_fill_input_())
+          {
+            DT_THROW_IF(_raw_ || z.total_in > 0, std::runtime_error, "Truncated gzip file!");
+            _end_ = true;
+            break;
+          }
+        unsigned char * out = reinterpret_cast<unsigned char *>(data_) + produced;
+        z.next_out = out;
+        z.avail_out = size_ - produced;
+        const int status = inflate(&z, _checkpoints_ != nullptr ? Z_BLOCK : Z_NO_FLUSH);
+        DT_THROW_IF(status != Z_OK && status != Z_STREAM_END && status != Z_BUF_ERROR,
+                    std::runtime_error, "Corrupted gzip data (zlib error " << status << ")!");
+        const std::size_t length = z.next_out - out;
+        produced += length;
+        _uncompressed_offset_ += length;
+        if (_checkpoints_ != nullptr)
+          {
+            _update_window_(out, length);
+            // End of a deflate block which is not the last one of the member
+            if ((z.data_type & 128) && !(z.data_type & 64)
+                && _uncompressed_offset_ - _last_checkpoint_offset_ >= _spacing_)
+              _add_checkpoint_(false);
+          }
+        if (status == Z_STREAM_END && !_start_next_member_()) _end_ = true;
+      }
+    return produced;
+  }
+
+  uint64_t gzip_inflater::skip(const uint64_t size_)
+  {
+    std::vector<char> scratch(std::min<uint64_t>(size_, INPUT_SIZE));
+    uint64_t skipped = 0;
+    while (skipped < size_)
+      {
+        const std::size_t length = read(scratch.data(), std::min<uint64_t>(size_ - skipped, scratch.size()));
+        if (length == 0) break;
+        skipped += length;
+      }
+    return skipped;
+  }
+
+  uint64_t gzip_inflater::get_uncompressed_offset() const
+  {
+    return _uncompressed_offset_;
+  }
+
+  bool gzip_inflater::_fill_input_()
+  {
+    const std::size_t length = std::fread(_input_.data(), 1, _input_.size(), _file_);
+    DT_THROW_IF(length == 0 && std::ferror(_file_), std::runtime_error, "Cannot read the gzip file!");
+    _input_end_offset_ += length;
+    _stream_->z.next_in = _input_.data();
+    _stream_->z.avail_in = length;
+    return length > 0;
+  }
+
+  bool gzip_inflater::_start_next_member_()
+  {
+    z_stream & z = _stream_->z;
+    // Raw deflate data stop before the 8 bytes of the gzip trailer
+    if (_raw_)
+      {
+        std::size_t trailer = 8;
+        while (trailer > 0)
+          {
+            if (z.avail_in == 0 && !_fill_input_())
+              DT_THROW(std::runtime_error, "Truncated gzip file!");
+            const std::size_t length = std::min<std::size_t>(trailer, z.avail_in);
+            z.next_in += length;
+            z.avail_in -= length;
+            trailer -= length;
+          }
+      }
+    // Another member follows if the next bytes are a gzip magic number
+    if (z.avail_in == 0 && !_fill_input_()) return false;
+    if (z.next_in[0] != 0x1f) return false;
+    if (_raw_)
+      {
+        inflateReset2(&z, GZIP_WINDOW_BITS);
+        _raw_ = false;
+      }
+    else
+      inflateReset(&z);
+    z.total_in = 0;
+    if (_checkpoints_ != nullptr && _uncompressed_offset_ - _last_checkpoint_offset_ >= _spacing_)
+      _add_checkpoint_(true);
+    return true;
+  }
+
+  void gzip_inflater::_update_window_(const unsigned char * data_, const std::size_t size_)
+  {
+    const unsigned char * data = data_;
+    std::size_t size = size_;
+    if (size >= WINDOW_SIZE)
+      {
+        data += size - WINDOW_SIZE;
+        size = WINDOW_SIZE;
+      }
+    const std::size_t first_part = std::min(size, WINDOW_SIZE - _window_position_);
+    std::memcpy(&_window_[_window_position_], data, first_part);
+    std::memcpy(&_window_[0], data + first_part, size - first_part);
+    _window_position_ = (_window_position_ + size) % WINDOW_SIZE;
+    _window_size_ = std::min(WINDOW_SIZE, _window_size_ + size);
+    return;
+  }
+
+  void gzip_inflater::_add_checkpoint_(const bool member_start_)
+  {
+    z_stream & z = _stream_->z;
+    gzip_checkpoint checkpoint;
+    checkpoint.compressed_offset = _input_end_offset_ - z.avail_in;
+    checkpoint.uncompressed_offset = _uncompressed_offset_;
+    checkpoint.member_start = member_start_;
+    if (!member_start_)
+      {
+        checkpoint.bits = z.data_type & 7;
+        // Window in the order of the data
+        checkpoint.window.reserve(_window_size_);
+        const std::size_t start = (_window_position_ + WINDOW_SIZE - _window_size_) % WINDOW_SIZE;
+        for (std::size_t i = 0; i < _window_size_; i++)
+          checkpoint.window.push_back(static_cast<char>(_window_[(start + i) % WINDOW_SIZE]));
+      }
+    _checkpoints_->push_back(checkpoint);
+    _last_checkpoint_offset_ = _uncompressed_offset_;
+    return;
+  }
+
+
+  gzip_streambuf::gzip_streambuf(const std::string & filename_,
+                                 const gzip_checkpoint & from_)
+    : _filename_(filename_)
+    , _inflater_(new gzip_inflater(filename_, from_))
+    , _buffer_(INPUT_SIZE)
+    , _buffer_offset_(from_.uncompressed_offset)
+  {
+    setg(_buffer_.data(), _buffer_.data(), _buffer_.data());
+  }
+
+  gzip_inflater & gzip_streambuf::grab_inflater()
+  {
+    return *_inflater_;
+  }
+
+  void gzip_streambuf::splice(const uint64_t prefix_end_,
+                              const gzip_checkpoint & checkpoint_,
+                              const uint64_t target_)
+  {
+    DT_THROW_IF(checkpoint_.uncompressed_offset > target_, std::logic_error,
+                "Checkpoint after the splice target!");
+    DT_THROW_IF(tell() > prefix_end_, std::logic_error, "Splice before the current position!");
+    _splice_pending_ = true;
+    _prefix_end_ = prefix_end_;
+    _splice_checkpoint_ = checkpoint_;
+    _splice_target_ = target_;
+    return;
+  }
+
+  uint64_t gzip_streambuf::tell() const
+  {
+    return _buffer_offset_ + (gptr() - eback());
+  }
+
+  gzip_streambuf::int_type gzip_streambuf::underflow()
+  {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    _buffer_offset_ += egptr() - eback();
+
+    std::size_t size = _buffer_.size();
+    if (_splice_pending_)
+      {
+        if (_buffer_offset_ >= _prefix_end_)
+          {
+            // Restart the inflation near the target and skip up to it
+            _inflater_.reset(new gzip_inflater(_filename_, _splice_checkpoint_));
+            const uint64_t gap = _splice_target_ - _splice_checkpoint_.uncompressed_offset;
+            DT_THROW_IF(_inflater_->skip(gap) != gap, std::runtime_error,
+                        "Splice target beyond the end of gzip file '" << _filename_ << "'!");
+            _buffer_offset_ = _splice_target_;
+            _splice_pending_ = false;
+          }
+        else
+          size = std::min<uint64_t>(size, _prefix_end_ - _buffer_offset_);
+      }
+
+    const std::size_t length = _inflater_->read(_buffer_.data(), size);
+    setg(_buffer_.data(), _buffer_.data(), _buffer_.data() + length);
+    if (length == 0) return traits_type::eof();
+    return traits_type::to_int_type(*gptr());
+  }
+
+} // namespace snredbridge
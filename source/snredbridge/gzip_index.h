@@ -0,0 +1,140 @@
+/// \file snredbridge/gzip_index.h
+/// Random access into gzip files through inflate checkpoints
+
+#ifndef SNREDBRIDGE_GZIP_INDEX_H
+#define SNREDBRIDGE_GZIP_INDEX_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+namespace snredbridge {
+
+  /// \brief Point of a gzip file where the inflation can restart
+  ///
+  /// A checkpoint is either the start of a gzip member, or the boundary of a
+  /// deflate block inside a member. In the latter case, the inflater needs
+  /// the last 32 KiB of uncompressed data as dictionary and the bits of the
+  /// last compressed byte not consumed yet by the previous block.
+  struct gzip_checkpoint
+  {
+    uint64_t compressed_offset = 0;   ///< Offset of the first compressed byte to read
+    uint64_t uncompressed_offset = 0; ///< Offset of the first uncompressed byte produced
+    int bits = 0;                     ///< Bits of the byte before compressed_offset to use first
+    bool member_start = true;         ///< The checkpoint is the start of a gzip member
+    std::string window;               ///< Uncompressed data before the checkpoint (up to 32 KiB)
+  };
+
+  /// \brief Sequential inflation of a gzip file from a checkpoint
+  ///
+  /// Files made of several gzip members, as written by parallel_gzip_writer,
+  /// are inflated as a single stream. While reading, checkpoints can be
+  /// recorded at regular intervals of uncompressed data.
+  class gzip_inflater
+  {
+  public:
+
+    /// Open the file and start the inflation at a checkpoint
+    gzip_inflater(const std::string & filename_,
+                  const gzip_checkpoint & from_ = gzip_checkpoint());
+
+    ~gzip_inflater();
+
+    gzip_inflater(const gzip_inflater &) = delete;
+    gzip_inflater & operator=(const gzip_inflater &) = delete;
+
+    /// Record a checkpoint into checkpoints_ each time spacing_ bytes have
+    /// been inflated since the last one (must be set before the first read)
+    void record_checkpoints(std::vector<gzip_checkpoint> & checkpoints_,
+                            const uint64_t spacing_);
+
+    /// Inflate up to size_ bytes, returns the number of bytes, 0 at the end of the file
+    std::size_t read(char * data_, const std::size_t size_);
+
+    /// Skip bytes of uncompressed data, returns the number of skipped bytes
+    uint64_t skip(const uint64_t size_);
+
+    /// Offset of the next uncompressed byte
+    uint64_t get_uncompressed_offset() const;
+
+  private:
+
+    bool _fill_input_();
+
+    bool _start_next_member_();
+
+    void _update_window_(const unsigned char * data_, const std::size_t size_);
+
+    void _add_checkpoint_(const bool member_start_);
+
+    struct stream_type;
+
+    std::FILE * _file_ = nullptr;
+    std::unique_ptr<stream_type> _stream_;
+    std::vector<unsigned char> _input_;
+    uint64_t _input_end_offset_ = 0;     ///< File offset after the last byte in the input buffer
+    uint64_t _uncompressed_offset_ = 0;
+    bool _raw_ = false;                  ///< Raw deflate data, without gzip header and trailer
+    bool _end_ = false;
+
+    // Checkpoint recording
+    std::vector<gzip_checkpoint> * _checkpoints_ = nullptr;
+    uint64_t _spacing_ = 0;
+    uint64_t _last_checkpoint_offset_ = 0;
+    std::vector<unsigned char> _window_; ///< Circular buffer of the last 32 KiB
+    std::size_t _window_position_ = 0;
+    std::size_t _window_size_ = 0;
+  };
+
+  /// \brief Input stream buffer over a gzip file
+  ///
+  /// The buffer can serve the beginning of the file, up to a given offset,
+  /// then jump to another offset through a checkpoint: splice(). This lets a
+  /// stateful reader (as a Boost archive) read the header and first records
+  /// of a file, then the records from any place of the file.
+  class gzip_streambuf
+    : public std::streambuf
+  {
+  public:
+
+    /// Open the file at a checkpoint
+    gzip_streambuf(const std::string & filename_,
+                   const gzip_checkpoint & from_ = gzip_checkpoint());
+
+    /// Access to the inflater, for example to record checkpoints
+    gzip_inflater & grab_inflater();
+
+    /// Serve the data up to prefix_end_, then the data from target_ on,
+    /// inflated from checkpoint_ which must come before target_
+    void splice(const uint64_t prefix_end_,
+                const gzip_checkpoint & checkpoint_,
+                const uint64_t target_);
+
+    /// Offset in the uncompressed file of the next byte served
+    uint64_t tell() const;
+
+  protected:
+
+    int_type underflow() override;
+
+  private:
+
+    std::string _filename_;
+    std::unique_ptr<gzip_inflater> _inflater_;
+    std::vector<char> _buffer_;
+    uint64_t _buffer_offset_ = 0; ///< Uncompressed offset of the first byte of the buffer
+
+    bool _splice_pending_ = false;
+    uint64_t _prefix_end_ = 0;
+    gzip_checkpoint _splice_checkpoint_;
+    uint64_t _splice_target_ = 0;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_GZIP_INDEX_H
@@ -0,0 +1,175 @@
+// Ourselves:
+#include <snredbridge/json_writer.h>
+
+// Standard library:
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+namespace snredbridge {
+
+  json_writer::json_writer(std::ostream & out_)
+    : _out_(out_)
+  {
+    return;
+  }
+
+  json_writer::~json_writer()
+  {
+    while (!_scopes_.empty())
+      {
+        if (_scopes_.back().is_array) end_array();
+        else end_object();
+      }
+    return;
+  }
+
+  std::string json_writer::quote(const std::string & text_)
+  {
+    std::string quoted;
+    quoted.reserve(text_.size() + 2);
+    quoted += '"';
+    for (const char c : text_)
+      {
+        switch (c)
+          {
+          case '"': quoted += "\\\""; break;
+          case '\\': quoted += "\\\\"; break;
+          case '\n': quoted += "\\n"; break;
+          case '\r': quoted += "\\r"; break;
+          case '\t': quoted += "\\t"; break;
+          default:
+            if (static_cast<unsigned char>(c) < 0x20)
+              {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+                quoted += escaped;
+              }
+            else quoted += c;
+          }
+      }
+    quoted += '"';
+    return quoted;
+  }
+
+  void json_writer::_next_(const std::string & key_)
+  {
+    if (!_scopes_.empty())
+      {
+        scope & current = _scopes_.back();
+        if (!current.is_empty) _out_ << ',';
+        _out_ << '\n' << std::string(2 * _scopes_.size(), ' ');
+        if (!current.is_array) _out_ << quote(key_) << ": ";
+        current.is_empty = false;
+      }
+    return;
+  }
+
+  json_writer & json_writer::begin_object(const std::string & key_)
+  {
+    _next_(key_);
+    _out_ << '{';
+    _scopes_.push_back(scope());
+    return *this;
+  }
+
+  json_writer & json_writer::end_object()
+  {
+    const bool is_empty = _scopes_.back().is_empty;
+    _scopes_.pop_back();
+    if (!is_empty) _out_ << '\n' << std::string(2 * _scopes_.size(), ' ');
+    _out_ << '}';
+    if (_scopes_.empty()) _out_ << '\n';
+    return *this;
+  }
+
+  json_writer & json_writer::begin_array(const std::string & key_)
+  {
+    _next_(key_);
+    _out_ << '[';
+    scope array_scope;
+    array_scope.is_array = true;
+    _scopes_.push_back(array_scope);
+    return *this;
+  }
+
+  json_writer & json_writer::end_array()
+  {
+    const bool is_empty = _scopes_.back().is_empty;
+    _scopes_.pop_back();
+    if (!is_empty) _out_ << '\n' << std::string(2 * _scopes_.size(), ' ');
+    _out_ << ']';
+    if (_scopes_.empty()) _out_ << '\n';
+    return *this;
+  }
+
+  json_writer & json_writer::value(const std::string & key_, const std::string & value_)
+  {
+    _next_(key_);
+    _out_ << quote(value_);
+    return *this;
+  }
+
+  json_writer & json_writer::value(const std::string & key_, const char * value_)
+  {
+    return value(key_, std::string(value_));
+  }
+
+  json_writer & json_writer::value(const std::string & key_, const bool value_)
+  {
+    _next_(key_);
+    _out_ << (value_ ? "true" : "false");
+    return *this;
+  }
+
+  json_writer & json_writer::value(const std::string & key_, const int value_)
+  {
+    return value(key_, static_cast<long long>(value_));
+  }
+
+  json_writer & json_writer::value(const std::string & key_, const long value_)
+  {
+    return value(key_, static_cast<long long>(value_));
+  }
+
+  json_writer & json_writer::value(const std::string & key_, const long long value_)
+  {
+    _next_(key_);
+    _out_ << value_;
+    return *this;
+  }
+
+  json_writer & json_writer::value(const std::string & key_, const unsigned int value_)
+  {
+    return value(key_, static_cast<unsigned long long>(value_));
+  }
+
+  json_writer & json_writer::value(const std::string & key_, const unsigned long value_)
+  {
+    return value(key_, static_cast<unsigned long long>(value_));
+  }
+
+  json_writer & json_writer::value(const std::string & key_, const unsigned long long value_)
+  {
+    _next_(key_);
+    _out_ << value_;
+    return *this;
+  }
+
+  json_writer & json_writer::value(const std::string & key_, const double value_)
+  {
+    _next_(key_);
+    // JSON has no representation for NaN and infinities
+    if (!std::isfinite(value_))
+      {
+        _out_ << "null";
+        return *this;
+      }
+    std::ostringstream formatted;
+    formatted << std::setprecision(10) << value_;
+    _out_ << formatted.str();
+    return *this;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,73 @@
+/// \file snredbridge/json_writer.h
+/// Minimal streaming JSON writer for the machine readable summaries
+
+#ifndef SNREDBRIDGE_JSON_WRITER_H
+#define SNREDBRIDGE_JSON_WRITER_H
+
+// Standard library:
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace snredbridge {
+
+  /// \brief Streaming JSON writer
+  ///
+  /// Values are written as they come, with keys inside objects and without
+  /// keys inside arrays:
+  /// \code
+  /// snredbridge::json_writer json(std::cout);
+  /// json.begin_object();
+  /// json.value("events", 1000);
+  /// json.begin_array("files");
+  /// json.value("", "run-815.data.gz");
+  /// json.end_array();
+  /// json.end_object();
+  /// \endcode
+  class json_writer
+  {
+  public:
+
+    /// Constructor
+    explicit json_writer(std::ostream & out_);
+
+    /// Destructor, closes all the open objects and arrays
+    ~json_writer();
+
+    json_writer & begin_object(const std::string & key_ = "");
+    json_writer & end_object();
+    json_writer & begin_array(const std::string & key_ = "");
+    json_writer & end_array();
+
+    json_writer & value(const std::string & key_, const std::string & value_);
+    json_writer & value(const std::string & key_, const char * value_);
+    json_writer & value(const std::string & key_, const bool value_);
+    json_writer & value(const std::string & key_, const int value_);
+    json_writer & value(const std::string & key_, const long value_);
+    json_writer & value(const std::string & key_, const long long value_);
+    json_writer & value(const std::string & key_, const unsigned int value_);
+    json_writer & value(const std::string & key_, const unsigned long value_);
+    json_writer & value(const std::string & key_, const unsigned long long value_);
+    json_writer & value(const std::string & key_, const double value_);
+
+    /// Escape a string as a JSON string literal, quotes included
+    static std::string quote(const std::string & text_);
+
+  private:
+
+    void _next_(const std::string & key_);
+
+    struct scope
+    {
+      bool is_array = false;
+      bool is_empty = true;
+    };
+
+    std::ostream & _out_;
+    std::vector<scope> _scopes_;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_JSON_WRITER_H
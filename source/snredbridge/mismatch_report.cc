@@ -0,0 +1,152 @@
+// Ourselves:
+#include <snredbridge/mismatch_report.h>
+
+// Standard library:
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snredbridge {
+
+  mismatch_report::mismatch_report(const config_type & config_)
+    : _config_(config_)
+  {
+    _file_.open(_config_.filename.c_str());
+    DT_THROW_IF(!_file_, std::runtime_error, "Cannot create mismatch report '" << _config_.filename << "'!");
+    _json_.reset(new json_writer(_file_));
+    _json_->begin_object();
+    _json_->value("max_events", static_cast<unsigned long long>(_config_.max_events));
+    _json_->begin_array("events");
+    _file_.flush();
+    return;
+  }
+
+  mismatch_report::~mismatch_report()
+  {
+    if (!_json_) return;
+    try {
+      _write_events_(std::numeric_limits<std::size_t>::max());
+    }
+    catch (...) {
+    }
+    // The json writer closes the open array and object
+    _json_.reset();
+    return;
+  }
+
+  bool mismatch_report::accepts(const std::size_t sequence_) const
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    const std::size_t free_places = _free_places_();
+    if (free_places == 0) return false;
+    return _events_.size() < free_places || sequence_ < _events_.rbegin()->first;
+  }
+
+  void mismatch_report::add(const event_key & key_,
+                            const std::size_t sequence_,
+                            std::vector<field_difference> differences_)
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    DT_THROW_IF(!_json_, std::logic_error, "Mismatch report is closed!");
+    const std::size_t free_places = _free_places_();
+    if (free_places == 0) return;
+    if (_events_.size() >= free_places)
+      {
+        // Another thread may have kept lower sequences meanwhile
+        if (sequence_ >= _events_.rbegin()->first) return;
+        _events_.erase(std::prev(_events_.end()));
+      }
+    reported_event & event = _events_[sequence_];
+    event.key = key_;
+    event.differences = std::move(differences_);
+    return;
+  }
+
+  void mismatch_report::mark_done(const std::size_t sequence_)
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    if (!_json_ || _free_places_() == 0) return;
+    if (sequence_ != _done_below_) _done_.insert(sequence_);
+    else
+      {
+        _done_below_++;
+        while (!_done_.empty() && *_done_.begin() == _done_below_)
+          {
+            _done_.erase(_done_.begin());
+            _done_below_++;
+          }
+        _write_events_(_done_below_);
+      }
+    if (_free_places_() == 0) _done_.clear();
+    return;
+  }
+
+  std::size_t mismatch_report::_free_places_() const
+  {
+    return _config_.max_events > _written_ ? _config_.max_events - _written_ : 0;
+  }
+
+  void mismatch_report::_write_events_(const std::size_t end_sequence_)
+  {
+    while (!_events_.empty() && _events_.begin()->first < end_sequence_)
+      {
+        const auto & entry = *_events_.begin();
+        _json_->begin_object();
+        _json_->value("sequence", static_cast<unsigned long long>(entry.first));
+        _json_->value("run_id", entry.second.key.run_id);
+        _json_->value("event_id", entry.second.key.event_id);
+        _json_->begin_array("differences");
+        for (const field_difference & difference : entry.second.differences)
+          {
+            _json_->begin_object();
+            _json_->value("field", difference.field);
+            if (!difference.hit.empty()) _json_->value("hit", difference.hit);
+            _json_->value("red", difference.red_value);
+            _json_->value("udd", difference.udd_value);
+            _json_->end_object();
+          }
+        _json_->end_array();
+        _json_->end_object();
+        _file_.flush();
+        _written_++;
+        _events_.erase(_events_.begin());
+      }
+    return;
+  }
+
+  void mismatch_report::close(const field_mismatch_counters & counters_,
+                              const std::size_t non_equal_events_)
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    if (!_json_) return;
+    _write_events_(std::numeric_limits<std::size_t>::max());
+    _json_->end_array();
+    _json_->value("non_equal_events", static_cast<unsigned long long>(non_equal_events_));
+    _json_->value("reported_events", static_cast<unsigned long long>(_written_));
+    _json_->begin_object("field_mismatches");
+    for (std::size_t ifield = 0; ifield < counters_.get_number_of_fields(); ifield++)
+      if (counters_.get_mismatches(ifield) != 0)
+        _json_->value(counters_.get_field_name(ifield), static_cast<unsigned long long>(counters_.get_mismatches(ifield)));
+    _json_->end_object();
+    _json_.reset();
+    _file_.close();
+    DT_THROW_IF(!_file_, std::runtime_error, "Cannot write mismatch report '" << _config_.filename << "'!");
+    return;
+  }
+
+  std::size_t mismatch_report::get_number_of_events() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    return _written_;
+  }
+
+  const mismatch_report::config_type & mismatch_report::get_config() const
+  {
+    return _config_;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,121 @@
+/// \file snredbridge/mismatch_report.h
+/// JSON report of the first events found different by the validation
+
+#ifndef SNREDBRIDGE_MISMATCH_REPORT_H
+#define SNREDBRIDGE_MISMATCH_REPORT_H
+
+// Standard library:
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// This project:
+#include <snredbridge/event_matcher.h>
+#include <snredbridge/json_writer.h>
+#include <snredbridge/red_udd_comparison.h>
+
+namespace snredbridge {
+
+  /// \brief Report of the non equivalent events of a validation
+  ///
+  /// The differences of the non equivalent events with the lowest sequence
+  /// numbers are written, then only the counters, so that the memory in use
+  /// does not depend on the number of bad events. An event is written, in
+  /// sequence order, as soon as all the lower sequences have been compared:
+  /// at once in serial mode, after the slower comparison threads otherwise.
+  /// The file is flushed after each event, so that a killed job leaves the
+  /// events found so far:
+  /// \code
+  /// {
+  ///   "max_events": 100,
+  ///   "events": [
+  ///     {
+  ///       "sequence": 12, "run_id": 815, "event_id": 1234,
+  ///       "differences": [
+  ///         {"field": "calo.fcr", "hit": "calo hit [1302:0.1.2.3] #7", "red": "10", "udd": "11"}
+  ///       ]
+  ///     }
+  ///   ],
+  ///   "non_equal_events": 1,
+  ///   "reported_events": 1,
+  ///   "field_mismatches": {"calo.fcr": 1}
+  /// }
+  /// \endcode
+  /// The sequence is the position of the event in the pairs of matched events:
+  /// the reported events do not depend on the number of comparison threads.
+  class mismatch_report
+  {
+  public:
+
+    struct config_type
+    {
+      std::string filename;         ///< JSON report file
+      std::size_t max_events = 100; ///< Number of events whose differences are written
+    };
+
+    /// Create the report file
+    explicit mismatch_report(const config_type & config_);
+
+    /// Close the report without counters if not done yet
+    ~mismatch_report();
+
+    mismatch_report(const mismatch_report &) = delete;
+    mismatch_report & operator=(const mismatch_report &) = delete;
+
+    /// Check if a non equivalent event would be reported, so that its
+    /// differences are only collected if needed (thread safe)
+    bool accepts(const std::size_t sequence_) const;
+
+    /// Keep the differences of a non equivalent event, if its sequence is
+    /// among the lowest ones (thread safe)
+    void add(const event_key & key_,
+             const std::size_t sequence_,
+             std::vector<field_difference> differences_);
+
+    /// Tell that the comparison of an event is done, after add() if it is non
+    /// equivalent. The kept events whose lower sequences are all done are
+    /// written (thread safe).
+    void mark_done(const std::size_t sequence_);
+
+    /// Write the kept events and the counters of all the events, and close
+    /// the report
+    void close(const field_mismatch_counters & counters_,
+               const std::size_t non_equal_events_);
+
+    /// Number of events written
+    std::size_t get_number_of_events() const;
+
+    const config_type & get_config() const;
+
+  private:
+
+    struct reported_event
+    {
+      event_key key;
+      std::vector<field_difference> differences;
+    };
+
+    /// Number of events which can still be written
+    std::size_t _free_places_() const;
+
+    /// Write the kept events below a sequence, in sequence order
+    void _write_events_(const std::size_t end_sequence_);
+
+    config_type _config_;
+    std::ofstream _file_;
+    std::unique_ptr<json_writer> _json_;
+    std::map<std::size_t, reported_event> _events_; ///< Kept events by sequence, not written yet
+    std::size_t _written_ = 0;
+    std::size_t _done_below_ = 0;    ///< All the sequences below are compared
+    std::set<std::size_t> _done_;    ///< Compared sequences above _done_below_
+    mutable std::mutex _mutex_;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_MISMATCH_REPORT_H
@@ -0,0 +1,103 @@
+// Ourselves:
+#include <snredbridge/named_pipe.h>
+
+// Standard library:
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+// System:
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snredbridge {
+
+  bool ends_with(const std::string & text_, const std::string & suffix_)
+  {
+    return text_.size() >= suffix_.size()
+      && text_.compare(text_.size() - suffix_.size(), suffix_.size(), suffix_) == 0;
+  }
+
+  temporary_pipes::~temporary_pipes()
+  {
+    remove();
+  }
+
+  std::string temporary_pipes::make_pipe(const std::string & name_, const std::string & description_)
+  {
+    if (_directory_.empty())
+      {
+        const char * tmpdir = std::getenv("TMPDIR");
+        std::string directory_template = std::string(tmpdir != nullptr ? tmpdir : "/tmp") + "/snredbridge-XXXXXX";
+        std::vector<char> directory(directory_template.begin(), directory_template.end());
+        directory.push_back('\0');
+        DT_THROW_IF(::mkdtemp(directory.data()) == nullptr, std::runtime_error,
+                    "Cannot create a temporary directory for the " << description_ << ": " << std::strerror(errno));
+        _directory_ = directory.data();
+      }
+    const std::string path = _directory_ + "/" + name_;
+    DT_THROW_IF(::mkfifo(path.c_str(), 0600) != 0, std::runtime_error,
+                "Cannot create the " << description_ << " '" << path << "': " << std::strerror(errno));
+    _pipes_.push_back(path);
+    return path;
+  }
+
+  void temporary_pipes::remove()
+  {
+    for (const std::string & pipe : _pipes_) ::unlink(pipe.c_str());
+    _pipes_.clear();
+    if (!_directory_.empty()) ::rmdir(_directory_.c_str());
+    _directory_.clear();
+    return;
+  }
+
+  bool write_all(const int fd_, const char * data_, std::size_t size_)
+  {
+    while (size_ > 0)
+      {
+        const ssize_t written = ::write(fd_, data_, size_);
+        if (written < 0)
+          {
+            if (errno == EINTR) continue;
+            return false;
+          }
+        data_ += written;
+        size_ -= written;
+      }
+    return true;
+  }
+
+  void block_sigpipe()
+  {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGPIPE);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    return;
+  }
+
+  int open_pipe_writer(const std::string & path_, const std::atomic<bool> & stop_)
+  {
+    // Without a reader, the non blocking open fails with ENXIO
+    int fd = -1;
+    while (!stop_)
+      {
+        fd = ::open(path_.c_str(), O_WRONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd >= 0 || errno != ENXIO) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+    if (fd >= 0) ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    return fd;
+  }
+
+} // namespace snredbridge
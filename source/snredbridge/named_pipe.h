@@ -0,0 +1,64 @@
+/// \file snredbridge/named_pipe.h
+/// Named pipes in a private temporary directory, and the helpers of the
+/// threads streaming bytes through them
+
+#ifndef SNREDBRIDGE_NAMED_PIPE_H
+#define SNREDBRIDGE_NAMED_PIPE_H
+
+// Standard library:
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace snredbridge {
+
+  /// Check if a file name ends with an extension
+  bool ends_with(const std::string & text_, const std::string & suffix_);
+
+  /// \brief Named pipes created in a private temporary directory
+  ///
+  /// The directory is created in $TMPDIR (/tmp by default) with the first
+  /// pipe. The pipes and the directory are removed by remove() or the
+  /// destructor.
+  class temporary_pipes
+  {
+  public:
+
+    temporary_pipes() = default;
+
+    /// Remove the pipes and the directory
+    ~temporary_pipes();
+
+    temporary_pipes(const temporary_pipes &) = delete;
+    temporary_pipes & operator=(const temporary_pipes &) = delete;
+
+    /// Create a named pipe in the directory and return its path. The
+    /// description names the pipe in the error messages.
+    std::string make_pipe(const std::string & name_, const std::string & description_);
+
+    /// Remove the pipes and the directory
+    void remove();
+
+  private:
+
+    std::string _directory_;
+    std::vector<std::string> _pipes_;
+  };
+
+  /// Write all the bytes, false if the reader is gone
+  bool write_all(const int fd_, const char * data_, std::size_t size_);
+
+  /// Block SIGPIPE in the calling thread: a write into a pipe whose reader
+  /// is gone fails with EPIPE instead of killing the program
+  void block_sigpipe();
+
+  /// Open the write end of a named pipe once its reader opened it. The open
+  /// does not block, so that the caller is released when stop_ is set before
+  /// the reader comes. Returns a blocking descriptor, or -1 if stopped or on
+  /// error.
+  int open_pipe_writer(const std::string & path_, const std::atomic<bool> & stop_);
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_NAMED_PIPE_H
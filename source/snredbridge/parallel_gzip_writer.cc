@@ -0,0 +1,185 @@
+// Ourselves:
+#include <snredbridge/parallel_gzip_writer.h>
+
+// Standard library:
+#include <algorithm>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+// - zlib:
+#include <zlib.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    /// Deflate a block into a complete gzip member
+    void deflate_block(const std::string & data_, const int level_, std::string & member_)
+    {
+      z_stream stream;
+      stream.zalloc = Z_NULL;
+      stream.zfree = Z_NULL;
+      stream.opaque = Z_NULL;
+      // 15 bits window, +16 for a gzip header and trailer
+      int status = deflateInit2(&stream, level_, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+      DT_THROW_IF(status != Z_OK, std::runtime_error, "Cannot initialize the gzip compressor (zlib error " << status << ")!");
+      member_.resize(deflateBound(&stream, data_.size()));
+      stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data_.data()));
+      stream.avail_in = data_.size();
+      stream.next_out = reinterpret_cast<Bytef *>(&member_[0]);
+      stream.avail_out = member_.size();
+      status = deflate(&stream, Z_FINISH);
+      const std::size_t member_size = stream.total_out;
+      deflateEnd(&stream);
+      DT_THROW_IF(status != Z_STREAM_END, std::runtime_error, "Cannot compress a block (zlib error " << status << ")!");
+      member_.resize(member_size);
+      return;
+    }
+
+  } // namespace
+
+  parallel_gzip_writer::parallel_gzip_writer(const std::string & filename_,
+                                             const int level_,
+                                             const unsigned int number_of_threads_,
+                                             const std::size_t block_size_)
+    : _file_(filename_, std::ios::binary | std::ios::trunc)
+    , _level_(level_)
+    , _block_size_(block_size_)
+  {
+    DT_THROW_IF(!_file_, std::runtime_error, "Cannot open output file '" << filename_ << "'!");
+    DT_THROW_IF(level_ != Z_DEFAULT_COMPRESSION && (level_ < 1 || level_ > 9),
+                std::domain_error, "Invalid gzip compression level " << level_ << "!");
+    DT_THROW_IF(block_size_ == 0, std::domain_error, "Invalid compression block size!");
+    _current_.reserve(_block_size_);
+    const unsigned int number_of_threads = number_of_threads_ > 0 ? number_of_threads_ : 1;
+    for (unsigned int ithread = 0; ithread < number_of_threads; ithread++)
+      _threads_.emplace_back(&parallel_gzip_writer::_compress_loop_, this);
+  }
+
+  parallel_gzip_writer::~parallel_gzip_writer()
+  {
+    try {
+      close();
+    }
+    catch (...) {
+    }
+  }
+
+  void parallel_gzip_writer::write(const char * data_, const std::size_t size_)
+  {
+    DT_THROW_IF(_closed_, std::logic_error, "Gzip writer is closed!");
+    std::size_t offset = 0;
+    while (offset < size_)
+      {
+        const std::size_t length = std::min(size_ - offset, _block_size_ - _current_.size());
+        _current_.append(data_ + offset, length);
+        offset += length;
+        if (_current_.size() == _block_size_) _submit_block_();
+      }
+    return;
+  }
+
+  void parallel_gzip_writer::close()
+  {
+    if (_closed_) return;
+    _closed_ = true;
+    // An empty stream is still written as one empty gzip member
+    std::exception_ptr submit_error;
+    try {
+      if (!_current_.empty() || _next_block_index_ == 0) _submit_block_();
+    }
+    catch (...) {
+      submit_error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      _closing_ = true;
+    }
+    _work_cv_.notify_all();
+    for (auto & compress_thread : _threads_) compress_thread.join();
+    _threads_.clear();
+    _file_.close();
+    if (submit_error) std::rethrow_exception(submit_error);
+    if (_error_) std::rethrow_exception(_error_);
+    DT_THROW_IF(!_file_, std::runtime_error, "Cannot close the gzip output file!");
+    return;
+  }
+
+  std::size_t parallel_gzip_writer::get_input_size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    return _input_size_;
+  }
+
+  std::size_t parallel_gzip_writer::get_output_size() const
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    return _output_size_;
+  }
+
+  void parallel_gzip_writer::_submit_block_()
+  {
+    std::unique_lock<std::mutex> lock(_mutex_);
+    _room_cv_.wait(lock, [this] {
+        return _error_ || _next_block_index_ - _next_written_index_ < 2 * _threads_.size();
+      });
+    if (_error_) std::rethrow_exception(_error_);
+    block_type new_block;
+    new_block.index = _next_block_index_++;
+    new_block.data.swap(_current_);
+    _input_size_ += new_block.data.size();
+    _pending_.push_back(std::move(new_block));
+    lock.unlock();
+    _work_cv_.notify_one();
+    _current_.reserve(_block_size_);
+    return;
+  }
+
+  void parallel_gzip_writer::_compress_loop_()
+  {
+    block_type work;
+    std::string member;
+    while (true)
+      {
+        {
+          std::unique_lock<std::mutex> lock(_mutex_);
+          _work_cv_.wait(lock, [this] { return _closing_ || !_pending_.empty(); });
+          if (_pending_.empty()) return;
+          work = std::move(_pending_.front());
+          _pending_.pop_front();
+        }
+
+        std::exception_ptr error;
+        try {
+          deflate_block(work.data, _level_, member);
+        }
+        catch (...) {
+          error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex_);
+        if (error && !_error_) _error_ = error;
+        _compressed_[work.index].swap(member);
+        // Write the members which are next in the stream order
+        for (auto next = _compressed_.find(_next_written_index_);
+             next != _compressed_.end();
+             next = _compressed_.find(_next_written_index_))
+          {
+            if (!_error_)
+              {
+                _file_.write(next->second.data(), next->second.size());
+                _output_size_ += next->second.size();
+                if (!_file_)
+                  _error_ = std::make_exception_ptr(std::runtime_error("Cannot write to the gzip output file!"));
+              }
+            _compressed_.erase(next);
+            _next_written_index_++;
+          }
+        _room_cv_.notify_all();
+      }
+  }
+
+} // namespace snredbridge
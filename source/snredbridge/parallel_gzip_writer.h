@@ -0,0 +1,98 @@
+/// \file snredbridge/parallel_gzip_writer.h
+/// Gzip file writer compressing independent blocks on several threads
+
+#ifndef SNREDBRIDGE_PARALLEL_GZIP_WRITER_H
+#define SNREDBRIDGE_PARALLEL_GZIP_WRITER_H
+
+// Standard library:
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace snredbridge {
+
+  /// \brief Gzip file writer with parallel block compression
+  ///
+  /// The byte stream is cut into blocks of fixed size. Each block is deflated
+  /// by one of the compression threads into a complete gzip member, and the
+  /// members are written to the file in the order of the stream. A sequence of
+  /// gzip members is a valid gzip file: it is read back by gunzip and by the
+  /// Boost gzip decompressor used by Bayeux as a single stream.
+  ///
+  /// The number of blocks waiting to be compressed or written is limited to
+  /// twice the number of threads, so that the memory in use stays bounded.
+  class parallel_gzip_writer
+  {
+  public:
+
+    /// Default size of the uncompressed blocks (4 MiB)
+    static const std::size_t DEFAULT_BLOCK_SIZE = 4 * 1024 * 1024;
+
+    /// Open the output file
+    ///
+    /// \param level_ zlib compression level from 1 to 9, -1 for the zlib default
+    parallel_gzip_writer(const std::string & filename_,
+                         const int level_ = -1,
+                         const unsigned int number_of_threads_ = 1,
+                         const std::size_t block_size_ = DEFAULT_BLOCK_SIZE);
+
+    /// Close the file if not done yet, errors are ignored
+    ~parallel_gzip_writer();
+
+    parallel_gzip_writer(const parallel_gzip_writer &) = delete;
+    parallel_gzip_writer & operator=(const parallel_gzip_writer &) = delete;
+
+    /// Append bytes to the stream
+    void write(const char * data_, const std::size_t size_);
+
+    /// Compress the last block, wait for all the blocks to be written and close
+    /// the file. Errors from the compression threads are thrown here.
+    void close();
+
+    /// Number of uncompressed bytes written so far
+    std::size_t get_input_size() const;
+
+    /// Number of compressed bytes written to the file so far
+    std::size_t get_output_size() const;
+
+  private:
+
+    void _submit_block_();
+
+    void _compress_loop_();
+
+    struct block_type
+    {
+      std::size_t index = 0;
+      std::string data;
+    };
+
+    std::ofstream _file_;
+    int _level_;
+    std::size_t _block_size_;
+    std::string _current_;             ///< Block being filled
+    std::size_t _next_block_index_ = 0;
+    std::size_t _next_written_index_ = 0;
+    std::deque<block_type> _pending_;  ///< Blocks waiting for a compression thread
+    std::map<std::size_t, std::string> _compressed_; ///< Gzip members waiting for their turn
+    std::size_t _input_size_ = 0;
+    std::size_t _output_size_ = 0;
+    bool _closing_ = false;
+    bool _closed_ = false;
+    std::exception_ptr _error_;
+    mutable std::mutex _mutex_;
+    std::condition_variable _work_cv_;  ///< Compression threads wait for blocks
+    std::condition_variable _room_cv_;  ///< The producer waits for room
+    std::vector<std::thread> _threads_;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_PARALLEL_GZIP_WRITER_H
@@ -0,0 +1,144 @@
+// Ourselves:
+#include <snredbridge/red_event_generator.h>
+
+// Standard library:
+#include <algorithm>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/geomtools/geom_id.h>
+
+namespace snredbridge {
+
+  namespace {
+    // Geometry categories of the SuperNEMO main calorimeter blocks and tracker cells
+    const uint32_t CALO_MAIN_WALL_TYPE = 1302;
+    const uint32_t TRACKER_CELL_TYPE = 1204;
+
+    // Calorimeter main wall and tracker dimensions
+    const uint32_t NUMBER_OF_CALO_COLUMNS = 20;
+    const uint32_t NUMBER_OF_CALO_ROWS = 13;
+    const uint32_t NUMBER_OF_TRACKER_LAYERS = 9;
+    const uint32_t NUMBER_OF_TRACKER_ROWS = 113;
+  }
+
+  red_event_generator::red_event_generator(const config_type & config_)
+    : _config_(config_)
+    , _engine_(config_.seed)
+  {
+    return;
+  }
+
+  std::size_t red_event_generator::get_event_counter() const
+  {
+    return _event_counter_;
+  }
+
+  void red_event_generator::generate(snfee::data::raw_event_data & red_)
+  {
+    red_.reset();
+    const int32_t event_id = _event_counter_;
+    const int32_t trigger_id = _event_counter_;
+    const int64_t reference_ticks = 1000000 * static_cast<int64_t>(_event_counter_);
+
+    red_.set_run_id(_config_.run_id);
+    red_.set_event_id(event_id);
+    red_.set_reference_time(snfee::data::timestamp(snfee::data::CLOCK_160MHz, reference_ticks));
+    red_.add_origin_trigger_id(trigger_id);
+
+    for (std::size_t ihit = 0; ihit < _config_.number_of_calo_hits; ihit++)
+      _generate_calo_hit_(red_.add_calo_hit(), ihit, trigger_id, reference_ticks);
+
+    for (std::size_t ihit = 0; ihit < _config_.number_of_tracker_hits; ihit++)
+      _generate_tracker_hit_(red_.add_tracker_hit(), ihit, trigger_id, reference_ticks);
+
+    _event_counter_++;
+    return;
+  }
+
+  void red_event_generator::_generate_calo_hit_(snfee::data::calo_digitized_hit & hit_,
+                                                const int32_t hit_id_,
+                                                const int32_t trigger_id_,
+                                                const int64_t reference_ticks_)
+  {
+    std::uniform_int_distribution<uint32_t> side_dist(0, 1);
+    std::uniform_int_distribution<uint32_t> column_dist(0, NUMBER_OF_CALO_COLUMNS - 1);
+    std::uniform_int_distribution<uint32_t> row_dist(0, NUMBER_OF_CALO_ROWS - 1);
+    std::normal_distribution<double> noise_dist(0.0, 2.0);
+    std::uniform_real_distribution<double> amplitude_dist(50.0, 2000.0);
+
+    hit_.set_geom_id(geomtools::geom_id(CALO_MAIN_WALL_TYPE, 0, side_dist(_engine_), column_dist(_engine_), row_dist(_engine_)));
+    hit_.set_hit_id(hit_id_);
+    hit_.set_reference_time(snfee::data::timestamp(snfee::data::CLOCK_160MHz, reference_ticks_ + hit_id_));
+
+    // Noisy baseline with a negative pulse a quarter of the way in
+    const std::size_t length = _config_.waveform_length;
+    const std::size_t rising_cell = length / 4;
+    const std::size_t peak_cell = std::min(length, rising_cell + 8);
+    const std::size_t falling_cell = std::min(length, rising_cell + 40);
+    const double amplitude = amplitude_dist(_engine_);
+    const double baseline = 2048.0;
+    std::vector<int16_t> waveform(length);
+    int32_t charge = 0;
+    for (std::size_t isample = 0; isample < length; isample++)
+      {
+        double pulse = 0.0;
+        if (isample >= rising_cell && isample < peak_cell)
+          pulse = amplitude * (isample - rising_cell) / double(peak_cell - rising_cell);
+        else if (isample >= peak_cell && isample < falling_cell)
+          pulse = amplitude * (falling_cell - isample) / double(falling_cell - peak_cell);
+        const double sample = baseline + noise_dist(_engine_) - pulse;
+        waveform[isample] = static_cast<int16_t>(sample);
+        charge += static_cast<int32_t>(pulse);
+      }
+    hit_.set_waveform(waveform);
+
+    hit_.set_low_threshold_only(amplitude < 200.0);
+    hit_.set_high_threshold(amplitude >= 200.0);
+    hit_.set_fcr(hit_id_ % 1024);
+    hit_.set_lt_trigger_counter(trigger_id_ % 65536);
+    hit_.set_lt_time_counter(reference_ticks_ % 4294967296);
+    hit_.set_fwmeas_baseline(static_cast<int16_t>(baseline * 16));
+    hit_.set_fwmeas_peak_amplitude(static_cast<int16_t>(amplitude * 8));
+    hit_.set_fwmeas_peak_cell(peak_cell);
+    hit_.set_fwmeas_charge(charge);
+    hit_.set_fwmeas_rising_cell(rising_cell * 256);
+    hit_.set_fwmeas_falling_cell(falling_cell * 256);
+    hit_.set_origin(snfee::data::calo_digitized_hit::rtd_origin(hit_id_, trigger_id_));
+    return;
+  }
+
+  void red_event_generator::_generate_tracker_hit_(snfee::data::tracker_digitized_hit & hit_,
+                                                   const int32_t hit_id_,
+                                                   const int32_t trigger_id_,
+                                                   const int64_t reference_ticks_)
+  {
+    std::uniform_int_distribution<uint32_t> side_dist(0, 1);
+    std::uniform_int_distribution<uint32_t> layer_dist(0, NUMBER_OF_TRACKER_LAYERS - 1);
+    std::uniform_int_distribution<uint32_t> row_dist(0, NUMBER_OF_TRACKER_ROWS - 1);
+    std::uniform_int_distribution<int64_t> drift_dist(0, 5000);
+
+    hit_.set_geom_id(geomtools::geom_id(TRACKER_CELL_TYPE, 0, side_dist(_engine_), layer_dist(_engine_), row_dist(_engine_)));
+    hit_.set_hit_id(hit_id_);
+
+    const snfee::data::tracker_digitized_hit::rtd_origin origin(hit_id_, trigger_id_);
+    for (std::size_t itime = 0; itime < _config_.number_of_gg_times; itime++)
+      {
+        snfee::data::tracker_digitized_hit::gg_times & times = hit_.add_times();
+        const int64_t anode_ticks = reference_ticks_ + drift_dist(_engine_);
+        for (std::size_t ianode = snfee::data::tracker_digitized_hit::ANODE_R0;
+             ianode <= snfee::data::tracker_digitized_hit::ANODE_R4; ianode++)
+          {
+            times.set_anode_origin(ianode, origin);
+            times.set_anode_time(ianode, snfee::data::timestamp(snfee::data::CLOCK_80MHz, anode_ticks + 10 * ianode));
+          }
+        times.set_bottom_cathode_origin(origin);
+        times.set_bottom_cathode_time(snfee::data::timestamp(snfee::data::CLOCK_80MHz, anode_ticks + drift_dist(_engine_)));
+        times.set_top_cathode_origin(origin);
+        times.set_top_cathode_time(snfee::data::timestamp(snfee::data::CLOCK_80MHz, anode_ticks + drift_dist(_engine_)));
+      }
+    return;
+  }
+
+} // namespace snredbridge
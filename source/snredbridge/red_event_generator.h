@@ -0,0 +1,69 @@
+/// \file snredbridge/red_event_generator.h
+/// Generator of synthetic SNFEE RED events, to measure the conversion and
+/// validation throughput without real data
+
+#ifndef SNREDBRIDGE_RED_EVENT_GENERATOR_H
+#define SNREDBRIDGE_RED_EVENT_GENERATOR_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+// Third party:
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+namespace snredbridge {
+
+  /// \brief Synthetic RED event generator
+  ///
+  /// Events have a fixed number of calorimeter hits, each with a waveform
+  /// made of a noisy baseline and a single pulse, and a fixed number of
+  /// tracker hits, each with a fixed number of GG times. Firmware
+  /// measurements are consistent with the generated pulse. The sequence of
+  /// events only depends on the seed.
+  class red_event_generator
+  {
+  public:
+
+    /// Generator configuration
+    struct config_type
+    {
+      int32_t run_id = 0;
+      std::size_t number_of_calo_hits = 10;
+      std::size_t waveform_length = 1024;
+      std::size_t number_of_tracker_hits = 50;
+      std::size_t number_of_gg_times = 1;
+      unsigned int seed = 314159;
+    };
+
+    /// Constructor
+    explicit red_event_generator(const config_type & config_);
+
+    /// Fill a RED event with the next synthetic event
+    void generate(snfee::data::raw_event_data & red_);
+
+    /// Number of events generated so far
+    std::size_t get_event_counter() const;
+
+  private:
+
+    void _generate_calo_hit_(snfee::data::calo_digitized_hit & hit_,
+                             const int32_t hit_id_,
+                             const int32_t trigger_id_,
+                             const int64_t reference_ticks_);
+
+    void _generate_tracker_hit_(snfee::data::tracker_digitized_hit & hit_,
+                                const int32_t hit_id_,
+                                const int32_t trigger_id_,
+                                const int64_t reference_ticks_);
+
+    config_type _config_;
+    std::mt19937 _engine_;
+    std::size_t _event_counter_ = 0;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_RED_EVENT_GENERATOR_H
@@ -0,0 +1,179 @@
+// Ourselves:
+#include <snredbridge/red_file_follower.h>
+
+// Standard library:
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// System:
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    typedef std::chrono::steady_clock clock_type;
+
+    bool file_exists(const std::string & filename_)
+    {
+      struct stat status;
+      return ::stat(filename_.c_str(), &status) == 0;
+    }
+
+    std::string base_name(const std::string & filename_)
+    {
+      const std::size_t slash = filename_.rfind('/');
+      return slash == std::string::npos ? filename_ : filename_.substr(slash + 1);
+    }
+
+  } // namespace
+
+  std::string to_string(const follow_end end_)
+  {
+    switch (end_)
+      {
+      case follow_end::none: return "none";
+      case follow_end::end_marker: return "end_marker";
+      case follow_end::idle_timeout: return "idle_timeout";
+      case follow_end::stopped: return "stopped";
+      }
+    return "";
+  }
+
+  red_file_follower::red_file_follower(const config_type & config_)
+    : _config_(config_)
+  {
+    DT_THROW_IF(_config_.filename.empty(), std::logic_error, "Missing RED file to follow!");
+    DT_THROW_IF(_config_.idle_timeout < 0.0, std::logic_error, "Invalid idle timeout!");
+    DT_THROW_IF(_config_.poll_interval <= 0.0, std::logic_error, "Invalid poll interval!");
+    if (_config_.end_marker.empty()) _config_.end_marker = _config_.filename + ".end";
+
+    // Same extension as the RED file: a compressed file is inflated by the reader
+    _red_pipe_ = _pipes_.make_pipe(base_name(_config_.filename), "RED pipe");
+    _follow_thread_ = std::thread(&red_file_follower::_follow_, this);
+  }
+
+  red_file_follower::~red_file_follower()
+  {
+    try {
+      wait();
+    }
+    catch (...) {
+    }
+  }
+
+  const std::string & red_file_follower::get_red_filename() const
+  {
+    return _red_pipe_;
+  }
+
+  void red_file_follower::wait()
+  {
+    if (_waited_) return;
+    _waited_ = true;
+    _stop_ = true;
+    if (_follow_thread_.joinable()) _follow_thread_.join();
+    _pipes_.remove();
+    if (_error_) std::rethrow_exception(_error_);
+    return;
+  }
+
+  follow_end red_file_follower::get_end() const
+  {
+    return _end_;
+  }
+
+  std::size_t red_file_follower::get_number_of_bytes() const
+  {
+    return _bytes_;
+  }
+
+  const red_file_follower::config_type & red_file_follower::get_config() const
+  {
+    return _config_;
+  }
+
+  void red_file_follower::_follow_()
+  {
+    // With -n, the conversion may stop reading before the end of the RED
+    // file, or never open the pipe
+    block_sigpipe();
+    const int red_fd = open_pipe_writer(_red_pipe_, _stop_);
+    if (red_fd < 0)
+      {
+        _end_ = follow_end::stopped;
+        return;
+      }
+
+    const auto poll_interval = std::chrono::duration<double>(_config_.poll_interval);
+    const auto idle_timeout = std::chrono::duration<double>(_config_.idle_timeout);
+    clock_type::time_point last_growth = clock_type::now();
+    auto idle = [&] {
+      return _config_.idle_timeout > 0.0 && clock_type::now() - last_growth >= idle_timeout;
+    };
+
+    int fd = -1;
+    try {
+      // The acquisition may not have created the RED file yet
+      while (_end_ == follow_end::none)
+        {
+          fd = ::open(_config_.filename.c_str(), O_RDONLY | O_CLOEXEC);
+          if (fd >= 0) break;
+          DT_THROW_IF(errno != ENOENT, std::runtime_error,
+                      "Cannot open the RED file '" << _config_.filename << "': " << std::strerror(errno));
+          if (_stop_) _end_ = follow_end::stopped;
+          else if (file_exists(_config_.end_marker)) _end_ = follow_end::end_marker;
+          else if (idle()) _end_ = follow_end::idle_timeout;
+          else std::this_thread::sleep_for(poll_interval);
+        }
+
+      std::vector<char> buffer(1024 * 1024);
+      bool marker_seen = false;
+      while (_end_ == follow_end::none)
+        {
+          const ssize_t size = ::read(fd, buffer.data(), buffer.size());
+          if (size < 0)
+            {
+              if (errno == EINTR) continue;
+              DT_THROW(std::runtime_error, "Cannot read the RED file '" << _config_.filename << "': " << std::strerror(errno));
+            }
+          if (size > 0)
+            {
+              if (!write_all(red_fd, buffer.data(), size))
+                {
+                  _end_ = follow_end::stopped;
+                  continue;
+                }
+              _bytes_ += size;
+              last_growth = clock_type::now();
+              continue;
+            }
+          // At the current end of the RED file. The last records may have
+          // been appended just before the marker: the file is read to its end
+          // once more after the marker appeared.
+          if (marker_seen) _end_ = follow_end::end_marker;
+          else if (file_exists(_config_.end_marker)) marker_seen = true;
+          else if (_stop_) _end_ = follow_end::stopped;
+          else if (idle()) _end_ = follow_end::idle_timeout;
+          else std::this_thread::sleep_for(poll_interval);
+        }
+    }
+    catch (...) {
+      _error_ = std::current_exception();
+    }
+    if (fd >= 0) ::close(fd);
+    // The conversion now reaches the end of the stream
+    ::close(red_fd);
+    return;
+  }
+
+} // namespace snredbridge
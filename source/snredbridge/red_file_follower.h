@@ -0,0 +1,97 @@
+/// \file snredbridge/red_file_follower.h
+/// Follower of a RED file still being written, streaming its records
+/// through a named pipe
+
+#ifndef SNREDBRIDGE_RED_FILE_FOLLOWER_H
+#define SNREDBRIDGE_RED_FILE_FOLLOWER_H
+
+// Standard library:
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <thread>
+
+// This project:
+#include <snredbridge/named_pipe.h>
+
+namespace snredbridge {
+
+  /// \brief Reason of the end of a followed RED file
+  enum class follow_end
+  {
+    none,          ///< Still following
+    end_marker,    ///< The end-of-run marker appeared and the file was read up to its end
+    idle_timeout,  ///< The file did not grow for longer than the idle timeout
+    stopped        ///< The conversion stopped reading before the end
+  };
+
+  std::string to_string(const follow_end end_);
+
+  /// \brief Tail of a RED file written by a running acquisition
+  ///
+  /// A thread copies the bytes of the RED file into a named pipe as they
+  /// are appended to it, like "tail -f". The conversion reads the RED
+  /// records from get_red_filename(): it blocks at the end of the bytes
+  /// written so far and goes on with the next records when the file grows.
+  ///
+  /// The stream ends, once the file has been read up to its current end,
+  /// when the end-of-run marker exists (a file created by the acquisition
+  /// after its last record) or when the file did not grow for longer than
+  /// the idle timeout. The pipe has the name of the RED file, so that its
+  /// extension still selects the decompression of the records.
+  class red_file_follower
+  {
+  public:
+
+    struct config_type
+    {
+      std::string filename;           ///< RED file to follow
+      std::string end_marker;         ///< End-of-run marker (empty: the RED file with the ".end" suffix)
+      double idle_timeout = 600.0;    ///< Time without new bytes before the end of the stream (s, 0: none)
+      double poll_interval = 0.5;     ///< Time between the checks for new bytes (s)
+    };
+
+    /// Create the pipe and start following the RED file
+    explicit red_file_follower(const config_type & config_);
+
+    /// Stop following the RED file if not done yet, errors are ignored
+    ~red_file_follower();
+
+    red_file_follower(const red_file_follower &) = delete;
+    red_file_follower & operator=(const red_file_follower &) = delete;
+
+    /// RED file to read the records from (a named pipe)
+    const std::string & get_red_filename() const;
+
+    /// Stop following the RED file, once the RED records have been read.
+    /// Throws if the RED file could not be read.
+    void wait();
+
+    /// Reason of the end of the stream (valid after wait())
+    follow_end get_end() const;
+
+    /// Number of bytes of the RED file streamed to the conversion
+    std::size_t get_number_of_bytes() const;
+
+    /// Configuration, with the end-of-run marker resolved
+    const config_type & get_config() const;
+
+  private:
+
+    void _follow_();
+
+    config_type _config_;
+    temporary_pipes _pipes_;
+    std::string _red_pipe_;
+    std::thread _follow_thread_;
+    std::atomic<bool> _stop_{false};  ///< The conversion will not read the pipe anymore
+    std::atomic<std::size_t> _bytes_{0};
+    follow_end _end_ = follow_end::none;
+    std::exception_ptr _error_;
+    bool _waited_ = false;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_RED_FILE_FOLLOWER_H
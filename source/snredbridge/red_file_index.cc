@@ -0,0 +1,383 @@
+// Ourselves:
+#include <snredbridge/red_file_index.h>
+
+// Standard library:
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/archives_list.h>
+
+// - zlib:
+#include <zlib.h>
+
+// This project:
+#include <snredbridge/named_pipe.h>
+#include <snredbridge/run_monitoring.h>
+
+namespace snredbridge {
+
+  /// Interface of the Boost input archives of the Bayeux io_factory
+  class red_archive
+  {
+  public:
+
+    virtual ~red_archive() = default;
+
+    /// Check if the stream has no more record
+    virtual bool at_end() = 0;
+
+    virtual void load_tag(std::string & tag_) = 0;
+
+    virtual void load(snfee::data::raw_event_data & red_) = 0;
+  };
+
+  namespace {
+
+    const std::string INDEX_MAGIC = "SNREDBRIDGE_RED_INDEX";
+    const uint32_t INDEX_VERSION = 1;
+
+    template <class Archive>
+    class red_archive_impl
+      : public red_archive
+    {
+    public:
+
+      red_archive_impl(std::istream & stream_, const bool text_)
+        : _stream_(stream_)
+        , _text_(text_)
+        , _archive_(stream_)
+      {
+      }
+
+      bool at_end() override
+      {
+        std::streambuf & buffer = *_stream_.rdbuf();
+        // Text archives end with a new line
+        if (_text_)
+          while (buffer.sgetc() != EOF && std::isspace(buffer.sgetc())) buffer.sbumpc();
+        return buffer.sgetc() == EOF;
+      }
+
+      void load_tag(std::string & tag_) override
+      {
+        _archive_ >> tag_;
+        return;
+      }
+
+      void load(snfee::data::raw_event_data & red_) override
+      {
+        _archive_ >> red_;
+        return;
+      }
+
+    private:
+
+      std::istream & _stream_;
+      bool _text_;
+      Archive _archive_;
+    };
+
+    /// Archive of a RED file, chosen from its extension as by the Bayeux io_factory
+    std::unique_ptr<red_archive> make_red_archive(const std::string & red_filename_,
+                                                  std::istream & stream_)
+    {
+      DT_THROW_IF(!ends_with(red_filename_, ".gz"), std::logic_error,
+                  "RED file '" << red_filename_ << "' is not gzip compressed!");
+      const std::string filename = red_filename_.substr(0, red_filename_.size() - 3);
+      if (ends_with(filename, ".data"))
+        return std::unique_ptr<red_archive>(new red_archive_impl<eos::portable_iarchive>(stream_, false));
+      if (ends_with(filename, ".txt"))
+        return std::unique_ptr<red_archive>(new red_archive_impl<boost::archive::text_iarchive>(stream_, true));
+      DT_THROW(std::logic_error, "Unsupported archive format of RED file '" << red_filename_ << "'!");
+    }
+
+    template <typename T>
+    void write_value(gzFile file_, const T & value_)
+    {
+      DT_THROW_IF(gzwrite(file_, &value_, sizeof(T)) != static_cast<int>(sizeof(T)),
+                  std::runtime_error, "Cannot write the RED file index!");
+      return;
+    }
+
+    void write_string(gzFile file_, const std::string & value_)
+    {
+      write_value<uint32_t>(file_, value_.size());
+      if (value_.empty()) return;
+      DT_THROW_IF(gzwrite(file_, value_.data(), value_.size()) != static_cast<int>(value_.size()),
+                  std::runtime_error, "Cannot write the RED file index!");
+      return;
+    }
+
+    template <typename T>
+    T read_value(gzFile file_)
+    {
+      T value;
+      DT_THROW_IF(gzread(file_, &value, sizeof(T)) != static_cast<int>(sizeof(T)),
+                  std::runtime_error, "Truncated RED file index!");
+      return value;
+    }
+
+    std::string read_string(gzFile file_)
+    {
+      std::string value(read_value<uint32_t>(file_), '\0');
+      if (value.empty()) return value;
+      DT_THROW_IF(gzread(file_, &value[0], value.size()) != static_cast<int>(value.size()),
+                  std::runtime_error, "Truncated RED file index!");
+      return value;
+    }
+
+  } // namespace
+
+  std::string red_file_index::default_filename(const std::string & red_filename_)
+  {
+    return red_filename_ + ".idx";
+  }
+
+  void red_file_index::build(const std::string & red_filename_, const uint64_t spacing_)
+  {
+    _red_file_size_ = get_file_size(red_filename_);
+    _prime_records_ = 0;
+    _records_.clear();
+    _checkpoints_.clear();
+    _checkpoints_.push_back(gzip_checkpoint());
+
+    gzip_streambuf buffer(red_filename_);
+    buffer.grab_inflater().record_checkpoints(_checkpoints_, spacing_);
+    std::istream stream(&buffer);
+    std::unique_ptr<red_archive> archive = make_red_archive(red_filename_, stream);
+
+    // First records with calorimeter hits, tracker hits, GG times and
+    // auxiliaries: their classes are described there in the archive
+    const std::size_t none = static_cast<std::size_t>(-1);
+    std::size_t first_calo_hit = none;
+    std::size_t first_tracker_hit = none;
+    std::size_t first_gg_times = none;
+    std::size_t first_auxiliaries = none;
+
+    snfee::data::raw_event_data red;
+    std::string tag;
+    while (!archive->at_end())
+      {
+        const std::size_t position = _records_.size();
+        record_entry entry;
+        entry.offset = buffer.tell();
+        archive->load_tag(tag);
+        DT_THROW_IF(tag != snfee::data::raw_event_data::SERIAL_TAG, std::logic_error,
+                    "Unexpected record tag '" << tag << "' in RED file '" << red_filename_ << "'!");
+        red.reset();
+        archive->load(red);
+        entry.run_id = red.get_run_id();
+        entry.event_id = red.get_event_id();
+        _records_.push_back(entry);
+
+        if (first_calo_hit == none && !red.get_calo_hits().empty()) first_calo_hit = position;
+        if (first_auxiliaries == none && red.get_auxiliaries().size() > 0) first_auxiliaries = position;
+        for (const auto & tracker_hit : red.get_tracker_hits())
+          {
+            if (first_tracker_hit == none) first_tracker_hit = position;
+            if (first_gg_times == none && !tracker_hit.get_times().empty()) first_gg_times = position;
+          }
+      }
+
+    for (const std::size_t first : {first_calo_hit, first_tracker_hit, first_gg_times, first_auxiliaries})
+      if (first != none) _prime_records_ = std::max(_prime_records_, first + 1);
+    return;
+  }
+
+  void red_file_index::save(const std::string & filename_) const
+  {
+    gzFile file = gzopen(filename_.c_str(), "wb");
+    DT_THROW_IF(file == nullptr, std::runtime_error, "Cannot create RED file index '" << filename_ << "'!");
+    try
+      {
+        write_string(file, INDEX_MAGIC);
+        write_value<uint32_t>(file, INDEX_VERSION);
+        write_value<uint64_t>(file, _red_file_size_);
+        write_value<uint64_t>(file, _prime_records_);
+        write_value<uint64_t>(file, _checkpoints_.size());
+        for (const gzip_checkpoint & checkpoint : _checkpoints_)
+          {
+            write_value<uint64_t>(file, checkpoint.compressed_offset);
+            write_value<uint64_t>(file, checkpoint.uncompressed_offset);
+            write_value<int32_t>(file, checkpoint.bits);
+            write_value<uint8_t>(file, checkpoint.member_start ? 1 : 0);
+            write_string(file, checkpoint.window);
+          }
+        write_value<uint64_t>(file, _records_.size());
+        for (const record_entry & entry : _records_)
+          {
+            write_value<uint64_t>(file, entry.offset);
+            write_value<int32_t>(file, entry.run_id);
+            write_value<int32_t>(file, entry.event_id);
+          }
+      }
+    catch (...)
+      {
+        gzclose(file);
+        throw;
+      }
+    DT_THROW_IF(gzclose(file) != Z_OK, std::runtime_error, "Cannot write RED file index '" << filename_ << "'!");
+    return;
+  }
+
+  void red_file_index::load(const std::string & filename_)
+  {
+    gzFile file = gzopen(filename_.c_str(), "rb");
+    DT_THROW_IF(file == nullptr, std::runtime_error, "Cannot open RED file index '" << filename_ << "'!");
+    try
+      {
+        DT_THROW_IF(read_string(file) != INDEX_MAGIC, std::runtime_error,
+                    "File '" << filename_ << "' is not a RED file index!");
+        const uint32_t version = read_value<uint32_t>(file);
+        DT_THROW_IF(version != INDEX_VERSION, std::runtime_error,
+                    "Unsupported version " << version << " of RED file index '" << filename_ << "'!");
+        _red_file_size_ = read_value<uint64_t>(file);
+        _prime_records_ = read_value<uint64_t>(file);
+        _checkpoints_.resize(read_value<uint64_t>(file));
+        for (gzip_checkpoint & checkpoint : _checkpoints_)
+          {
+            checkpoint.compressed_offset = read_value<uint64_t>(file);
+            checkpoint.uncompressed_offset = read_value<uint64_t>(file);
+            checkpoint.bits = read_value<int32_t>(file);
+            checkpoint.member_start = read_value<uint8_t>(file) != 0;
+            checkpoint.window = read_string(file);
+          }
+        _records_.resize(read_value<uint64_t>(file));
+        for (record_entry & entry : _records_)
+          {
+            entry.offset = read_value<uint64_t>(file);
+            entry.run_id = read_value<int32_t>(file);
+            entry.event_id = read_value<int32_t>(file);
+          }
+      }
+    catch (...)
+      {
+        gzclose(file);
+        throw;
+      }
+    gzclose(file);
+    DT_THROW_IF(_checkpoints_.empty(), std::runtime_error, "RED file index '" << filename_ << "' has no checkpoint!");
+    return;
+  }
+
+  bool red_file_index::matches(const std::string & red_filename_) const
+  {
+    return get_file_size(red_filename_) == _red_file_size_;
+  }
+
+  std::size_t red_file_index::get_number_of_records() const
+  {
+    return _records_.size();
+  }
+
+  const red_file_index::record_entry & red_file_index::get_record(const std::size_t position_) const
+  {
+    DT_THROW_IF(position_ >= _records_.size(), std::range_error,
+                "Record " << position_ << " beyond the " << _records_.size() << " records of the RED file!");
+    return _records_[position_];
+  }
+
+  std::size_t red_file_index::get_number_of_prime_records() const
+  {
+    return _prime_records_;
+  }
+
+  std::size_t red_file_index::get_number_of_checkpoints() const
+  {
+    return _checkpoints_.size();
+  }
+
+  const gzip_checkpoint & red_file_index::find_checkpoint(const uint64_t offset_) const
+  {
+    auto after = std::upper_bound(_checkpoints_.begin(), _checkpoints_.end(), offset_,
+                                  [](const uint64_t offset_, const gzip_checkpoint & checkpoint_) {
+                                    return offset_ < checkpoint_.uncompressed_offset;
+                                  });
+    DT_THROW_IF(after == _checkpoints_.begin(), std::logic_error, "No checkpoint before offset " << offset_ << "!");
+    return *(after - 1);
+  }
+
+
+  red_indexed_reader::red_indexed_reader(const std::string & red_filename_,
+                                         const red_file_index & index_,
+                                         const std::size_t first_record_)
+    : _index_(index_)
+    , _position_(first_record_)
+  {
+    DT_THROW_IF(first_record_ > index_.get_number_of_records(), std::range_error,
+                "First record " << first_record_ << " beyond the "
+                << index_.get_number_of_records() << " records of RED file '" << red_filename_ << "'!");
+    _buffer_.reset(new gzip_streambuf(red_filename_));
+    const std::size_t prime_records = index_.get_number_of_prime_records();
+    // Jump over the records between the prime records and the first one
+    const bool jump = first_record_ > prime_records && first_record_ < index_.get_number_of_records();
+    if (jump)
+      {
+        const uint64_t target = index_.get_record(first_record_).offset;
+        _buffer_->splice(index_.get_record(prime_records).offset, index_.find_checkpoint(target), target);
+      }
+    _stream_.reset(new std::istream(_buffer_.get()));
+    _archive_ = make_red_archive(red_filename_, *_stream_);
+
+    const std::size_t skipped = jump ? prime_records : std::min(first_record_, index_.get_number_of_records());
+    snfee::data::raw_event_data red;
+    std::string tag;
+    for (std::size_t i = 0; i < skipped; i++)
+      {
+        _archive_->load_tag(tag);
+        red.reset();
+        _archive_->load(red);
+      }
+    _read_tag_();
+  }
+
+  red_indexed_reader::~red_indexed_reader() = default;
+
+  bool red_indexed_reader::has_record_tag() const
+  {
+    return _has_tag_;
+  }
+
+  const std::string & red_indexed_reader::get_record_tag() const
+  {
+    return _next_tag_;
+  }
+
+  bool red_indexed_reader::record_tag_is(const std::string & tag_) const
+  {
+    return _has_tag_ && _next_tag_ == tag_;
+  }
+
+  void red_indexed_reader::load(snfee::data::raw_event_data & red_)
+  {
+    DT_THROW_IF(!_has_tag_, std::logic_error, "No more record to load!");
+    red_.reset();
+    _archive_->load(red_);
+    const red_file_index::record_entry & entry = _index_.get_record(_position_);
+    DT_THROW_IF(red_.get_run_id() != entry.run_id || red_.get_event_id() != entry.event_id,
+                std::runtime_error,
+                "Record " << _position_ << " is event " << red_.get_run_id() << "/" << red_.get_event_id()
+                << " instead of event " << entry.run_id << "/" << entry.event_id
+                << " in the index: the index does not match the RED file!");
+    _position_++;
+    _read_tag_();
+    return;
+  }
+
+  std::size_t red_indexed_reader::get_record_position() const
+  {
+    return _position_;
+  }
+
+  void red_indexed_reader::_read_tag_()
+  {
+    _has_tag_ = _position_ < _index_.get_number_of_records() && !_archive_->at_end();
+    if (_has_tag_) _archive_->load_tag(_next_tag_);
+    return;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,136 @@
+/// \file snredbridge/red_file_index.h
+/// Sidecar index of a gzip compressed RED file, to start reading at any event
+
+#ifndef SNREDBRIDGE_RED_FILE_INDEX_H
+#define SNREDBRIDGE_RED_FILE_INDEX_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Third party:
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+// This project:
+#include <snredbridge/gzip_index.h>
+
+namespace snredbridge {
+
+  /// \brief Index of the records of a RED file
+  ///
+  /// The index holds inflate checkpoints of the gzip stream and the offset of
+  /// each record in the uncompressed stream. The records are stored in a
+  /// single Boost archive, whose state (class information) is set by the
+  /// first occurrence of each class: a reader must load the first "prime"
+  /// records, where all the classes occur, before jumping to another record.
+  class red_file_index
+  {
+  public:
+
+    /// Position of a record in the uncompressed stream and its event
+    struct record_entry
+    {
+      uint64_t offset = 0;
+      int32_t run_id = -1;
+      int32_t event_id = -1;
+    };
+
+    /// Default spacing of the checkpoints in the uncompressed stream (16 MiB)
+    static const uint64_t DEFAULT_SPACING = 16 * 1024 * 1024;
+
+    /// Default index file of a RED file ("<RED file>.idx")
+    static std::string default_filename(const std::string & red_filename_);
+
+    /// Read a whole RED file and build its index
+    void build(const std::string & red_filename_,
+               const uint64_t spacing_ = DEFAULT_SPACING);
+
+    /// Store the index into a file
+    void save(const std::string & filename_) const;
+
+    /// Load the index from a file
+    void load(const std::string & filename_);
+
+    /// Check if the index was built from a RED file of the same size
+    bool matches(const std::string & red_filename_) const;
+
+    /// Number of records of the RED file
+    std::size_t get_number_of_records() const;
+
+    /// Record at a given position
+    const record_entry & get_record(const std::size_t position_) const;
+
+    /// Number of records to load before jumping to another record
+    std::size_t get_number_of_prime_records() const;
+
+    /// Number of inflate checkpoints
+    std::size_t get_number_of_checkpoints() const;
+
+    /// Last checkpoint before an offset of the uncompressed stream
+    const gzip_checkpoint & find_checkpoint(const uint64_t offset_) const;
+
+  private:
+
+    uint64_t _red_file_size_ = 0;
+    std::size_t _prime_records_ = 0;
+    std::vector<gzip_checkpoint> _checkpoints_;
+    std::vector<record_entry> _records_;
+  };
+
+  /// Boost archive reading RED records, defined in red_file_index.cc
+  class red_archive;
+
+  /// \brief Reader of a RED file starting at any record
+  ///
+  /// The reader loads the prime records of the file, then jumps to the first
+  /// requested record through the nearest inflate checkpoint. It offers the
+  /// has_record_tag(), record_tag_is() and load() methods of the SNFEE
+  /// multifile_data_reader. The event ID of each loaded record is checked
+  /// against the index.
+  class red_indexed_reader
+  {
+  public:
+
+    /// Open a RED file to read from the record at position first_record_
+    red_indexed_reader(const std::string & red_filename_,
+                       const red_file_index & index_,
+                       const std::size_t first_record_);
+
+    ~red_indexed_reader();
+
+    /// Check if there is a next record
+    bool has_record_tag() const;
+
+    /// Serialization tag of the next record
+    const std::string & get_record_tag() const;
+
+    /// Check the serialization tag of the next record
+    bool record_tag_is(const std::string & tag_) const;
+
+    /// Load the next record
+    void load(snfee::data::raw_event_data & red_);
+
+    /// Position in the file of the next record
+    std::size_t get_record_position() const;
+
+  private:
+
+    void _read_tag_();
+
+    const red_file_index & _index_;
+    std::unique_ptr<gzip_streambuf> _buffer_;
+    std::unique_ptr<std::istream> _stream_;
+    std::unique_ptr<red_archive> _archive_;
+    std::string _next_tag_;
+    bool _has_tag_ = false;
+    std::size_t _position_ = 0;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_RED_FILE_INDEX_H
@@ -0,0 +1,168 @@
+// Ourselves:
+#include <snredbridge/red_input_module.h>
+
+// Standard library:
+#include <stdexcept>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/utils.h>
+
+// - SNFEE:
+#include <snfee/snfee.h>
+
+// This project:
+#include <snredbridge/event_fingerprint.h>
+#include <snredbridge/red_to_udd_conversion.h>
+
+namespace snredbridge {
+
+  // Registration instantiation macro :
+  DPP_MODULE_REGISTRATION_IMPLEMENT(red_input_module, "snredbridge::red_input_module")
+
+  red_input_module::red_input_module(datatools::logger::priority logging_priority_)
+    : dpp::base_module(logging_priority_)
+  {
+    return;
+  }
+
+  red_input_module::~red_input_module()
+  {
+    if (is_initialized()) red_input_module::reset();
+    return;
+  }
+
+  void red_input_module::set_filenames(const std::vector<std::string> & filenames_)
+  {
+    DT_THROW_IF(is_initialized(), std::logic_error, "Module '" << get_name() << "' is already initialized!");
+    _filenames_ = filenames_;
+    return;
+  }
+
+  void red_input_module::set_max_record_total(const std::size_t max_record_total_)
+  {
+    DT_THROW_IF(is_initialized(), std::logic_error, "Module '" << get_name() << "' is already initialized!");
+    _max_record_total_ = max_record_total_;
+    return;
+  }
+
+  void red_input_module::set_waveform_config(const waveform_config & waveform_config_)
+  {
+    DT_THROW_IF(is_initialized(), std::logic_error, "Module '" << get_name() << "' is already initialized!");
+    _waveform_config_ = waveform_config_;
+    return;
+  }
+
+  void red_input_module::set_fingerprint(const bool fingerprint_)
+  {
+    DT_THROW_IF(is_initialized(), std::logic_error, "Module '" << get_name() << "' is already initialized!");
+    _fingerprint_ = fingerprint_;
+    return;
+  }
+
+  std::size_t red_input_module::get_record_counter() const
+  {
+    return _record_counter_;
+  }
+
+  bool red_input_module::is_terminated() const
+  {
+    return _terminated_;
+  }
+
+  void red_input_module::initialize(const datatools::properties & config_,
+                                    datatools::service_manager & /* services_ */,
+                                    dpp::module_handle_dict_type & /* modules_ */)
+  {
+    DT_THROW_IF(is_initialized(), std::logic_error, "Module '" << get_name() << "' is already initialized!");
+    dpp::base_module::_common_initialize(config_);
+
+    if (config_.has_key("filenames"))
+      {
+        std::vector<std::string> filenames;
+        config_.fetch("filenames", filenames);
+        for (auto & filename : filenames) datatools::fetch_path_with_env(filename);
+        set_filenames(filenames);
+      }
+
+    if (config_.has_key("max_record_total"))
+      {
+        const int max_record_total = config_.fetch_integer("max_record_total");
+        DT_THROW_IF(max_record_total < 0, std::domain_error, "Invalid maximum number of records '" << max_record_total << "'!");
+        set_max_record_total(max_record_total);
+      }
+
+    waveform_config waveform_cfg = _waveform_config_;
+    if (config_.has_key("waveform.mode"))
+      waveform_cfg.mode = waveform_mode_from_string(config_.fetch_string("waveform.mode"));
+    if (config_.has_key("waveform.roi_before"))
+      {
+        const int roi_before = config_.fetch_integer("waveform.roi_before");
+        DT_THROW_IF(roi_before < 0, std::domain_error, "Invalid number of cells before the pulse '" << roi_before << "'!");
+        waveform_cfg.roi_before = roi_before;
+      }
+    if (config_.has_key("waveform.roi_after"))
+      {
+        const int roi_after = config_.fetch_integer("waveform.roi_after");
+        DT_THROW_IF(roi_after < 0, std::domain_error, "Invalid number of cells after the pulse '" << roi_after << "'!");
+        waveform_cfg.roi_after = roi_after;
+      }
+    set_waveform_config(waveform_cfg);
+
+    if (config_.has_key("fingerprint"))
+      set_fingerprint(config_.fetch_boolean("fingerprint"));
+
+    DT_THROW_IF(_filenames_.empty(), std::logic_error, "Module '" << get_name() << "' has no RED input file!");
+
+    if (!snfee::is_initialized()) snfee::initialize();
+
+    snfee::io::multifile_data_reader::config_type reader_cfg;
+    reader_cfg.filenames = _filenames_;
+    _red_source_.reset(new snfee::io::multifile_data_reader(reader_cfg));
+    _record_counter_ = 0;
+    _terminated_ = false;
+
+    _set_initialized(true);
+    return;
+  }
+
+  void red_input_module::reset()
+  {
+    DT_THROW_IF(!is_initialized(), std::logic_error, "Module '" << get_name() << "' is not initialized!");
+    _set_initialized(false);
+    _red_source_.reset();
+    _record_counter_ = 0;
+    _terminated_ = false;
+    return;
+  }
+
+  dpp::base_module::process_status red_input_module::process(datatools::things & event_record_)
+  {
+    DT_THROW_IF(!is_initialized(), std::logic_error, "Module '" << get_name() << "' is not initialized!");
+
+    // PROCESS_STOP would only skip the next modules, the driver would call
+    // this module again for ever: the end of the input is fatal
+    if (_terminated_
+        || !_red_source_->has_record_tag()
+        || (_max_record_total_ > 0 && _record_counter_ >= _max_record_total_))
+      {
+        if (!_terminated_)
+          DT_LOG_WARNING(datatools::logger::PRIO_WARNING,
+                         "Module '" << get_name() << "': end of the RED input after " << _record_counter_
+                         << " record(s), the pipeline is stopped");
+        _terminated_ = true;
+        return dpp::base_module::PROCESS_FATAL;
+      }
+
+    DT_THROW_IF(!_red_source_->record_tag_is(snfee::data::raw_event_data::SERIAL_TAG),
+                std::logic_error, "Unexpected record tag '" << _red_source_->get_record_tag() << "'!");
+
+    _red_source_->load(_red_);
+    do_red_to_udd_conversion(_red_, event_record_, _waveform_config_);
+    if (_fingerprint_) store_fingerprint(_red_, _waveform_config_, event_record_);
+    _record_counter_++;
+
+    return dpp::base_module::PROCESS_OK;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,108 @@
+/// \file snredbridge/red_input_module.h
+/// Data processing module reading SNFEE RED files and filling the EH/UDD banks
+/// of the event record, to run dpp pipelines straight from RED files
+
+#ifndef SNREDBRIDGE_RED_INPUT_MODULE_H
+#define SNREDBRIDGE_RED_INPUT_MODULE_H
+
+// Standard library:
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/dpp/base_module.h>
+
+// - SNFEE:
+#include <snfee/io/multifile_data_reader.h>
+#include <snfee/data/raw_event_data.h>
+
+// This project:
+#include <snredbridge/waveform_codec.h>
+
+namespace snredbridge {
+
+  /// \brief RED input module
+  ///
+  /// Each call to process() loads the next RED event and converts it into
+  /// the "EH" and "UDD" banks of the event record, as red_bridge does. The
+  /// module must be the first one of the pipeline.
+  ///
+  /// A dpp module cannot end the input of its driver: PROCESS_STOP only skips
+  /// the other modules for the current record. Once all RED events have been
+  /// read, process() logs the end of the input and returns PROCESS_FATAL, so
+  /// that the driver stops. A clean end needs a maximum number of records
+  /// given to the driver (-M option of bxdpp_processing).
+  ///
+  /// Configuration:
+  /// \code
+  /// filenames : string[1] as path = "snemo_run-815_red-v1.data.gz"
+  /// max_record_total : integer = 1000
+  /// waveform.mode : string = "full"
+  /// waveform.roi_before : integer = 32
+  /// waveform.roi_after : integer = 96
+  /// fingerprint : boolean = true
+  /// \endcode
+  class red_input_module
+    : public dpp::base_module
+  {
+  public:
+
+    /// Constructor
+    red_input_module(datatools::logger::priority logging_priority_ = datatools::logger::PRIO_FATAL);
+
+    /// Destructor
+    virtual ~red_input_module();
+
+    /// Set the list of RED files to read
+    void set_filenames(const std::vector<std::string> & filenames_);
+
+    /// Set the maximum number of RED events to read (0: no limit)
+    void set_max_record_total(const std::size_t max_record_total_);
+
+    /// Set the storage of the calorimeter waveforms into the UDD bank
+    void set_waveform_config(const waveform_config & waveform_config_);
+
+    /// Store the fingerprint of each event in its header
+    void set_fingerprint(const bool fingerprint_);
+
+    /// Number of RED events converted so far
+    std::size_t get_record_counter() const;
+
+    /// Check if all the RED events have been read
+    bool is_terminated() const;
+
+    /// Initialization
+    virtual void initialize(const datatools::properties & config_,
+                            datatools::service_manager & services_,
+                            dpp::module_handle_dict_type & modules_);
+
+    /// Reset
+    virtual void reset();
+
+    /// Data record processing
+    virtual process_status process(datatools::things & event_record_);
+
+  private:
+
+    // Configuration:
+    std::vector<std::string> _filenames_;
+    std::size_t _max_record_total_ = 0;
+    waveform_config _waveform_config_;
+    bool _fingerprint_ = true;
+
+    // Working data:
+    std::unique_ptr<snfee::io::multifile_data_reader> _red_source_;
+    snfee::data::raw_event_data _red_;
+    std::size_t _record_counter_ = 0;
+    bool _terminated_ = false;
+
+    // Macro to automate the registration of the module :
+    DPP_MODULE_REGISTRATION_INTERFACE(red_input_module)
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_RED_INPUT_MODULE_H
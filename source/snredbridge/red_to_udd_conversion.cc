@@ -0,0 +1,153 @@
+// Ourselves:
+#include <snredbridge/red_to_udd_conversion.h>
+
+// Standard library:
+#include <set>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Falaise:
+#include <falaise/snemo/datamodels/event_header.h>
+#include <falaise/snemo/datamodels/unified_digitized_data.h>
+
+// This project:
+#include <snredbridge/field_mapping.h>
+
+namespace snredbridge {
+
+  void prepare_event_record(datatools::things & event_record_,
+                            const std::size_t record_index_)
+  {
+    // Banks from the previous event are kept and reset by the conversion
+    event_record_.set_name("ER_" + std::to_string(record_index_));
+    event_record_.set_description("An event record composed by an Event Header (EH) and the Unified Digitized Data (UDD) banks");
+    return;
+  }
+
+
+  void do_red_to_udd_conversion(const snfee::data::raw_event_data & red_,
+                                datatools::things & event_record_,
+                                bool no_wf_)
+  {
+    waveform_config the_waveform_config;
+    if (no_wf_) the_waveform_config.mode = waveform_mode::none;
+    do_red_to_udd_conversion(red_, event_record_, the_waveform_config);
+    return;
+  }
+
+
+  void do_red_to_udd_conversion(const snfee::data::raw_event_data & red_,
+                                datatools::things & event_record_,
+                                const waveform_config & waveform_config_)
+  {
+    // Run number
+    int32_t red_run_id   = red_.get_run_id();
+
+    // Event number
+    int32_t red_event_id = red_.get_event_id();
+
+    // Container of merged TriggerID(s) by event builder
+    const std::set<int32_t> & red_trigger_ids = red_.get_origin_trigger_ids();
+
+    // RED Digitized calo hits
+    const std::vector<snfee::data::calo_digitized_hit> & red_calo_hits = red_.get_calo_hits();
+
+    // RED Digitized tracker hits
+    const std::vector<snfee::data::tracker_digitized_hit> & red_tracker_hits = red_.get_tracker_hits();
+
+    // Print RED infos
+    // std::cout << "Event #" << red_event_id << " contains "
+    //           << red_trigger_ids.size() << " TriggerID(s) with "
+    //           << red_calo_hits.size() << " calo hit(s) and "
+    //           << red_tracker_hits.size() << " tracker hit(s)"
+    //           << std::endl;
+
+    std::string EH_output_tag  = "EH";
+    std::string UDD_output_tag = "UDD";
+
+    // Empty working EH and UDD objects, reused if the event record already holds them
+    // auto & EH = snedm::addToEvent<snemo::datamodel::event_header>(EH_output_tag, event_record_);
+    // auto & UDD = snedm::addToEvent<snemo::datamodel::unified_digitized_data>(UDD_output_tag, event_record_);
+    const bool reuse_banks = event_record_.has(EH_output_tag) && event_record_.has(UDD_output_tag);
+    if (!reuse_banks)
+      {
+        // Other banks of the event record (in a dpp pipeline) are left untouched
+        if (event_record_.has(EH_output_tag)) event_record_.remove(EH_output_tag);
+        if (event_record_.has(UDD_output_tag)) event_record_.remove(UDD_output_tag);
+      }
+    auto & EH = reuse_banks ?
+      event_record_.grab<snemo::datamodel::event_header>(EH_output_tag)
+      : event_record_.add<snemo::datamodel::event_header>(EH_output_tag);
+    auto & UDD = reuse_banks ?
+      event_record_.grab<snemo::datamodel::unified_digitized_data>(UDD_output_tag)
+      : event_record_.add<snemo::datamodel::unified_digitized_data>(UDD_output_tag);
+    if (reuse_banks)
+      {
+        EH.clear();
+        UDD.invalidate();
+      }
+
+    // Fill Event Header based on RED attributes
+    EH.get_id().set_run_number(red_run_id);
+    EH.get_id().set_event_number(red_event_id);
+    EH.set_generation(snemo::datamodel::event_header::GENERATION_REAL);
+
+    // GO: we have to decide how we handle time and timestamp at Falaise level, commenting for now...
+    // EH.get_timestamp().set_seconds(1268644034);
+    // EH.get_timestamp().set_picoseconds(666);
+
+    // GO: we can add some additional properties to the Event Header
+    // EH.get_properties().store("simulation.bundle", "falaise");
+    // EH.get_properties().store("simulation.version", "0.1");
+    // EH.get_properties().store("author", std::string(getenv("USER")));
+
+
+    // Copy RED attributes to UDD attributes
+    UDD.set_run_id(red_run_id);
+    UDD.set_event_id(red_event_id);
+    UDD.set_reference_timestamp(red_.get_reference_time().get_ticks());
+    UDD.set_origin_trigger_ids(red_trigger_ids);
+    UDD.set_auxiliaries(red_.get_auxiliaries());
+
+    // Size the UDD hit collections once
+    UDD.grab_calorimeter_hits().reserve(red_calo_hits.size());
+    UDD.grab_tracker_hits().reserve(red_tracker_hits.size());
+
+    // Scan and copy RED calo digitized hit into UDD calo digitized hit:
+    for (std::size_t ihit = 0; ihit < red_calo_hits.size(); ihit++)
+      {
+        const snfee::data::calo_digitized_hit & red_calo_hit = red_calo_hits[ihit];
+        snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit = UDD.add_calorimeter_hit();
+        // Fields of the table (the wrong geom ID types are fixed there)
+        mapping::calo_hit_fields::copy(red_calo_hit, udd_calo_hit);
+        // Waveform is copied once, straight from the RED hit, in the requested mode
+        store_waveform(red_calo_hit, waveform_config_, udd_calo_hit);
+      } // end of for ihit
+
+    // Scan and copy RED tracker digitized hit into UDD tracker digitized hit:
+    for (std::size_t ihit = 0; ihit < red_tracker_hits.size(); ihit++)
+      {
+        const snfee::data::tracker_digitized_hit & red_tracker_hit = red_tracker_hits[ihit];
+        snemo::datamodel::tracker_digitized_hit & udd_tracker_hit = UDD.add_tracker_hit();
+        mapping::tracker_hit_fields::copy(red_tracker_hit, udd_tracker_hit);
+
+        // Do the loop on RED GG timestamps and convert them into UDD GG timestamps
+        const std::vector<snfee::data::tracker_digitized_hit::gg_times> & gg_timestamps_v = red_tracker_hit.get_times();
+        udd_tracker_hit.grab_times().reserve(gg_timestamps_v.size());
+        for (std::size_t iggtime = 0; iggtime < gg_timestamps_v.size(); iggtime++)
+          {
+            // Anode and cathode timestamps and RTD origin for backtracing
+            mapping::gg_times_fields::copy(gg_timestamps_v[iggtime], udd_tracker_hit.add_times());
+          } // end of iggtime
+
+      } // end for ihit
+
+    // red_.print_tree(std::clog);
+    // EH.tree_dump(std::clog, "Event header('EH'): ");
+    // UDD.tree_dump(std::clog, "Unified Digitized Data('UDD'): ");
+
+    return;
+  }
+
+} // namespace snredbridge
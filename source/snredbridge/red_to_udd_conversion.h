@@ -0,0 +1,41 @@
+/// \file snredbridge/red_to_udd_conversion.h
+/// Conversion of a SNFEE Raw Event Data (RED) into the Falaise Event Header (EH)
+/// and Unified Digitized Data (UDD) banks of a datatools::things event record
+
+#ifndef SNREDBRIDGE_RED_TO_UDD_CONVERSION_H
+#define SNREDBRIDGE_RED_TO_UDD_CONVERSION_H
+
+// Standard library:
+#include <cstddef>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/things.h>
+
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+// This project:
+#include <snredbridge/waveform_codec.h>
+
+namespace snredbridge {
+
+  /// Set the name and description of the event record for the event at a given position
+  void prepare_event_record(datatools::things & event_record_,
+                            const std::size_t record_index_);
+
+  /// Fill the "EH" and "UDD" banks of an event record from a RED event.
+  /// Banks already present in the event record are reset and reused, other
+  /// banks are left untouched. Waveforms are not copied if no_wf_ is set.
+  void do_red_to_udd_conversion(const snfee::data::raw_event_data & red_,
+                                datatools::things & event_record_,
+                                const bool no_wf_);
+
+  /// Same as above, the waveforms are stored in the UDD hits with the given mode
+  void do_red_to_udd_conversion(const snfee::data::raw_event_data & red_,
+                                datatools::things & event_record_,
+                                const waveform_config & waveform_config_);
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_RED_TO_UDD_CONVERSION_H
@@ -0,0 +1,455 @@
+// Ourselves:
+#include <snredbridge/red_udd_comparison.h>
+
+// Standard library:
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Third party:
+// - Falaise:
+#include <falaise/snemo/datamodels/event_header.h>
+#include <falaise/snemo/datamodels/unified_digitized_data.h>
+
+// This project:
+#include <snredbridge/field_mapping.h>
+#include <snredbridge/waveform_codec.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    // Position of the counters of field_mismatch_counters
+    const std::size_t EVENT_EH            = 0;
+    const std::size_t EVENT_UDD           = 1;
+    const std::size_t CALO_HITS           = 2;
+    const std::size_t CALO_MISSING_HIT    = 3;
+    const std::size_t CALO_FIELDS         = 4;
+    const std::size_t CALO_WAVEFORM       = CALO_FIELDS + mapping::calo_hit_fields::size;
+    const std::size_t TRACKER_HITS        = CALO_WAVEFORM + 1;
+    const std::size_t TRACKER_MISSING_HIT = TRACKER_HITS + 1;
+    const std::size_t TRACKER_FIELDS      = TRACKER_MISSING_HIT + 1;
+    const std::size_t TRACKER_GG_TIMES    = TRACKER_FIELDS + mapping::tracker_hit_fields::size;
+    const std::size_t GG_TIMES_FIELDS     = TRACKER_GG_TIMES + 1;
+    const std::size_t NUMBER_OF_FIELDS    = GG_TIMES_FIELDS + mapping::gg_times_fields::size;
+
+    template <class Fields>
+    void add_field_names(const std::string & prefix_, std::vector<std::string> & names_)
+    {
+      for (const char * const * name = Fields::names(); *name != nullptr; name++)
+        names_.push_back(prefix_ + *name);
+      return;
+    }
+
+    const std::vector<std::string> & field_names()
+    {
+      static const std::vector<std::string> names = []
+        {
+          std::vector<std::string> the_names = {"event.eh", "event.udd", "calo.hits", "calo.missing_hit"};
+          add_field_names<mapping::calo_hit_fields>("calo.", the_names);
+          the_names.push_back("calo.waveform");
+          the_names.push_back("tracker.hits");
+          the_names.push_back("tracker.missing_hit");
+          add_field_names<mapping::tracker_hit_fields>("tracker.", the_names);
+          the_names.push_back("tracker.gg_times");
+          add_field_names<mapping::gg_times_fields>("tracker.gg_times.", the_names);
+          return the_names;
+        }();
+      return names;
+    }
+
+    /// Key of a digitized hit in an event, refers to the geometry ID of the hit
+    struct hit_key
+    {
+      const geomtools::geom_id * geom_id;
+      int32_t hit_id;
+
+      bool operator==(const hit_key & other_) const
+      {
+        return hit_id == other_.hit_id && *geom_id == *other_.geom_id;
+      }
+    };
+
+    struct hit_key_hash
+    {
+      std::size_t operator()(const hit_key & key_) const
+      {
+        std::size_t hash = std::hash<int32_t>()(key_.hit_id);
+        auto combine = [&hash](const uint32_t value_)
+          {
+            hash ^= std::hash<uint32_t>()(value_) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+          };
+        combine(key_.geom_id->get_type());
+        for (uint32_t idepth = 0; idepth < key_.geom_id->get_depth(); idepth++)
+          combine(key_.geom_id->get(idepth));
+        return hash;
+      }
+    };
+
+    /// What a comparison records besides its result
+    struct comparison_context
+    {
+      std::size_t * counters = nullptr;                       ///< Counters of field_mismatch_counters
+      std::vector<field_difference> * differences = nullptr;
+      std::string hit;                                        ///< Hit being compared, for the differences
+      datatools::logger::priority logging = datatools::logger::PRIO_FATAL;
+
+      /// All the fields are compared, else the comparison stops at the first difference
+      bool is_full() const
+      {
+        return counters != nullptr || differences != nullptr;
+      }
+
+      /// Record a difference of a field which is not in the tables
+      void mismatch(const std::size_t field_, const std::string & red_value_, const std::string & udd_value_)
+      {
+        DT_LOG_DEBUG(logging, "Different field " << field_names()[field_]);
+        if (counters != nullptr) counters[field_]++;
+        if (differences != nullptr) differences->push_back(field_difference{field_names()[field_], hit, red_value_, udd_value_});
+      }
+    };
+
+    /// Compare the fields of a table, starting at position first_field_ of
+    /// the counters
+    template <class Fields, class Red, class Udd>
+    bool compare_fields(const Red & red_,
+                        const Udd & udd_,
+                        const std::size_t first_field_,
+                        const char * group_,
+                        comparison_context & context_)
+    {
+      if (!context_.is_full())
+        {
+          const std::size_t position = Fields::first_mismatch(red_, udd_);
+          if (position == Fields::size) return true;
+          DT_LOG_DEBUG(context_.logging, "Different field " << group_ << Fields::names()[position]);
+          return false;
+        }
+      bool is_equal = true;
+      if (context_.counters != nullptr)
+        is_equal = Fields::count_mismatches(red_, udd_, context_.counters + first_field_) == 0;
+      if (context_.differences != nullptr)
+        Fields::describe_mismatches(red_, udd_, [&](const char * name_, const std::string & red_value_, const std::string & udd_value_)
+          {
+            context_.differences->push_back(field_difference{group_ + std::string(name_), context_.hit, red_value_, udd_value_});
+            is_equal = false;
+          });
+      return is_equal;
+    }
+
+    bool compare_calo_hit_fields(const snfee::data::calo_digitized_hit & red_calo_hit_,
+                                 const snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit_,
+                                 bool no_wf_,
+                                 const waveform_config & waveform_config_,
+                                 comparison_context & context_)
+    {
+      // Cheap fields first, the waveform last
+      bool is_equal = compare_fields<mapping::calo_hit_fields>(red_calo_hit_, udd_calo_hit_, CALO_FIELDS, "calo.", context_);
+      if (!is_equal && !context_.is_full()) return false;
+      if (!no_wf_ && !compare_waveform(red_calo_hit_, udd_calo_hit_, waveform_config_))
+        {
+          context_.mismatch(CALO_WAVEFORM, std::to_string(red_calo_hit_.get_waveform().size()) + " samples", "different samples");
+          is_equal = false;
+        }
+      return is_equal;
+    }
+
+    bool compare_tracker_hit_fields(const snfee::data::tracker_digitized_hit & red_tracker_hit_,
+                                    const snemo::datamodel::tracker_digitized_hit & udd_tracker_hit_,
+                                    comparison_context & context_)
+    {
+      bool is_equal = compare_fields<mapping::tracker_hit_fields>(red_tracker_hit_, udd_tracker_hit_, TRACKER_FIELDS, "tracker.", context_);
+      if (!is_equal && !context_.is_full()) return false;
+
+      // GO Note/Warning, number of GG times are the same for now between RED and UDD but it might not be the case in a near future
+      // if we change the event builder algorithm and decide to remove the 'deduplication' for tracker hits.
+      // Not sure how it will impact RED format and then get propagated to UDD format
+      const std::vector<snfee::data::tracker_digitized_hit::gg_times> & red_gg_times = red_tracker_hit_.get_times();
+      const std::vector<snemo::datamodel::tracker_digitized_hit::gg_times> & udd_gg_times = udd_tracker_hit_.get_times();
+      if (red_gg_times.size() != udd_gg_times.size())
+        {
+          context_.mismatch(TRACKER_GG_TIMES, std::to_string(red_gg_times.size()), std::to_string(udd_gg_times.size()));
+          return false;
+        }
+
+      for (std::size_t iggtime = 0; iggtime < red_gg_times.size(); iggtime++)
+        {
+          if (!compare_fields<mapping::gg_times_fields>(red_gg_times[iggtime], udd_gg_times[iggtime],
+                                                        GG_TIMES_FIELDS, "tracker.gg_times.", context_))
+            {
+              is_equal = false;
+              if (!context_.is_full()) break;
+            }
+        }
+      return is_equal;
+    }
+
+    /// Label of a hit in the differences
+    template <class Hit>
+    std::string hit_label(const char * group_, const Hit & hit_, const uint32_t type_)
+    {
+      return std::string(group_) + " hit " + mapping::geom_id_text(hit_.get_geom_id(), type_) + " #" + std::to_string(hit_.get_hit_id());
+    }
+
+  } // namespace
+
+  field_mismatch_counters::field_mismatch_counters()
+    : _counters_(NUMBER_OF_FIELDS, 0)
+  {
+  }
+
+  std::size_t field_mismatch_counters::get_number_of_fields() const
+  {
+    return _counters_.size();
+  }
+
+  const std::string & field_mismatch_counters::get_field_name(const std::size_t field_) const
+  {
+    return field_names().at(field_);
+  }
+
+  std::size_t field_mismatch_counters::get_mismatches(const std::size_t field_) const
+  {
+    return _counters_.at(field_);
+  }
+
+  std::size_t field_mismatch_counters::get_total_mismatches() const
+  {
+    std::size_t total = 0;
+    for (const std::size_t counter : _counters_) total += counter;
+    return total;
+  }
+
+  void field_mismatch_counters::merge(const field_mismatch_counters & other_)
+  {
+    for (std::size_t ifield = 0; ifield < _counters_.size(); ifield++)
+      _counters_[ifield] += other_._counters_[ifield];
+    return;
+  }
+
+  std::size_t * field_mismatch_counters::grab_counters()
+  {
+    return _counters_.data();
+  }
+
+  bool compare_red_event_record(const snfee::data::raw_event_data & red_,
+                                const datatools::things & event_record_,
+                                const datatools::logger::priority & logging_,
+                                bool no_wf_,
+                                const waveform_config & waveform_config_,
+                                field_mismatch_counters * counters_,
+                                std::vector<field_difference> * differences_)
+  {
+    DT_LOG_DEBUG(logging_, "Entering compare_red_event_record.");
+    bool red_er_is_equivalent = false;
+    comparison_context context;
+    context.counters = counters_ ? counters_->grab_counters() : nullptr;
+    context.differences = differences_;
+    context.logging = logging_;
+    const bool is_full = context.is_full();
+    // event_record_.tree_dump(std::clog, "An event record:");
+
+    std::string EH_tag  = "EH";
+    std::string UDD_tag = "UDD";
+    auto & EH  = event_record_.get<snemo::datamodel::event_header>(EH_tag);
+    auto & UDD = event_record_.get<snemo::datamodel::unified_digitized_data>(UDD_tag);
+
+    // red_.print_tree(std::clog);
+    // EH.tree_dump(std::clog, "Event header('EH'): ");
+    // UDD.tree_dump(std::clog, "Unified Digitized Data('UDD'): ");
+
+    // Compare RED attributes with EH / UDD ones
+    bool is_event_header_equivalent = false;
+    // Check Run ID, Event ID and Generation
+    if (EH.get_id().get_run_number() == red_.get_run_id()
+        && EH.get_id().get_event_number() == red_.get_event_id()
+        && EH.is_real()) {
+      DT_LOG_DEBUG(logging_, "Corresponding EH is valid.");
+      is_event_header_equivalent = true;
+    }
+    else context.mismatch(EVENT_EH,
+                          std::to_string(red_.get_run_id()) + "/" + std::to_string(red_.get_event_id()),
+                          std::to_string(EH.get_id().get_run_number()) + "/" + std::to_string(EH.get_id().get_event_number())
+                          + (EH.is_real() ? "" : " (not real)"));
+
+    bool is_udd_global_equivalent = false;
+    if (UDD.get_run_id() == red_.get_run_id()
+        && UDD.get_event_id() == red_.get_event_id()
+        && UDD.get_reference_timestamp() == red_.get_reference_time().get_ticks()
+        && UDD.get_origin_trigger_ids() == red_.get_origin_trigger_ids()) {
+      DT_LOG_DEBUG(logging_, "Corresponding UDD global is valid.");
+      is_udd_global_equivalent = true;
+    }
+    else context.mismatch(EVENT_UDD,
+                          std::to_string(red_.get_run_id()) + "/" + std::to_string(red_.get_event_id())
+                          + " at " + std::to_string(red_.get_reference_time().get_ticks())
+                          + " from " + std::to_string(red_.get_origin_trigger_ids().size()) + " trigger(s)",
+                          std::to_string(UDD.get_run_id()) + "/" + std::to_string(UDD.get_event_id())
+                          + " at " + std::to_string(UDD.get_reference_timestamp())
+                          + " from " + std::to_string(UDD.get_origin_trigger_ids().size()) + " trigger(s)");
+
+    bool is_calo_equivalent = false;
+
+    // RED Digitized calo hits
+    const std::vector<snfee::data::calo_digitized_hit> & red_calo_hits = red_.get_calo_hits();
+
+    std::size_t number_red_calo_hits = red_calo_hits.size();
+    std::size_t number_udd_calo_hits = UDD.get_calorimeter_hits().size();
+
+    DT_LOG_DEBUG(logging_, "Number of RED calo hits = " << number_red_calo_hits);
+    DT_LOG_DEBUG(logging_, "Number of UDD calo hits = " << number_udd_calo_hits);
+
+    if (number_red_calo_hits != number_udd_calo_hits)
+      context.mismatch(CALO_HITS, std::to_string(number_red_calo_hits), std::to_string(number_udd_calo_hits));
+
+    // In a full comparison, the hits found in both events are compared anyway
+    if (number_red_calo_hits == number_udd_calo_hits || is_full) {
+      // Index the UDD calo hits by (geom ID, hit ID)
+      std::unordered_map<hit_key, const snemo::datamodel::calorimeter_digitized_hit *, hit_key_hash> udd_calo_index;
+      udd_calo_index.reserve(number_udd_calo_hits);
+      for (const auto & udd_calo_handle : UDD.get_calorimeter_hits()) {
+        const snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit = udd_calo_handle.get();
+        udd_calo_index.emplace(hit_key{&udd_calo_hit.get_geom_id(), udd_calo_hit.get_hit_id()}, &udd_calo_hit);
+      }
+
+      // Compare calo hit per attributes, stop at the first non equivalent one if not full
+      is_calo_equivalent = number_red_calo_hits == number_udd_calo_hits;
+      geomtools::geom_id converted_geom_id;
+      for (const snfee::data::calo_digitized_hit & red_calo_hit : red_calo_hits) {
+        // The UDD hits are looked for with the geometry ID type fixed by the conversion
+        const geomtools::geom_id * red_geom_id = &red_calo_hit.get_geom_id();
+        const uint32_t converted_type = mapping::converted_geom_type(red_geom_id->get_type());
+        if (converted_type != red_geom_id->get_type()) {
+          converted_geom_id = *red_geom_id;
+          converted_geom_id.set_type(converted_type);
+          red_geom_id = &converted_geom_id;
+        }
+        auto found = udd_calo_index.find(hit_key{red_geom_id, red_calo_hit.get_hit_id()});
+        if (differences_ != nullptr) context.hit = hit_label("calo", red_calo_hit, converted_type);
+        if (found == udd_calo_index.end()) {
+          context.mismatch(CALO_MISSING_HIT, "present", "missing");
+          is_calo_equivalent = false;
+        }
+        else if (!compare_calo_hit_fields(red_calo_hit, *found->second, no_wf_, waveform_config_, context)) {
+          is_calo_equivalent = false;
+        }
+        else DT_LOG_DEBUG(logging_, "Corresponding UDD calo is valid.");
+        if (!is_calo_equivalent && !is_full) break;
+      }
+
+    } // end of if n_red_calo == n_udd_calo
+
+    DT_LOG_DEBUG(logging_, "Calo is equivalent = " << is_calo_equivalent);
+
+    bool is_tracker_equivalent = false;
+
+    // RED Digitized tracker hits
+    const std::vector<snfee::data::tracker_digitized_hit> & red_tracker_hits = red_.get_tracker_hits();
+
+    std::size_t number_red_tracker_hits = red_tracker_hits.size();
+    std::size_t number_udd_tracker_hits = UDD.get_tracker_hits().size();
+
+    DT_LOG_DEBUG(logging_, "Number of RED tracker hits = " << number_red_tracker_hits);
+    DT_LOG_DEBUG(logging_, "Number of UDD tracker hits = " << number_udd_tracker_hits);
+
+    if (number_red_tracker_hits != number_udd_tracker_hits)
+      context.mismatch(TRACKER_HITS, std::to_string(number_red_tracker_hits), std::to_string(number_udd_tracker_hits));
+    context.hit.clear();
+
+    if (number_red_tracker_hits == number_udd_tracker_hits || is_full) {
+      // Index the UDD tracker hits by (geom ID, hit ID)
+      std::unordered_map<hit_key, const snemo::datamodel::tracker_digitized_hit *, hit_key_hash> udd_tracker_index;
+      udd_tracker_index.reserve(number_udd_tracker_hits);
+      for (const auto & udd_tracker_handle : UDD.get_tracker_hits()) {
+        const snemo::datamodel::tracker_digitized_hit & udd_tracker_hit = udd_tracker_handle.get();
+        udd_tracker_index.emplace(hit_key{&udd_tracker_hit.get_geom_id(), udd_tracker_hit.get_hit_id()}, &udd_tracker_hit);
+      }
+
+      // Compare tracker hit per attributes, stop at the first non equivalent one if not full
+      is_tracker_equivalent = number_red_tracker_hits == number_udd_tracker_hits;
+      for (const snfee::data::tracker_digitized_hit & red_tracker_hit : red_tracker_hits) {
+        auto found = udd_tracker_index.find(hit_key{&red_tracker_hit.get_geom_id(), red_tracker_hit.get_hit_id()});
+        if (differences_ != nullptr) context.hit = hit_label("tracker", red_tracker_hit, red_tracker_hit.get_geom_id().get_type());
+        if (found == udd_tracker_index.end()) {
+          context.mismatch(TRACKER_MISSING_HIT, "present", "missing");
+          is_tracker_equivalent = false;
+        }
+        else if (!compare_tracker_hit_fields(red_tracker_hit, *found->second, context)) {
+          is_tracker_equivalent = false;
+        }
+        else DT_LOG_DEBUG(logging_, "Corresponding UDD tracker is valid.");
+        if (!is_tracker_equivalent && !is_full) break;
+      }
+
+    } // end of if n_red_tracker == n_udd_tracker
+
+    DT_LOG_DEBUG(logging_, "Tracker is equivalent = " << is_tracker_equivalent);
+
+    DT_LOG_DEBUG(logging_, "EH is equivalent = " << is_event_header_equivalent
+                 << " UDD global is equivalent = " << is_udd_global_equivalent
+                 << " UDD Calo is equivalent = " << is_calo_equivalent
+                 << " UDD Tracker is equivalent = " << is_tracker_equivalent);
+    if (is_event_header_equivalent && is_udd_global_equivalent && is_calo_equivalent && is_tracker_equivalent) red_er_is_equivalent = true;
+    DT_LOG_DEBUG(logging_, "RED is equivalent to Event Record = " << red_er_is_equivalent);
+
+
+    return red_er_is_equivalent;
+  }
+
+
+  bool compare_red_event_summary(const snfee::data::raw_event_data & red_,
+                                 const datatools::things & event_record_,
+                                 const datatools::logger::priority & logging_,
+                                 field_mismatch_counters * counters_)
+  {
+    comparison_context context;
+    context.counters = counters_ ? counters_->grab_counters() : nullptr;
+    context.logging = logging_;
+    const std::string EH_tag  = "EH";
+    const std::string UDD_tag = "UDD";
+    auto & EH  = event_record_.get<snemo::datamodel::event_header>(EH_tag);
+    auto & UDD = event_record_.get<snemo::datamodel::unified_digitized_data>(UDD_tag);
+    bool is_equivalent = true;
+    if (EH.get_id().get_run_number() != red_.get_run_id() || EH.get_id().get_event_number() != red_.get_event_id())
+      {
+        context.mismatch(EVENT_EH, "", "");
+        is_equivalent = false;
+      }
+    if (UDD.get_run_id() != red_.get_run_id() || UDD.get_event_id() != red_.get_event_id())
+      {
+        context.mismatch(EVENT_UDD, "", "");
+        is_equivalent = false;
+      }
+    if (UDD.get_calorimeter_hits().size() != red_.get_calo_hits().size())
+      {
+        context.mismatch(CALO_HITS, "", "");
+        is_equivalent = false;
+      }
+    if (UDD.get_tracker_hits().size() != red_.get_tracker_hits().size())
+      {
+        context.mismatch(TRACKER_HITS, "", "");
+        is_equivalent = false;
+      }
+    return is_equivalent;
+  }
+
+
+  bool compare_calo_hit(const snfee::data::calo_digitized_hit & red_calo_hit_,
+                        const snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit_,
+                        bool no_wf_,
+                        const waveform_config & waveform_config_)
+  {
+    comparison_context context;
+    return compare_calo_hit_fields(red_calo_hit_, udd_calo_hit_, no_wf_, waveform_config_, context);
+  }
+
+
+  bool compare_tracker_hit(const snfee::data::tracker_digitized_hit & red_tracker_hit_,
+                           const snemo::datamodel::tracker_digitized_hit & udd_tracker_hit_)
+  {
+    comparison_context context;
+    return compare_tracker_hit_fields(red_tracker_hit_, udd_tracker_hit_, context);
+  }
+
+} // namespace snredbridge
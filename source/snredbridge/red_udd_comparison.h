@@ -0,0 +1,117 @@
+/// \file snredbridge/red_udd_comparison.h
+/// Field by field comparison of a SNFEE RED event with the EH/UDD banks of
+/// the event record converted from it
+
+#ifndef SNREDBRIDGE_RED_UDD_COMPARISON_H
+#define SNREDBRIDGE_RED_UDD_COMPARISON_H
+
+// Standard library:
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/logger.h>
+#include <bayeux/datatools/things.h>
+
+// - Falaise:
+#include <falaise/snemo/datamodels/calorimeter_digitized_hit.h>
+#include <falaise/snemo/datamodels/tracker_digitized_hit.h>
+
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+// This project:
+#include <snredbridge/waveform_codec.h>
+
+namespace snredbridge {
+
+  /// \brief Number of mismatches of each field of the events
+  ///
+  /// The fields are named after the tables of snredbridge/field_mapping.h,
+  /// prefixed with their group ("calo.fcr", "tracker.gg_times.top_cathode_time"...),
+  /// plus the checks which are not in the tables:
+  /// - "event.eh" and "event.udd": event header and UDD global attributes,
+  /// - "calo.hits" and "tracker.hits": different numbers of hits,
+  /// - "calo.missing_hit" and "tracker.missing_hit": RED hits without UDD hit,
+  /// - "calo.waveform": waveform in the storage mode of the UDD hit,
+  /// - "tracker.gg_times": different numbers of GG times.
+  class field_mismatch_counters
+  {
+  public:
+
+    /// All the counters are zero
+    field_mismatch_counters();
+
+    /// Number of fields
+    std::size_t get_number_of_fields() const;
+
+    /// Name of a field
+    const std::string & get_field_name(const std::size_t field_) const;
+
+    /// Number of mismatches of a field
+    std::size_t get_mismatches(const std::size_t field_) const;
+
+    /// Number of mismatches of all the fields
+    std::size_t get_total_mismatches() const;
+
+    /// Add the counters of another instance
+    void merge(const field_mismatch_counters & other_);
+
+    /// Counters of all the fields, in the order of the names
+    std::size_t * grab_counters();
+
+  private:
+
+    std::vector<std::size_t> _counters_;
+  };
+
+  /// Difference of a field between a RED event and its event record
+  struct field_difference
+  {
+    std::string field;     ///< Name of the field, as in field_mismatch_counters
+    std::string hit;       ///< Hit of the RED event, empty for the event fields
+    std::string red_value;
+    std::string udd_value;
+  };
+
+  /// Check that the "EH" and "UDD" banks of an event record are equivalent to
+  /// a RED event. Waveforms are not compared if no_wf_ is set, else with the
+  /// roi margins of waveform_config_ (see compare_waveform()).
+  ///
+  /// Without counters nor differences, the comparison stops at the first
+  /// different field, logged at debug level. Else all the fields of the event
+  /// are compared, each different one is counted and/or described in the
+  /// differences.
+  bool compare_red_event_record(const snfee::data::raw_event_data & red_,
+                                const datatools::things & event_record_,
+                                const datatools::logger::priority & logging_,
+                                bool no_wf_,
+                                const waveform_config & waveform_config_,
+                                field_mismatch_counters * counters_ = nullptr,
+                                std::vector<field_difference> * differences_ = nullptr);
+
+  /// Cheap check that an event record matches a RED event: event IDs of the
+  /// "EH" and "UDD" banks and numbers of calo and tracker hits. The hits and
+  /// their waveforms are not looked at. Mismatches are counted if counters_
+  /// is set.
+  bool compare_red_event_summary(const snfee::data::raw_event_data & red_,
+                                 const datatools::things & event_record_,
+                                 const datatools::logger::priority & logging_,
+                                 field_mismatch_counters * counters_ = nullptr);
+
+  /// Check that a UDD calorimeter hit is equivalent to a RED calorimeter hit.
+  /// The waveform is checked in the storage mode of the UDD hit, see compare_waveform().
+  bool compare_calo_hit(const snfee::data::calo_digitized_hit & red_calo_hit_,
+                        const snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit_,
+                        bool no_wf_,
+                        const waveform_config & waveform_config_);
+
+  /// Check that a UDD tracker hit and its GG times are equivalent to a RED tracker hit
+  bool compare_tracker_hit(const snfee::data::tracker_digitized_hit & red_tracker_hit_,
+                           const snemo::datamodel::tracker_digitized_hit & udd_tracker_hit_);
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_RED_UDD_COMPARISON_H
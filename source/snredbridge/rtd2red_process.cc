@@ -0,0 +1,223 @@
+// Ourselves:
+#include <snredbridge/rtd2red_process.h>
+
+// Standard library:
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// System:
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+extern char ** environ;
+
+namespace snredbridge {
+
+  namespace {
+
+    /// Time left to the event builder to exit by itself before it is terminated
+    const std::chrono::seconds STOP_GRACE_TIME(2);
+
+    std::string replace_all(std::string text_, const std::string & from_, const std::string & to_)
+    {
+      std::size_t position = 0;
+      while ((position = text_.find(from_, position)) != std::string::npos)
+        {
+          text_.replace(position, from_.size(), to_);
+          position += to_.size();
+        }
+      return text_;
+    }
+
+  } // namespace
+
+  rtd2red_process::rtd2red_process(const config_type & config_)
+    : _config_(config_)
+  {
+    DT_THROW_IF(_config_.command.empty(), std::logic_error, "Missing event builder command!");
+    const bool archive = !_config_.archive_filename.empty();
+    DT_THROW_IF(archive && !ends_with(_config_.archive_filename, ".data.gz"), std::logic_error,
+                "RED archive file '" << _config_.archive_filename << "' must have the '.data.gz' extension!");
+
+    try {
+      // The ".data" extension selects the uncompressed portable binary archive
+      _red_pipe_ = _pipes_.make_pipe("red.data", "RED pipe");
+      _builder_pipe_ = archive ? _pipes_.make_pipe("rtd2red.data", "RED pipe") : _red_pipe_;
+
+      // The keeper is a writer of the builder pipe until the event builder
+      // exits: its reader does not see the end of the stream before, even if
+      // the event builder opens its output late or never. Opened for reading
+      // and writing, it does not wait for the other end.
+      _keeper_fd_ = ::open(_builder_pipe_.c_str(), O_RDWR | O_CLOEXEC);
+      DT_THROW_IF(_keeper_fd_ < 0, std::runtime_error,
+                  "Cannot open the RED pipe '" << _builder_pipe_ << "': " << std::strerror(errno));
+      if (archive)
+        {
+          _pump_read_fd_ = ::open(_builder_pipe_.c_str(), O_RDONLY | O_CLOEXEC);
+          DT_THROW_IF(_pump_read_fd_ < 0, std::runtime_error,
+                      "Cannot open the RED pipe '" << _builder_pipe_ << "': " << std::strerror(errno));
+          _archive_.reset(new parallel_gzip_writer(_config_.archive_filename,
+                                                   _config_.archive_level,
+                                                   _config_.archive_threads));
+        }
+
+      const std::string command = replace_all(_config_.command, "%RED%", _builder_pipe_);
+      std::vector<std::string> environment;
+      for (char ** variable = environ; *variable != nullptr; ++variable)
+        {
+          if (std::strncmp(*variable, "SNREDBRIDGE_RED_PIPE=", 21) == 0) continue;
+          environment.push_back(*variable);
+        }
+      environment.push_back("SNREDBRIDGE_RED_PIPE=" + _builder_pipe_);
+      std::vector<char *> envp;
+      for (std::string & variable : environment) envp.push_back(&variable[0]);
+      envp.push_back(nullptr);
+      std::string arg0 = "sh";
+      std::string arg1 = "-c";
+      std::string arg2 = command;
+      char * argv[] = {&arg0[0], &arg1[0], &arg2[0], nullptr};
+      const int status = ::posix_spawn(&_pid_, "/bin/sh", nullptr, nullptr, argv, envp.data());
+      DT_THROW_IF(status != 0, std::runtime_error,
+                  "Cannot start the event builder '" << command << "': " << std::strerror(status));
+    }
+    catch (...) {
+      _cleanup_();
+      throw;
+    }
+
+    _watcher_thread_ = std::thread(&rtd2red_process::_watch_process_, this);
+    if (archive) _pump_thread_ = std::thread(&rtd2red_process::_pump_stream_, this);
+  }
+
+  rtd2red_process::~rtd2red_process()
+  {
+    try {
+      wait();
+    }
+    catch (...) {
+    }
+  }
+
+  const std::string & rtd2red_process::get_red_filename() const
+  {
+    return _red_pipe_;
+  }
+
+  void rtd2red_process::wait()
+  {
+    if (_waited_) return;
+    _waited_ = true;
+
+    // The conversion is done with the stream: an event builder still running
+    // after a short while has more records than the conversion wanted
+    const auto deadline = std::chrono::steady_clock::now() + STOP_GRACE_TIME;
+    while (!_exited_ && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    if (!_exited_)
+      {
+        ::kill(_pid_, SIGTERM);
+        _stopped_ = true;
+      }
+    if (_watcher_thread_.joinable()) _watcher_thread_.join();
+    _release_pump_ = true;
+    if (_pump_thread_.joinable()) _pump_thread_.join();
+
+    std::exception_ptr error = _pump_error_;
+    try {
+      if (_archive_) _archive_->close();
+    }
+    catch (...) {
+      if (!error) error = std::current_exception();
+    }
+    _archive_.reset();
+    _cleanup_();
+    if (error) std::rethrow_exception(error);
+    if (_stopped_) return;
+    DT_THROW_IF(WIFSIGNALED(_exit_status_), std::runtime_error,
+                "Event builder killed by signal " << WTERMSIG(_exit_status_) << "!");
+    DT_THROW_IF(WIFEXITED(_exit_status_) && WEXITSTATUS(_exit_status_) != 0, std::runtime_error,
+                "Event builder failed with exit status " << WEXITSTATUS(_exit_status_) << "!");
+    return;
+  }
+
+  bool rtd2red_process::was_stopped() const
+  {
+    return _stopped_;
+  }
+
+  void rtd2red_process::_watch_process_()
+  {
+    int status = 0;
+    while (::waitpid(_pid_, &status, 0) < 0)
+      {
+        if (errno == EINTR) continue;
+        status = 0;
+        break;
+      }
+    _exit_status_ = status;
+    _exited_ = true;
+    // The reader of the builder pipe now reaches the end of the stream
+    ::close(_keeper_fd_);
+    _keeper_fd_ = -1;
+    return;
+  }
+
+  void rtd2red_process::_pump_stream_()
+  {
+    // The conversion may stop reading before the end of the stream, or
+    // never open its pipe: the pump then only feeds the archive
+    block_sigpipe();
+    int red_fd = open_pipe_writer(_red_pipe_, _release_pump_);
+
+    // The archive gets the whole stream, even after the conversion stopped
+    std::vector<char> buffer(1024 * 1024);
+    while (true)
+      {
+        const ssize_t size = ::read(_pump_read_fd_, buffer.data(), buffer.size());
+        if (size == 0) break;
+        if (size < 0)
+          {
+            if (errno == EINTR) continue;
+            if (!_pump_error_)
+              _pump_error_ = std::make_exception_ptr(std::runtime_error("Cannot read the RED pipe!"));
+            break;
+          }
+        if (red_fd >= 0 && !write_all(red_fd, buffer.data(), size))
+          {
+            ::close(red_fd);
+            red_fd = -1;
+          }
+        // After an error the pipe is still drained, so that the event builder never blocks
+        if (_pump_error_) continue;
+        try {
+          _archive_->write(buffer.data(), size);
+        }
+        catch (...) {
+          _pump_error_ = std::current_exception();
+        }
+      }
+    if (red_fd >= 0) ::close(red_fd);
+    return;
+  }
+
+  void rtd2red_process::_cleanup_()
+  {
+    if (_keeper_fd_ >= 0) ::close(_keeper_fd_);
+    _keeper_fd_ = -1;
+    if (_pump_read_fd_ >= 0) ::close(_pump_read_fd_);
+    _pump_read_fd_ = -1;
+    _pipes_.remove();
+    return;
+  }
+
+} // namespace snredbridge
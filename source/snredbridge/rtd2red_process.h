@@ -0,0 +1,99 @@
+/// \file snredbridge/rtd2red_process.h
+/// SNFEE event builder (RTD to RED) running beside the conversion and
+/// streaming its RED records through a named pipe
+
+#ifndef SNREDBRIDGE_RTD2RED_PROCESS_H
+#define SNREDBRIDGE_RTD2RED_PROCESS_H
+
+// Standard library:
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+
+// System:
+#include <sys/types.h>
+
+// This project:
+#include <snredbridge/named_pipe.h>
+#include <snredbridge/parallel_gzip_writer.h>
+
+namespace snredbridge {
+
+  /// \brief Event builder writing its RED records into a named pipe
+  ///
+  /// The command (typically snfee-rtd2red with its configuration) is run by
+  /// /bin/sh. It must write its RED output file into the pipe, whose path
+  /// replaces "%RED%" in the command and is also given by the environment
+  /// variable SNREDBRIDGE_RED_PIPE. The pipe has the ".data" extension, so
+  /// that the RED records go through it uncompressed: the event builder does
+  /// not deflate them and the conversion does not inflate them.
+  ///
+  /// The conversion reads the RED records from get_red_filename(). For
+  /// archival, a thread can copy the stream into a gzip compressed RED file
+  /// on its way to the conversion.
+  class rtd2red_process
+  {
+  public:
+
+    struct config_type
+    {
+      std::string command;               ///< Command of the event builder
+      std::string archive_filename;      ///< RED file (".data.gz") keeping a copy of the stream (empty: none)
+      int archive_level = -1;            ///< Gzip compression level of the archive
+      unsigned int archive_threads = 1;  ///< Gzip compression threads of the archive
+    };
+
+    /// Create the pipes and start the event builder
+    explicit rtd2red_process(const config_type & config_);
+
+    /// Stop the event builder if it is still running
+    ~rtd2red_process();
+
+    rtd2red_process(const rtd2red_process &) = delete;
+    rtd2red_process & operator=(const rtd2red_process &) = delete;
+
+    /// RED file to read the records from (a named pipe)
+    const std::string & get_red_filename() const;
+
+    /// Wait for the end of the event builder, once the RED records have been
+    /// read. An event builder still running (the conversion stopped before
+    /// the end of the stream) is terminated. Throws if the event builder or
+    /// the archive failed.
+    void wait();
+
+    /// Check if the event builder was terminated by wait()
+    bool was_stopped() const;
+
+  private:
+
+    void _watch_process_();
+
+    void _pump_stream_();
+
+    void _cleanup_();
+
+    config_type _config_;
+    temporary_pipes _pipes_;
+    std::string _builder_pipe_;    ///< Pipe written by the event builder
+    std::string _red_pipe_;        ///< Pipe read by the conversion (the builder pipe without archive)
+    int _keeper_fd_ = -1;          ///< Builder pipe end kept open until the event builder exits
+    pid_t _pid_ = -1;
+    std::thread _watcher_thread_;
+    std::atomic<bool> _exited_{false};
+    int _exit_status_ = 0;
+    bool _stopped_ = false;
+    bool _waited_ = false;
+
+    // Archive
+    int _pump_read_fd_ = -1;       ///< Builder pipe end read by the pump
+    std::unique_ptr<parallel_gzip_writer> _archive_;
+    std::thread _pump_thread_;
+    std::atomic<bool> _release_pump_{false}; ///< The conversion will not open its pipe anymore
+    std::exception_ptr _pump_error_;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_RTD2RED_PROCESS_H
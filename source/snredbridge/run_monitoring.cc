@@ -0,0 +1,126 @@
+// Ourselves:
+#include <snredbridge/run_monitoring.h>
+
+// Standard library:
+#include <iomanip>
+#include <sstream>
+
+// System:
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+namespace snredbridge {
+
+  void stage_timer::start()
+  {
+    _start_ = clock_type::now();
+    return;
+  }
+
+  void stage_timer::stop()
+  {
+    _total_ += clock_type::now() - _start_;
+    _calls_++;
+    return;
+  }
+
+  void stage_timer::merge(const stage_timer & other_)
+  {
+    _total_ += other_._total_;
+    _calls_ += other_._calls_;
+    return;
+  }
+
+  double stage_timer::get_seconds() const
+  {
+    return std::chrono::duration<double>(_total_).count();
+  }
+
+  std::size_t stage_timer::get_calls() const
+  {
+    return _calls_;
+  }
+
+  // ---------------------------------------------------------------------
+
+  stage_timer_guard::stage_timer_guard(stage_timer & timer_)
+    : _timer_(timer_)
+  {
+    _timer_.start();
+    return;
+  }
+
+  stage_timer_guard::~stage_timer_guard()
+  {
+    _timer_.stop();
+    return;
+  }
+
+  // ---------------------------------------------------------------------
+
+  progress_reporter::progress_reporter(const double interval_seconds_,
+                                       const std::size_t expected_events_,
+                                       std::ostream & out_)
+    : _interval_seconds_(interval_seconds_)
+    , _expected_events_(expected_events_)
+    , _out_(out_)
+    , _start_(clock_type::now())
+    , _last_report_(_start_)
+  {
+    return;
+  }
+
+  void progress_reporter::set_label(const std::string & label_)
+  {
+    _label_ = label_;
+    return;
+  }
+
+  void progress_reporter::update(const std::size_t events_)
+  {
+    if (_interval_seconds_ <= 0.0 || events_ % 64 != 0) return;
+    const clock_type::time_point now = clock_type::now();
+    if (std::chrono::duration<double>(now - _last_report_).count() < _interval_seconds_) return;
+    _last_report_ = now;
+
+    const double elapsed = std::chrono::duration<double>(now - _start_).count();
+    const double rate = elapsed > 0.0 ? events_ / elapsed : 0.0;
+    std::ostringstream report;
+    report << "Progress";
+    if (!_label_.empty()) report << " [" << _label_ << "]";
+    report << " : " << events_ << " event(s) in " << std::fixed << std::setprecision(0) << elapsed << " s, "
+           << std::setprecision(1) << rate << " event(s)/s";
+    if (_expected_events_ > 0 && rate > 0.0 && events_ <= _expected_events_)
+      {
+        const double eta = (_expected_events_ - events_) / rate;
+        report << ", " << std::setprecision(1) << 100.0 * events_ / _expected_events_ << " %"
+               << ", ETA " << std::setprecision(0) << eta << " s";
+      }
+    report << '\n';
+    _out_ << report.str() << std::flush;
+    return;
+  }
+
+  double progress_reporter::get_elapsed_seconds() const
+  {
+    return std::chrono::duration<double>(clock_type::now() - _start_).count();
+  }
+
+  // ---------------------------------------------------------------------
+
+  std::size_t get_peak_rss_kb()
+  {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    // Linux reports the maximum resident set size in kilobytes
+    return usage.ru_maxrss;
+  }
+
+  std::size_t get_file_size(const std::string & filename_)
+  {
+    struct stat file_status;
+    if (stat(filename_.c_str(), &file_status) != 0) return 0;
+    return file_status.st_size;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,107 @@
+/// \file snredbridge/run_monitoring.h
+/// Low overhead timers, progress report and process resources for the
+/// monitoring of long conversion or validation runs
+
+#ifndef SNREDBRIDGE_RUN_MONITORING_H
+#define SNREDBRIDGE_RUN_MONITORING_H
+
+// Standard library:
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+namespace snredbridge {
+
+  /// Accumulated wall clock time spent in a processing stage
+  class stage_timer
+  {
+  public:
+
+    typedef std::chrono::steady_clock clock_type;
+
+    /// Start a measurement
+    void start();
+
+    /// Stop the current measurement and add it to the total
+    void stop();
+
+    /// Add the measurements of another timer (for example from another thread)
+    void merge(const stage_timer & other_);
+
+    /// Total time in seconds
+    double get_seconds() const;
+
+    /// Number of measurements
+    std::size_t get_calls() const;
+
+  private:
+
+    clock_type::time_point _start_;
+    clock_type::duration _total_ = clock_type::duration::zero();
+    std::size_t _calls_ = 0;
+  };
+
+  /// Measure the lifetime of a scope with a stage timer
+  class stage_timer_guard
+  {
+  public:
+
+    explicit stage_timer_guard(stage_timer & timer_);
+    ~stage_timer_guard();
+
+    stage_timer_guard(const stage_timer_guard &) = delete;
+    stage_timer_guard & operator=(const stage_timer_guard &) = delete;
+
+  private:
+
+    stage_timer & _timer_;
+  };
+
+  /// \brief Periodic progress report
+  ///
+  /// Prints the number of processed events, the event rate and, if the
+  /// expected number of events is known, an estimate of the remaining time.
+  /// Checking if a report is due only costs a clock read every 64 events.
+  /// Each report is written at once, so that the reports of several
+  /// reporters running in parallel do not mix.
+  class progress_reporter
+  {
+  public:
+
+    /// Constructor with the time between two reports (0: no report) and the
+    /// expected number of events (0: unknown)
+    progress_reporter(const double interval_seconds_,
+                      const std::size_t expected_events_,
+                      std::ostream & out_ = std::cout);
+
+    /// Set a label printed in each report, for example the input file
+    void set_label(const std::string & label_);
+
+    /// Update the number of processed events, print a report if one is due
+    void update(const std::size_t events_);
+
+    /// Elapsed time since the construction in seconds
+    double get_elapsed_seconds() const;
+
+  private:
+
+    typedef std::chrono::steady_clock clock_type;
+
+    double _interval_seconds_;
+    std::size_t _expected_events_;
+    std::string _label_;
+    std::ostream & _out_;
+    clock_type::time_point _start_;
+    clock_type::time_point _last_report_;
+  };
+
+  /// Peak resident set size of the process in kilobytes
+  std::size_t get_peak_rss_kb();
+
+  /// Size of a file in bytes, 0 if the file does not exist
+  std::size_t get_file_size(const std::string & filename_);
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_RUN_MONITORING_H
@@ -0,0 +1,332 @@
+// Ourselves:
+#include <snredbridge/run_statistics.h>
+
+// Standard library:
+#include <algorithm>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+// This project:
+#include <snredbridge/field_mapping.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    unsigned long long count(const std::size_t value_)
+    {
+      return static_cast<unsigned long long>(value_);
+    }
+
+    /// Frequency of a clock (Hz), 0 if unknown
+    double clock_frequency(const snfee::data::clock_type clock_)
+    {
+      switch (clock_)
+        {
+        case snfee::data::CLOCK_40MHz: return 40.0e6;
+        case snfee::data::CLOCK_80MHz: return 80.0e6;
+        case snfee::data::CLOCK_160MHz: return 160.0e6;
+        default: return 0.0;
+        }
+    }
+
+    /// Geometry ID of a channel, with its UDD type
+    std::string channel_text(const geomtools::geom_id & geom_id_)
+    {
+      return mapping::geom_id_text(geom_id_, mapping::converted_geom_type(geom_id_.get_type()));
+    }
+
+  } // namespace
+
+  histogram_binning::histogram_binning(const double low_,
+                                       const double high_,
+                                       const std::size_t bins_)
+    : low(low_)
+    , high(high_)
+    , bins(bins_)
+  {
+  }
+
+  bool histogram_binning::operator==(const histogram_binning & other_) const
+  {
+    return low == other_.low && high == other_.high && bins == other_.bins;
+  }
+
+  fixed_histogram::fixed_histogram(const histogram_binning & binning_)
+    : _binning_(binning_)
+  {
+    DT_THROW_IF(_binning_.bins == 0 || !(_binning_.high > _binning_.low), std::logic_error,
+                "Invalid histogram binning [" << _binning_.low << ", " << _binning_.high << ") in "
+                << _binning_.bins << " bins!");
+    _scale_ = _binning_.bins / (_binning_.high - _binning_.low);
+    _bins_.assign(_binning_.bins, 0);
+  }
+
+  void fixed_histogram::fill(const double value_)
+  {
+    if (value_ < _binning_.low) _underflow_++;
+    else if (value_ >= _binning_.high) _overflow_++;
+    else
+      {
+        // Rounding may put a value just below the upper edge past the last bin
+        const std::size_t bin = static_cast<std::size_t>((value_ - _binning_.low) * _scale_);
+        _bins_[std::min(bin, _binning_.bins - 1)]++;
+      }
+    return;
+  }
+
+  void fixed_histogram::merge(const fixed_histogram & other_)
+  {
+    DT_THROW_IF(!(_binning_ == other_._binning_), std::logic_error, "Cannot merge histograms with different binnings!");
+    for (std::size_t ibin = 0; ibin < _bins_.size(); ibin++) _bins_[ibin] += other_._bins_[ibin];
+    _underflow_ += other_._underflow_;
+    _overflow_ += other_._overflow_;
+    return;
+  }
+
+  const histogram_binning & fixed_histogram::get_binning() const
+  {
+    return _binning_;
+  }
+
+  const std::vector<std::size_t> & fixed_histogram::get_bins() const
+  {
+    return _bins_;
+  }
+
+  std::size_t fixed_histogram::get_underflow() const
+  {
+    return _underflow_;
+  }
+
+  std::size_t fixed_histogram::get_overflow() const
+  {
+    return _overflow_;
+  }
+
+  std::size_t fixed_histogram::get_entries() const
+  {
+    std::size_t entries = _underflow_ + _overflow_;
+    for (const std::size_t bin : _bins_) entries += bin;
+    return entries;
+  }
+
+  void fixed_histogram::write(json_writer & json_, const std::string & key_) const
+  {
+    json_.begin_object(key_);
+    json_.value("low", _binning_.low);
+    json_.value("high", _binning_.high);
+    json_.begin_array("bins");
+    for (const std::size_t bin : _bins_) json_.value("", count(bin));
+    json_.end_array();
+    json_.value("underflow", count(_underflow_));
+    json_.value("overflow", count(_overflow_));
+    json_.end_object();
+    return;
+  }
+
+  run_statistics::run_statistics()
+    : run_statistics(config_type())
+  {
+  }
+
+  run_statistics::run_statistics(const config_type & config_)
+    : _config_(config_)
+    , _calo_multiplicity_(config_.calo_multiplicity)
+    , _tracker_multiplicity_(config_.tracker_multiplicity)
+    , _lt_trigger_gap_(config_.lt_trigger_gap)
+  {
+  }
+
+  void run_statistics::fill(const snfee::data::raw_event_data & red_)
+  {
+    const int64_t ticks = red_.get_reference_time().get_ticks();
+    if (_events_ == 0) _first_ticks_ = _last_ticks_ = ticks;
+    _first_ticks_ = std::min(_first_ticks_, ticks);
+    _last_ticks_ = std::max(_last_ticks_, ticks);
+    if (_clock_ == snfee::data::CLOCK_UNDEF) _clock_ = red_.get_reference_time().get_clock();
+    _events_++;
+
+    const std::vector<snfee::data::calo_digitized_hit> & calo_hits = red_.get_calo_hits();
+    _calo_hits_ += calo_hits.size();
+    _calo_multiplicity_.fill(calo_hits.size());
+    for (const snfee::data::calo_digitized_hit & calo_hit : calo_hits)
+      {
+        calo_channel & channel = _calo_channel_(calo_hit.get_geom_id());
+        channel.hits++;
+        if (calo_hit.is_high_threshold()) channel.high_threshold_hits++;
+        channel.peak_amplitude.fill(calo_hit.get_fwmeas_peak_amplitude());
+        channel.charge.fill(calo_hit.get_fwmeas_charge());
+      }
+
+    const std::vector<snfee::data::tracker_digitized_hit> & tracker_hits = red_.get_tracker_hits();
+    _tracker_hits_ += tracker_hits.size();
+    _tracker_multiplicity_.fill(tracker_hits.size());
+    for (const snfee::data::tracker_digitized_hit & tracker_hit : tracker_hits)
+      {
+        tracker_channel & channel = _tracker_channels_[tracker_hit.get_geom_id()];
+        channel.hits++;
+        channel.gg_times += tracker_hit.get_times().size();
+      }
+    return;
+  }
+
+  void run_statistics::fill_sequence(const snfee::data::raw_event_data & red_)
+  {
+    for (const snfee::data::calo_digitized_hit & calo_hit : red_.get_calo_hits())
+      {
+        calo_channel & channel = _calo_channel_(calo_hit.get_geom_id());
+        const uint16_t counter = calo_hit.get_lt_trigger_counter();
+        if (channel.has_lt_counter)
+          {
+            // The 16 bit counter wraps around
+            const uint16_t gap = counter - channel.last_lt_counter;
+            channel.lt_gaps++;
+            if (gap > 1) channel.lt_missed += gap - 1;
+            _lt_trigger_gap_.fill(gap);
+          }
+        channel.has_lt_counter = true;
+        channel.last_lt_counter = counter;
+      }
+    return;
+  }
+
+  void run_statistics::merge(const run_statistics & other_)
+  {
+    if (other_._events_ > 0)
+      {
+        if (_events_ == 0)
+          {
+            _first_ticks_ = other_._first_ticks_;
+            _last_ticks_ = other_._last_ticks_;
+          }
+        _first_ticks_ = std::min(_first_ticks_, other_._first_ticks_);
+        _last_ticks_ = std::max(_last_ticks_, other_._last_ticks_);
+        if (_clock_ == snfee::data::CLOCK_UNDEF) _clock_ = other_._clock_;
+      }
+    _events_ += other_._events_;
+    _calo_hits_ += other_._calo_hits_;
+    _tracker_hits_ += other_._tracker_hits_;
+    _calo_multiplicity_.merge(other_._calo_multiplicity_);
+    _tracker_multiplicity_.merge(other_._tracker_multiplicity_);
+    _lt_trigger_gap_.merge(other_._lt_trigger_gap_);
+    for (const auto & entry : other_._calo_channels_)
+      {
+        calo_channel & channel = _calo_channel_(entry.first);
+        channel.hits += entry.second.hits;
+        channel.high_threshold_hits += entry.second.high_threshold_hits;
+        channel.peak_amplitude.merge(entry.second.peak_amplitude);
+        channel.charge.merge(entry.second.charge);
+        channel.lt_gaps += entry.second.lt_gaps;
+        channel.lt_missed += entry.second.lt_missed;
+      }
+    for (const auto & entry : other_._tracker_channels_)
+      {
+        tracker_channel & channel = _tracker_channels_[entry.first];
+        channel.hits += entry.second.hits;
+        channel.gg_times += entry.second.gg_times;
+      }
+    return;
+  }
+
+  bool run_statistics::is_empty() const
+  {
+    return _events_ == 0;
+  }
+
+  std::size_t run_statistics::get_number_of_events() const
+  {
+    return _events_;
+  }
+
+  double run_statistics::get_duration() const
+  {
+    const double frequency = clock_frequency(_clock_);
+    if (frequency <= 0.0) return 0.0;
+    return (_last_ticks_ - _first_ticks_) / frequency;
+  }
+
+  const run_statistics::calo_channel_map & run_statistics::get_calo_channels() const
+  {
+    return _calo_channels_;
+  }
+
+  const run_statistics::tracker_channel_map & run_statistics::get_tracker_channels() const
+  {
+    return _tracker_channels_;
+  }
+
+  const run_statistics::config_type & run_statistics::get_config() const
+  {
+    return _config_;
+  }
+
+  void run_statistics::write(json_writer & json_) const
+  {
+    const double duration = get_duration();
+    json_.value("events", count(_events_));
+    json_.value("calo_hits", count(_calo_hits_));
+    json_.value("tracker_hits", count(_tracker_hits_));
+    json_.value("duration", duration);
+    _calo_multiplicity_.write(json_, "calo_multiplicity");
+    _tracker_multiplicity_.write(json_, "tracker_multiplicity");
+    _lt_trigger_gap_.write(json_, "lt_trigger_gap");
+
+    // Spectra summed over the channels
+    fixed_histogram peak_amplitude(_config_.peak_amplitude);
+    fixed_histogram charge(_config_.charge);
+    for (const auto & entry : _calo_channels_)
+      {
+        peak_amplitude.merge(entry.second.peak_amplitude);
+        charge.merge(entry.second.charge);
+      }
+    peak_amplitude.write(json_, "peak_amplitude");
+    charge.write(json_, "charge");
+
+    json_.begin_array("calo_channels");
+    for (const auto & entry : _calo_channels_)
+      {
+        const calo_channel & channel = entry.second;
+        if (channel.hits == 0) continue;
+        json_.begin_object();
+        json_.value("geom_id", channel_text(entry.first));
+        json_.value("hits", count(channel.hits));
+        if (duration > 0.0) json_.value("rate", channel.hits / duration);
+        json_.value("high_threshold_fraction", double(channel.high_threshold_hits) / channel.hits);
+        json_.value("lt_gaps", count(channel.lt_gaps));
+        json_.value("lt_missed", count(channel.lt_missed));
+        channel.peak_amplitude.write(json_, "peak_amplitude");
+        channel.charge.write(json_, "charge");
+        json_.end_object();
+      }
+    json_.end_array();
+
+    json_.begin_array("tracker_channels");
+    for (const auto & entry : _tracker_channels_)
+      {
+        const tracker_channel & channel = entry.second;
+        json_.begin_object();
+        json_.value("geom_id", channel_text(entry.first));
+        json_.value("hits", count(channel.hits));
+        if (duration > 0.0) json_.value("rate", channel.hits / duration);
+        json_.value("gg_times", count(channel.gg_times));
+        json_.end_object();
+      }
+    json_.end_array();
+    return;
+  }
+
+  run_statistics::calo_channel & run_statistics::_calo_channel_(const geomtools::geom_id & geom_id_)
+  {
+    calo_channel_map::iterator found = _calo_channels_.find(geom_id_);
+    if (found != _calo_channels_.end()) return found->second;
+    calo_channel & channel = _calo_channels_[geom_id_];
+    channel.peak_amplitude = fixed_histogram(_config_.peak_amplitude);
+    channel.charge = fixed_histogram(_config_.charge);
+    return channel;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,180 @@
+/// \file snredbridge/run_statistics.h
+/// Run monitoring statistics of the RED events, accumulated during the
+/// conversion
+
+#ifndef SNREDBRIDGE_RUN_STATISTICS_H
+#define SNREDBRIDGE_RUN_STATISTICS_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/geomtools/geom_id.h>
+
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+// This project:
+#include <snredbridge/json_writer.h>
+
+namespace snredbridge {
+
+  /// Fixed binning of a histogram: bins of equal width in [low, high)
+  struct histogram_binning
+  {
+    histogram_binning(const double low_ = 0.0,
+                      const double high_ = 1.0,
+                      const std::size_t bins_ = 1);
+
+    bool operator==(const histogram_binning & other_) const;
+
+    double low;
+    double high;
+    std::size_t bins;
+  };
+
+  /// \brief Histogram with a fixed binning, and the entries out of its range
+  class fixed_histogram
+  {
+  public:
+
+    explicit fixed_histogram(const histogram_binning & binning_ = histogram_binning());
+
+    void fill(const double value_);
+
+    /// Add the entries of a histogram with the same binning
+    void merge(const fixed_histogram & other_);
+
+    const histogram_binning & get_binning() const;
+
+    const std::vector<std::size_t> & get_bins() const;
+
+    std::size_t get_underflow() const;
+
+    std::size_t get_overflow() const;
+
+    std::size_t get_entries() const;
+
+    /// Write the histogram as a JSON object
+    void write(json_writer & json_, const std::string & key_) const;
+
+  private:
+
+    histogram_binning _binning_;
+    double _scale_; ///< Bins per unit
+    std::vector<std::size_t> _bins_;
+    std::size_t _underflow_ = 0;
+    std::size_t _overflow_ = 0;
+  };
+
+  /// \brief Data quality statistics of a run
+  ///
+  /// Counters and histograms per calorimeter and tracker channel, filled
+  /// from the RED events as the conversion reads them, so that the
+  /// monitoring needs no other pass over the data:
+  /// - hits and rate of each channel,
+  /// - calorimeter and tracker hit multiplicities of the events,
+  /// - fwmeas_peak_amplitude and fwmeas_charge spectra of each calorimeter
+  ///   channel,
+  /// - fraction of the calorimeter hits above the high threshold,
+  /// - gaps of the lt_trigger_counter between the successive hits of each
+  ///   calorimeter channel.
+  ///
+  /// Each thread fills its own statistics, merged at the end. The gaps of
+  /// the lt_trigger_counter depend on the order of the events: they are
+  /// filled by fill_sequence(), called for all the events in input order,
+  /// while fill() takes the events in any order. A gap between two merged
+  /// sequences (separate input files) is not counted.
+  class run_statistics
+  {
+  public:
+
+    struct config_type
+    {
+      histogram_binning peak_amplitude{-32768.0, 32768.0, 256}; ///< fwmeas_peak_amplitude
+      histogram_binning charge{-1048576.0, 1048576.0, 256};     ///< fwmeas_charge
+      histogram_binning calo_multiplicity{0.0, 64.0, 64};       ///< Calorimeter hits per event
+      histogram_binning tracker_multiplicity{0.0, 512.0, 128};  ///< Tracker hits per event
+      histogram_binning lt_trigger_gap{0.0, 64.0, 64};          ///< lt_trigger_counter gaps
+    };
+
+    /// Statistics of a calorimeter channel
+    struct calo_channel
+    {
+      std::size_t hits = 0;
+      std::size_t high_threshold_hits = 0;
+      fixed_histogram peak_amplitude;
+      fixed_histogram charge;
+      std::size_t lt_gaps = 0;        ///< Measured gaps of the lt_trigger_counter
+      std::size_t lt_missed = 0;      ///< Low threshold triggers of the channel missing between its hits
+      bool has_lt_counter = false;    ///< The channel has a hit in the sequence
+      uint16_t last_lt_counter = 0;   ///< lt_trigger_counter of the last hit in the sequence
+    };
+
+    /// Statistics of a tracker cell
+    struct tracker_channel
+    {
+      std::size_t hits = 0;
+      std::size_t gg_times = 0;       ///< Sets of anode and cathode times
+    };
+
+    typedef std::map<geomtools::geom_id, calo_channel> calo_channel_map;
+    typedef std::map<geomtools::geom_id, tracker_channel> tracker_channel_map;
+
+    /// Constructor with the default binnings
+    run_statistics();
+
+    explicit run_statistics(const config_type & config_);
+
+    /// Fill the counters and histograms of a RED event, in any order
+    void fill(const snfee::data::raw_event_data & red_);
+
+    /// Fill the lt_trigger_counter gaps of a RED event, in input order
+    void fill_sequence(const snfee::data::raw_event_data & red_);
+
+    /// Add the statistics of another thread or input file
+    void merge(const run_statistics & other_);
+
+    /// Check if no event was filled
+    bool is_empty() const;
+
+    std::size_t get_number_of_events() const;
+
+    /// Time between the first and the last event (s), 0 if unknown
+    double get_duration() const;
+
+    const calo_channel_map & get_calo_channels() const;
+
+    const tracker_channel_map & get_tracker_channels() const;
+
+    const config_type & get_config() const;
+
+    /// Write the statistics into the current JSON object
+    void write(json_writer & json_) const;
+
+  private:
+
+    calo_channel & _calo_channel_(const geomtools::geom_id & geom_id_);
+
+    config_type _config_;
+    std::size_t _events_ = 0;
+    std::size_t _calo_hits_ = 0;
+    std::size_t _tracker_hits_ = 0;
+    int64_t _first_ticks_ = 0;        ///< Reference time of the first event
+    int64_t _last_ticks_ = 0;         ///< Reference time of the last event
+    snfee::data::clock_type _clock_ = snfee::data::CLOCK_UNDEF;
+    fixed_histogram _calo_multiplicity_;
+    fixed_histogram _tracker_multiplicity_;
+    fixed_histogram _lt_trigger_gap_;
+    calo_channel_map _calo_channels_;
+    tracker_channel_map _tracker_channels_;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_RUN_STATISTICS_H
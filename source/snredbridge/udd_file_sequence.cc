@@ -0,0 +1,195 @@
+// Ourselves:
+#include <snredbridge/udd_file_sequence.h>
+
+// Standard library:
+#include <fstream>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+// - Falaise:
+#include <falaise/snemo/datamodels/event_header.h>
+
+// This project:
+#include <snredbridge/json_writer.h>
+#include <snredbridge/run_monitoring.h>
+
+namespace snredbridge {
+
+  udd_file_sequence::udd_file_sequence(const config_type & config_,
+                                       const conversion_checkpoint & start_)
+    : _config_(config_)
+    , _checkpoint_(start_)
+  {
+    DT_THROW_IF(_config_.checkpoint_interval < 0.0, std::logic_error, "Invalid checkpoint interval!");
+    if (is_split() && _config_.manifest_filename.empty())
+      _config_.manifest_filename = _config_.writer.filename + ".manifest.json";
+    if (has_checkpoints())
+      {
+        if (_config_.checkpoint_filename.empty())
+          _config_.checkpoint_filename = conversion_checkpoint::default_filename(_config_.writer.filename);
+        _schedule_checkpoint_();
+        _checkpoint_.complete = false;
+        _checkpoint_.save(_config_.checkpoint_filename);
+      }
+    if (!is_split())
+      {
+        // A single output file, created even if no record is stored
+        _open_part_(_checkpoint_.next_red_record);
+      }
+  }
+
+  udd_file_sequence::~udd_file_sequence() = default;
+
+  void udd_file_sequence::process(datatools::things & event_record_, const std::size_t red_record_)
+  {
+    DT_THROW_IF(_closed_, std::logic_error, "UDD output is closed!");
+    if (!_writer_) _open_part_(red_record_);
+    _writer_->process(event_record_);
+    _part_.udd_records++;
+    _part_.end_red_record = red_record_ + 1;
+    static const std::string eh_tag = "EH";
+    if (event_record_.has(eh_tag))
+      {
+        const datatools::event_id & id = event_record_.get<snemo::datamodel::event_header>(eh_tag).get_id();
+        if (_part_.udd_records == 1)
+          {
+            _part_.first_run_id = id.get_run_number();
+            _part_.first_event_id = id.get_event_number();
+          }
+        _part_.last_run_id = id.get_run_number();
+        _part_.last_event_id = id.get_event_number();
+      }
+
+    const bool roll = (_config_.max_events_per_file > 0 && _part_.udd_records >= _config_.max_events_per_file)
+      || (_config_.max_bytes_per_file > 0 && get_file_size(_part_.filename) >= _config_.max_bytes_per_file)
+      || (has_checkpoints() && clock_type::now() >= _next_checkpoint_time_);
+    if (roll) _close_part_(red_record_ + 1);
+    return;
+  }
+
+  void udd_file_sequence::close(const std::size_t next_red_record_)
+  {
+    if (_closed_) return;
+    _closed_ = true;
+    if (_writer_)
+      {
+        _writer_->reset();
+        _writer_.reset();
+        _add_part_();
+      }
+    _checkpoint_.next_red_record = next_red_record_;
+    _checkpoint_.complete = true;
+    if (has_checkpoints()) _checkpoint_.save(_config_.checkpoint_filename);
+    if (is_split()) _write_manifest_();
+    return;
+  }
+
+  bool udd_file_sequence::has_checkpoints() const
+  {
+    return _config_.checkpoint_interval > 0.0;
+  }
+
+  bool udd_file_sequence::is_split() const
+  {
+    return has_checkpoints() || _config_.max_events_per_file > 0 || _config_.max_bytes_per_file > 0;
+  }
+
+  std::vector<std::string> udd_file_sequence::get_filenames() const
+  {
+    std::vector<std::string> filenames;
+    for (const auto & part : _checkpoint_.parts) filenames.push_back(part.filename);
+    if (_writer_) filenames.push_back(_part_.filename);
+    return filenames;
+  }
+
+  const conversion_checkpoint & udd_file_sequence::get_checkpoint() const
+  {
+    return _checkpoint_;
+  }
+
+  const udd_file_sequence::config_type & udd_file_sequence::get_config() const
+  {
+    return _config_;
+  }
+
+  void udd_file_sequence::_open_part_(const std::size_t red_record_)
+  {
+    udd_writer::config_type writer_config = _config_.writer;
+    if (is_split())
+      writer_config.filename = filename_with_part(_config_.writer.filename, _checkpoint_.parts.size());
+    _part_ = conversion_checkpoint::part_type();
+    _part_.filename = writer_config.filename;
+    _part_.first_udd_record = _checkpoint_.udd_records;
+    _part_.first_red_record = red_record_;
+    _part_.end_red_record = red_record_;
+    _writer_.reset(new udd_writer(writer_config));
+    return;
+  }
+
+  void udd_file_sequence::_close_part_(const std::size_t next_red_record_)
+  {
+    _writer_->reset();
+    _writer_.reset();
+    _add_part_();
+    _checkpoint_.next_red_record = next_red_record_;
+    if (has_checkpoints())
+      {
+        _checkpoint_.save(_config_.checkpoint_filename);
+        _schedule_checkpoint_();
+      }
+    _write_manifest_();
+    return;
+  }
+
+  void udd_file_sequence::_add_part_()
+  {
+    // The part must be on the disk before a checkpoint refers to it
+    if (has_checkpoints()) sync_file(_part_.filename);
+    _checkpoint_.parts.push_back(_part_);
+    _checkpoint_.udd_records += _part_.udd_records;
+    return;
+  }
+
+  void udd_file_sequence::_schedule_checkpoint_()
+  {
+    _next_checkpoint_time_ = clock_type::now()
+      + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(_config_.checkpoint_interval));
+    return;
+  }
+
+  void udd_file_sequence::_write_manifest_() const
+  {
+    std::ofstream manifest_file(_config_.manifest_filename);
+    DT_THROW_IF(!manifest_file, std::runtime_error, "Cannot create manifest file '" << _config_.manifest_filename << "'!");
+    json_writer json(manifest_file);
+    json.begin_object();
+    json.value("input", _checkpoint_.input);
+    json.value("complete", _checkpoint_.complete);
+    json.value("udd_records", _checkpoint_.udd_records);
+    json.begin_array("files");
+    for (const auto & part : _checkpoint_.parts)
+      {
+        json.begin_object();
+        json.value("file", part.filename);
+        json.value("first_udd_record", part.first_udd_record);
+        json.value("udd_records", part.udd_records);
+        json.value("first_red_record", part.first_red_record);
+        json.value("end_red_record", part.end_red_record);
+        if (part.udd_records > 0)
+          {
+            json.value("first_run_id", part.first_run_id);
+            json.value("first_event_id", part.first_event_id);
+            json.value("last_run_id", part.last_run_id);
+            json.value("last_event_id", part.last_event_id);
+          }
+        json.end_object();
+      }
+    json.end_array();
+    json.end_object();
+    return;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,116 @@
+/// \file snredbridge/udd_file_sequence.h
+/// UDD output written as a sequence of files, rolled over at each checkpoint
+/// or when a file reaches a number of events or a size
+
+#ifndef SNREDBRIDGE_UDD_FILE_SEQUENCE_H
+#define SNREDBRIDGE_UDD_FILE_SEQUENCE_H
+
+// Standard library:
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/things.h>
+
+// This project:
+#include <snredbridge/udd_writer.h>
+#include <snredbridge/conversion_checkpoint.h>
+
+namespace snredbridge {
+
+  /// \brief UDD output of a conversion, with checkpoints and rolling files
+  ///
+  /// By default, the event records are written into the output file as by a
+  /// single udd_writer. With checkpoints or a maximum number of events or
+  /// bytes per file, they are written into numbered parts of the output file
+  /// (see filename_with_part()). The next record after a closed part opens a
+  /// new part.
+  ///
+  /// At each checkpoint, the current part is closed and synced to the disk,
+  /// then the checkpoint file is updated: a killed job loses at most the
+  /// records written since the last checkpoint.
+  ///
+  /// The size of a part is checked on the disk after each record, so that a
+  /// part can exceed the maximum size by the data buffered by the compressor.
+  ///
+  /// The manifest of the parts (JSON file) gives the file name, the UDD
+  /// records, the RED records and the first and last events of each part. It
+  /// is updated each time a part is closed.
+  ///
+  /// A Boost archive cannot be reopened for appending, so a resumed conversion
+  /// goes on with the next part number: the incomplete part of the killed job
+  /// is overwritten.
+  class udd_file_sequence
+  {
+  public:
+
+    struct config_type
+    {
+      udd_writer::config_type writer;      ///< Output file and compression
+      double checkpoint_interval = 0.0;    ///< Seconds between two checkpoints (0: no checkpoint)
+      std::string checkpoint_filename;     ///< Checkpoint file (default: "<output file>.checkpoint")
+      std::size_t max_events_per_file = 0; ///< Maximum number of event records per part (0: no limit)
+      uint64_t max_bytes_per_file = 0;     ///< Maximum size of a part in bytes (0: no limit)
+      std::string manifest_filename;       ///< Manifest of the parts (default: "<output file>.manifest.json")
+    };
+
+    /// Start the output from a checkpoint (the default one for a new conversion)
+    udd_file_sequence(const config_type & config_,
+                      const conversion_checkpoint & start_);
+
+    ~udd_file_sequence();
+
+    udd_file_sequence(const udd_file_sequence &) = delete;
+    udd_file_sequence & operator=(const udd_file_sequence &) = delete;
+
+    /// Store an event record converted from the RED record at position red_record_
+    void process(datatools::things & event_record_, const std::size_t red_record_);
+
+    /// Close the output, next_red_record_ is the position after the last RED
+    /// record read. The last checkpoint is marked as complete.
+    void close(const std::size_t next_red_record_);
+
+    /// Check if the state of the conversion is saved at checkpoints
+    bool has_checkpoints() const;
+
+    /// Check if the output is written in numbered parts
+    bool is_split() const;
+
+    /// Output files written so far, the current part included
+    std::vector<std::string> get_filenames() const;
+
+    /// Last checkpoint
+    const conversion_checkpoint & get_checkpoint() const;
+
+    const config_type & get_config() const;
+
+  private:
+
+    void _open_part_(const std::size_t red_record_);
+
+    void _close_part_(const std::size_t next_red_record_);
+
+    void _add_part_();
+
+    void _schedule_checkpoint_();
+
+    void _write_manifest_() const;
+
+    typedef std::chrono::steady_clock clock_type;
+
+    config_type _config_;
+    conversion_checkpoint _checkpoint_;
+    std::unique_ptr<udd_writer> _writer_;
+    conversion_checkpoint::part_type _part_; ///< Current part
+    clock_type::time_point _next_checkpoint_time_;
+    bool _closed_ = false;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_UDD_FILE_SEQUENCE_H
@@ -0,0 +1,173 @@
+// Ourselves:
+#include <snredbridge/udd_sink.h>
+
+// Standard library:
+#include <stdexcept>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+// This project:
+#include <snredbridge/red_to_udd_conversion.h>
+#include <snredbridge/event_fingerprint.h>
+
+namespace snredbridge {
+
+  udd_sink::udd_sink(const config_type & config_,
+                     const conversion_checkpoint & start_)
+    : _config_(config_)
+    , _writer_(config_.output, start_)
+  {
+    DT_THROW_IF(_config_.number_of_records == 0, std::logic_error, "Invalid number of event records of the UDD sink!");
+    for (const std::string & cut : _config_.cuts) _selection_.add_cut(cut);
+    for (std::size_t i = 0; i < _config_.number_of_records; i++)
+      {
+        _records_.emplace_back(new datatools::things);
+        _free_records_.push_back(_records_.back().get());
+      }
+    _thread_ = std::thread(&udd_sink::_write_loop_, this);
+  }
+
+  udd_sink::~udd_sink()
+  {
+    if (_thread_.joinable())
+      {
+        abort();
+        _thread_.join();
+      }
+  }
+
+  bool udd_sink::select(const snfee::data::raw_event_data & red_)
+  {
+    return !_selection_.has_cuts() || _selection_.select(red_);
+  }
+
+  datatools::things * udd_sink::acquire()
+  {
+    std::unique_lock<std::mutex> lock(_mutex_);
+    _free_cv_.wait(lock, [this] { return _aborted_ || !_free_records_.empty(); });
+    if (_aborted_) return nullptr;
+    datatools::things * event_record = _free_records_.back();
+    _free_records_.pop_back();
+    return event_record;
+  }
+
+  void udd_sink::convert(const snfee::data::raw_event_data & red_,
+                         datatools::things & event_record_) const
+  {
+    do_red_to_udd_conversion(red_, event_record_, _config_.waveform);
+    if (_config_.fingerprint) store_fingerprint(red_, _config_.waveform, event_record_);
+    return;
+  }
+
+  void udd_sink::push(datatools::things * event_record_, const std::size_t red_record_)
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    DT_THROW_IF(_closing_, std::logic_error, "UDD sink is closed!");
+    _queue_.emplace_back(event_record_, red_record_);
+    _queue_cv_.notify_one();
+    return;
+  }
+
+  void udd_sink::release(datatools::things * event_record_)
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    _free_records_.push_back(event_record_);
+    _free_cv_.notify_one();
+    return;
+  }
+
+  void udd_sink::abort()
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    _aborted_ = true;
+    _queue_.clear();
+    _queue_cv_.notify_all();
+    _free_cv_.notify_all();
+    return;
+  }
+
+  void udd_sink::close(const std::size_t next_red_record_)
+  {
+    if (_closed_) return;
+    _closed_ = true;
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      _closing_ = true;
+      _queue_cv_.notify_all();
+    }
+    if (_thread_.joinable()) _thread_.join();
+
+    std::exception_ptr error = _error_;
+    try {
+      _write_timer_.start();
+      _writer_.close(next_red_record_);
+      _write_timer_.stop();
+    }
+    catch (...) {
+      if (!error) error = std::current_exception();
+    }
+    _filenames_ = _writer_.get_filenames();
+    _config_.output = _writer_.get_config();
+    if (error) std::rethrow_exception(error);
+    return;
+  }
+
+  const event_selection & udd_sink::get_selection() const
+  {
+    return _selection_;
+  }
+
+  std::size_t udd_sink::get_number_of_records() const
+  {
+    return _written_;
+  }
+
+  const stage_timer & udd_sink::get_write_timer() const
+  {
+    return _write_timer_;
+  }
+
+  const std::vector<std::string> & udd_sink::get_filenames() const
+  {
+    return _filenames_;
+  }
+
+  const udd_sink::config_type & udd_sink::get_config() const
+  {
+    return _config_;
+  }
+
+  void udd_sink::_write_loop_()
+  {
+    while (true)
+      {
+        std::pair<datatools::things *, std::size_t> item;
+        {
+          std::unique_lock<std::mutex> lock(_mutex_);
+          _queue_cv_.wait(lock, [this] { return _closing_ || _aborted_ || !_queue_.empty(); });
+          if (_queue_.empty()) break;
+          item = _queue_.front();
+          _queue_.pop_front();
+        }
+        // After an error the queue is still drained, so that acquire() never blocks
+        if (!_error_)
+          {
+            try {
+              prepare_event_record(*item.first, _written_);
+              _write_timer_.start();
+              _writer_.process(*item.first, item.second);
+              _write_timer_.stop();
+              _written_++;
+            }
+            catch (...) {
+              _error_ = std::current_exception();
+            }
+          }
+        release(item.first);
+      }
+    return;
+  }
+
+} // namespace snredbridge
@@ -0,0 +1,141 @@
+/// \file snredbridge/udd_sink.h
+/// Additional UDD output of a conversion, with its own waveform storage and
+/// selection, written on its own thread
+
+#ifndef SNREDBRIDGE_UDD_SINK_H
+#define SNREDBRIDGE_UDD_SINK_H
+
+// Standard library:
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/things.h>
+
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+// This project:
+#include <snredbridge/udd_file_sequence.h>
+#include <snredbridge/event_selection.h>
+#include <snredbridge/waveform_codec.h>
+#include <snredbridge/run_monitoring.h>
+
+namespace snredbridge {
+
+  /// \brief UDD output fed by the conversion of another output
+  ///
+  /// The RED events read once by the conversion are offered to each sink:
+  /// a sink keeps the events passing its own cuts, converts them with its own
+  /// waveform storage and writes them into its own file. For example, a full
+  /// UDD file and a UDD file without waveforms are written in a single pass
+  /// over the RED file.
+  ///
+  /// The calls are split so that the conversion can run on several threads:
+  /// - select() is called for each RED event in input order,
+  /// - acquire() and convert() are called by any thread for the selected
+  ///   events,
+  /// - push() is called for the converted events in input order.
+  ///
+  /// The event records pushed are written by the thread of the sink, then
+  /// given back to the pool of acquire(). The size of the pool bounds the
+  /// memory in use: acquire() waits for the writer thread when all the event
+  /// records are in use.
+  class udd_sink
+  {
+  public:
+
+    struct config_type
+    {
+      udd_file_sequence::config_type output; ///< Output file(s) and compression
+      waveform_config waveform;              ///< Storage of the waveforms in the UDD hits
+      bool fingerprint = true;               ///< Store the fingerprint of the events in their header
+      std::vector<std::string> cuts;         ///< Cuts of the selection of this sink
+      std::size_t number_of_records = 16;    ///< Size of the pool of event records
+    };
+
+    /// Open the output and start the writer thread
+    udd_sink(const config_type & config_,
+             const conversion_checkpoint & start_);
+
+    /// Stop the writer thread if not done yet, errors are ignored
+    ~udd_sink();
+
+    udd_sink(const udd_sink &) = delete;
+    udd_sink & operator=(const udd_sink &) = delete;
+
+    /// Check if a RED event passes the cuts of the sink and update the counters
+    bool select(const snfee::data::raw_event_data & red_);
+
+    /// Take an event record from the pool, null once aborted
+    datatools::things * acquire();
+
+    /// Fill an event record from a RED event with the waveform storage of the sink
+    void convert(const snfee::data::raw_event_data & red_,
+                 datatools::things & event_record_) const;
+
+    /// Queue an event record acquired and converted for the RED record at position red_record_
+    void push(datatools::things * event_record_, const std::size_t red_record_);
+
+    /// Give back an event record which will not be pushed
+    void release(datatools::things * event_record_);
+
+    /// Release the threads waiting in acquire(), the queued records are dropped
+    void abort();
+
+    /// Write the queued records and close the output. Errors of the writer
+    /// thread are thrown here.
+    void close(const std::size_t next_red_record_);
+
+    /// Selection of the sink and its counters
+    const event_selection & get_selection() const;
+
+    /// Number of event records written (valid after close())
+    std::size_t get_number_of_records() const;
+
+    /// Time spent in writing the event records (valid after close())
+    const stage_timer & get_write_timer() const;
+
+    /// Output files (valid after close())
+    const std::vector<std::string> & get_filenames() const;
+
+    /// Configuration, with the output settings resolved by the writer (after close())
+    const config_type & get_config() const;
+
+  private:
+
+    void _write_loop_();
+
+    config_type _config_;
+    event_selection _selection_;
+    udd_file_sequence _writer_;
+    std::vector<std::unique_ptr<datatools::things>> _records_; ///< Pool storage
+    std::vector<datatools::things *> _free_records_;
+    std::deque<std::pair<datatools::things *, std::size_t>> _queue_; ///< Event records to write and their RED record
+    bool _closing_ = false;
+    bool _aborted_ = false;
+    bool _closed_ = false;
+    std::exception_ptr _error_;
+    std::mutex _mutex_;
+    std::condition_variable _queue_cv_; ///< The writer thread waits for records
+    std::condition_variable _free_cv_;  ///< acquire() waits for free records
+    std::thread _thread_;
+
+    // Results, updated by the writer thread
+    std::size_t _written_ = 0;
+    stage_timer _write_timer_;
+    std::vector<std::string> _filenames_;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_UDD_SINK_H
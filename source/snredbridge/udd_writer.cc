@@ -0,0 +1,240 @@
+// Ourselves:
+#include <snredbridge/udd_writer.h>
+
+// Standard library:
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+// System:
+#include <fcntl.h>
+#include <unistd.h>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    /// File name without its compression extension
+    std::string strip_codec_extension(const std::string & filename_)
+    {
+      if (ends_with(filename_, ".gz")) return filename_.substr(0, filename_.size() - 3);
+      if (ends_with(filename_, ".bz2")) return filename_.substr(0, filename_.size() - 4);
+      return filename_;
+    }
+
+  } // namespace
+
+  compression_codec compression_codec_from_string(const std::string & name_)
+  {
+    if (name_ == "none") return compression_codec::none;
+    if (name_ == "gzip") return compression_codec::gzip;
+    if (name_ == "bzip2") return compression_codec::bzip2;
+    DT_THROW_IF(name_ == "zstd" || name_ == "lz4", std::domain_error,
+                "Codec '" << name_ << "' is not supported by the Bayeux readers used by Falaise!");
+    DT_THROW(std::domain_error, "Unknown compression codec '" << name_ << "'!");
+  }
+
+  std::string to_string(const compression_codec codec_)
+  {
+    switch (codec_)
+      {
+      case compression_codec::none: return "none";
+      case compression_codec::gzip: return "gzip";
+      case compression_codec::bzip2: return "bzip2";
+      }
+    return "";
+  }
+
+  compression_codec compression_codec_from_filename(const std::string & filename_)
+  {
+    if (ends_with(filename_, ".gz")) return compression_codec::gzip;
+    if (ends_with(filename_, ".bz2")) return compression_codec::bzip2;
+    return compression_codec::none;
+  }
+
+  archive_format archive_format_from_filename(const std::string & filename_)
+  {
+    const std::string base_filename = strip_codec_extension(filename_);
+    if (ends_with(base_filename, ".txt")) return archive_format::text;
+    if (ends_with(base_filename, ".xml")) return archive_format::xml;
+    return archive_format::portable_binary;
+  }
+
+  std::string filename_with_codec(const std::string & filename_, const compression_codec codec_)
+  {
+    const std::string base_filename = strip_codec_extension(filename_);
+    switch (codec_)
+      {
+      case compression_codec::none: return base_filename;
+      case compression_codec::gzip: return base_filename + ".gz";
+      case compression_codec::bzip2: return base_filename + ".bz2";
+      }
+    return filename_;
+  }
+
+  std::string filename_with_part(const std::string & filename_, const std::size_t part_)
+  {
+    // The number goes before the format extension (".data", ".txt", ".xml")
+    const std::string base_filename = strip_codec_extension(filename_);
+    const std::string codec_extension = filename_.substr(base_filename.size());
+    const std::size_t slash = base_filename.find_last_of('/');
+    std::size_t dot = base_filename.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) dot = base_filename.size();
+    char number[16];
+    std::snprintf(number, sizeof(number), "_part%04zu", part_);
+    return base_filename.substr(0, dot) + number + base_filename.substr(dot) + codec_extension;
+  }
+
+  udd_writer::udd_writer(const config_type & config_)
+    : _config_(config_)
+  {
+    DT_THROW_IF(_config_.filename.empty(), std::logic_error, "Missing UDD output filename!");
+    const bool block_compression = compression_codec_from_filename(_config_.filename) == compression_codec::gzip
+      && (_config_.level >= 0 || _config_.compression_threads > 0);
+    DT_THROW_IF(_config_.level >= 0 && !block_compression, std::logic_error,
+                "A compression level is only supported for gzip output files!");
+
+    _output_module_.set_logging_priority(datatools::logger::PRIO_FATAL);
+    _output_module_.set_name("Writer output module");
+    _output_module_.set_description("Output module for the datatools::things event_record");
+    _output_module_.set_preserve_existing_output(false); // Allowed to erase existing output file
+    if (!block_compression)
+      {
+        _output_module_.set_single_output_file(_config_.filename);
+        _output_module_.initialize_simple();
+        return;
+      }
+
+    try {
+      _open_pipe_();
+      _output_module_.set_single_output_file(_pipe_path_);
+      _output_module_.initialize_simple();
+    }
+    catch (...) {
+      try {
+        _close_pipe_();
+      }
+      catch (...) {
+      }
+      throw;
+    }
+  }
+
+  udd_writer::~udd_writer()
+  {
+    try {
+      reset();
+    }
+    catch (...) {
+    }
+  }
+
+  dpp::base_module::process_status udd_writer::process(datatools::things & event_record_)
+  {
+    return _output_module_.process(event_record_);
+  }
+
+  void udd_writer::reset()
+  {
+    if (_closed_) return;
+    _closed_ = true;
+    // Closing the output module flushes its stream into the file or the pipe
+    if (_output_module_.is_initialized()) _output_module_.reset();
+    if (is_block_compressed()) _close_pipe_();
+    return;
+  }
+
+  bool udd_writer::is_block_compressed() const
+  {
+    return !_pipe_path_.empty();
+  }
+
+  const std::string & udd_writer::get_filename() const
+  {
+    return _config_.filename;
+  }
+
+  void udd_writer::_open_pipe_()
+  {
+    // The pipe keeps the extension of the format, Bayeux selects the archive
+    // type from it and does not compress the stream
+    const std::string base_filename = strip_codec_extension(_config_.filename);
+    const std::size_t dot = base_filename.rfind('.');
+    const std::string format_extension = dot != std::string::npos ? base_filename.substr(dot) : std::string(".data");
+
+    _pipe_path_ = _pipes_.make_pipe("udd" + format_extension, "compression pipe");
+
+    // Both ends are opened here: the write end kept by the writer makes sure
+    // that the pump does not see the end of the stream before the output
+    // module is closed, even if the module opens the file late or never.
+    _pipe_read_fd_ = ::open(_pipe_path_.c_str(), O_RDONLY | O_NONBLOCK);
+    DT_THROW_IF(_pipe_read_fd_ < 0, std::runtime_error,
+                "Cannot open the compression pipe '" << _pipe_path_ << "': " << std::strerror(errno));
+    _pipe_write_fd_ = ::open(_pipe_path_.c_str(), O_WRONLY);
+    DT_THROW_IF(_pipe_write_fd_ < 0, std::runtime_error,
+                "Cannot open the compression pipe '" << _pipe_path_ << "': " << std::strerror(errno));
+    ::fcntl(_pipe_read_fd_, F_SETFL, ::fcntl(_pipe_read_fd_, F_GETFL) & ~O_NONBLOCK);
+
+    _compressor_.reset(new parallel_gzip_writer(_config_.filename,
+                                                _config_.level,
+                                                _config_.compression_threads,
+                                                _config_.block_size));
+    _pump_thread_ = std::thread(&udd_writer::_pump_pipe_, this);
+    return;
+  }
+
+  void udd_writer::_pump_pipe_()
+  {
+    std::vector<char> buffer(1024 * 1024);
+    while (true)
+      {
+        const ssize_t size = ::read(_pipe_read_fd_, buffer.data(), buffer.size());
+        if (size == 0) break;
+        if (size < 0)
+          {
+            if (errno == EINTR) continue;
+            if (!_pump_error_)
+              _pump_error_ = std::make_exception_ptr(std::runtime_error("Cannot read the compression pipe!"));
+            break;
+          }
+        // After an error the pipe is still drained, so that the output module never blocks
+        if (_pump_error_) continue;
+        try {
+          _compressor_->write(buffer.data(), size);
+        }
+        catch (...) {
+          _pump_error_ = std::current_exception();
+        }
+      }
+    return;
+  }
+
+  void udd_writer::_close_pipe_()
+  {
+    // The pump reaches the end of the stream once all write ends are closed
+    if (_pipe_write_fd_ >= 0) ::close(_pipe_write_fd_);
+    _pipe_write_fd_ = -1;
+    if (_pump_thread_.joinable()) _pump_thread_.join();
+    if (_pipe_read_fd_ >= 0) ::close(_pipe_read_fd_);
+    _pipe_read_fd_ = -1;
+
+    std::exception_ptr error = _pump_error_;
+    try {
+      if (_compressor_) _compressor_->close();
+    }
+    catch (...) {
+      if (!error) error = std::current_exception();
+    }
+    _compressor_.reset();
+    _pipes_.remove();
+    if (error) std::rethrow_exception(error);
+    return;
+  }
+
+} // namespace snredbridge
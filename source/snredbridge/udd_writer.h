@@ -0,0 +1,128 @@
+/// \file snredbridge/udd_writer.h
+/// Writer of UDD event records with a choice of compression codec, level and
+/// parallel block compression
+
+#ifndef SNREDBRIDGE_UDD_WRITER_H
+#define SNREDBRIDGE_UDD_WRITER_H
+
+// Standard library:
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/things.h>
+#include <bayeux/dpp/output_module.h>
+
+// This project:
+#include <snredbridge/named_pipe.h>
+#include <snredbridge/parallel_gzip_writer.h>
+
+namespace snredbridge {
+
+  /// Compression codecs of output files readable by Bayeux/Falaise
+  enum class compression_codec
+  {
+    none,  ///< No compression (".data", ".txt", ".xml")
+    gzip,  ///< Gzip compression (".gz")
+    bzip2  ///< Bzip2 compression (".bz2")
+  };
+
+  /// Codec from its name ("none", "gzip", "bzip2")
+  compression_codec compression_codec_from_string(const std::string & name_);
+
+  /// Name of a codec
+  std::string to_string(const compression_codec codec_);
+
+  /// Codec used by Bayeux for a file, from its extension
+  compression_codec compression_codec_from_filename(const std::string & filename_);
+
+  /// Boost archives of the files written by the Bayeux io_factory
+  enum class archive_format
+  {
+    portable_binary, ///< Portable binary archive (".data")
+    text,            ///< Text archive (".txt")
+    xml              ///< XML archive (".xml")
+  };
+
+  /// Archive used by Bayeux for a file, from its extension before the codec one
+  archive_format archive_format_from_filename(const std::string & filename_);
+
+  /// Replace the compression extension of a file by the one of a codec
+  std::string filename_with_codec(const std::string & filename_, const compression_codec codec_);
+
+  /// Numbered file name of a part of the output ("run_udd.data.gz" -> "run_udd_part0003.data.gz")
+  std::string filename_with_part(const std::string & filename_, const std::size_t part_);
+
+  /// \brief Writer of UDD event records
+  ///
+  /// Event records are serialized by the dpp output module, so that the
+  /// output file is the same as the one written by Falaise. The codec is
+  /// given by the extension of the output file, see filename_with_codec().
+  ///
+  /// For gzip files with a compression level or some compression threads, the
+  /// output module writes the uncompressed stream into a named pipe instead of
+  /// the file. The stream is read back by a thread of the writer and deflated
+  /// in blocks by a parallel_gzip_writer. The serialization stays in the
+  /// thread calling process(), the compression runs on the other threads.
+  class udd_writer
+  {
+  public:
+
+    struct config_type
+    {
+      std::string filename;                 ///< Output file
+      int level = -1;                       ///< Gzip compression level from 1 to 9 (-1: default)
+      unsigned int compression_threads = 0; ///< Gzip compression threads (0: compression by the output module)
+      std::size_t block_size = parallel_gzip_writer::DEFAULT_BLOCK_SIZE; ///< Uncompressed size of the gzip blocks
+    };
+
+    /// Open the output file
+    explicit udd_writer(const config_type & config_);
+
+    /// Close the output file if not done yet
+    ~udd_writer();
+
+    udd_writer(const udd_writer &) = delete;
+    udd_writer & operator=(const udd_writer &) = delete;
+
+    /// Store an event record
+    dpp::base_module::process_status process(datatools::things & event_record_);
+
+    /// Close the output file, all data are written when it returns
+    void reset();
+
+    /// Check if the gzip compression is done in blocks by the writer threads
+    bool is_block_compressed() const;
+
+    /// Output file
+    const std::string & get_filename() const;
+
+  private:
+
+    void _open_pipe_();
+
+    void _pump_pipe_();
+
+    void _close_pipe_();
+
+    config_type _config_;
+    dpp::output_module _output_module_;
+    bool _closed_ = false;
+
+    // Block compression
+    temporary_pipes _pipes_;
+    std::string _pipe_path_;
+    int _pipe_read_fd_ = -1;
+    int _pipe_write_fd_ = -1;
+    std::unique_ptr<parallel_gzip_writer> _compressor_;
+    std::thread _pump_thread_;
+    std::exception_ptr _pump_error_;
+  };
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_UDD_WRITER_H
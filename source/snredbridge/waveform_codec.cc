@@ -0,0 +1,327 @@
+// Ourselves:
+#include <snredbridge/waveform_codec.h>
+
+// Standard library:
+#include <algorithm>
+#include <stdexcept>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+
+namespace snredbridge {
+
+  namespace {
+
+    const std::string ENCODING_KEY   = "waveform.encoding";
+    const std::string LENGTH_KEY     = "waveform.length";
+    const std::string FIRST_CELL_KEY = "waveform.first_cell";
+    const std::string ROI_ENCODING    = "roi";
+    const std::string PACKED_ENCODING = "delta_packed";
+
+    /// Number of deltas sharing the same bit width
+    const std::size_t PACKING_BLOCK_SIZE = 32;
+
+    /// Bits used to store the width of a block
+    const unsigned int WIDTH_BITS = 5;
+
+    /// The firmware rising and falling cells are given in 1/256 of a cell
+    const int32_t FWMEAS_CELL_FRACTION = 256;
+
+    /// Writes values of variable bit width into 16 bits words
+    class bit_writer
+    {
+    public:
+
+      explicit bit_writer(std::vector<int16_t> & words_) : _words_(words_) {}
+
+      void put(const uint32_t value_, const unsigned int width_)
+      {
+        _buffer_ |= uint64_t(value_) << _bits_;
+        _bits_ += width_;
+        while (_bits_ >= 16)
+          {
+            _words_.push_back(static_cast<int16_t>(static_cast<uint16_t>(_buffer_)));
+            _buffer_ >>= 16;
+            _bits_ -= 16;
+          }
+        return;
+      }
+
+      void flush()
+      {
+        if (_bits_ > 0) _words_.push_back(static_cast<int16_t>(static_cast<uint16_t>(_buffer_)));
+        _buffer_ = 0;
+        _bits_ = 0;
+        return;
+      }
+
+    private:
+
+      std::vector<int16_t> & _words_;
+      uint64_t _buffer_ = 0;
+      unsigned int _bits_ = 0;
+    };
+
+    /// Reads values of variable bit width from 16 bits words
+    class bit_reader
+    {
+    public:
+
+      explicit bit_reader(const std::vector<int16_t> & words_) : _words_(words_) {}
+
+      bool get(const unsigned int width_, uint32_t & value_)
+      {
+        while (_bits_ < width_)
+          {
+            if (_next_word_ == _words_.size()) return false;
+            _buffer_ |= uint64_t(static_cast<uint16_t>(_words_[_next_word_++])) << _bits_;
+            _bits_ += 16;
+          }
+        value_ = static_cast<uint32_t>(_buffer_ & ((uint64_t(1) << width_) - 1));
+        _buffer_ >>= width_;
+        _bits_ -= width_;
+        return true;
+      }
+
+    private:
+
+      const std::vector<int16_t> & _words_;
+      std::size_t _next_word_ = 0;
+      uint64_t _buffer_ = 0;
+      unsigned int _bits_ = 0;
+    };
+
+    uint32_t zigzag_encode(const int32_t value_)
+    {
+      return (static_cast<uint32_t>(value_) << 1) ^ static_cast<uint32_t>(value_ >> 31);
+    }
+
+    int32_t zigzag_decode(const uint32_t value_)
+    {
+      return static_cast<int32_t>(value_ >> 1) ^ -static_cast<int32_t>(value_ & 1);
+    }
+
+    unsigned int bit_width(uint32_t value_)
+    {
+      unsigned int width = 0;
+      while (value_ != 0)
+        {
+          width++;
+          value_ >>= 1;
+        }
+      return width;
+    }
+
+  } // namespace
+
+  waveform_mode waveform_mode_from_string(const std::string & name_)
+  {
+    if (name_ == "none") return waveform_mode::none;
+    if (name_ == "full") return waveform_mode::full;
+    if (name_ == "roi") return waveform_mode::roi;
+    if (name_ == "packed") return waveform_mode::packed;
+    DT_THROW(std::domain_error, "Unknown waveform mode '" << name_ << "'!");
+  }
+
+  std::string to_string(const waveform_mode mode_)
+  {
+    switch (mode_)
+      {
+      case waveform_mode::none: return "none";
+      case waveform_mode::full: return "full";
+      case waveform_mode::roi: return "roi";
+      case waveform_mode::packed: return "packed";
+      }
+    return "";
+  }
+
+  void pulse_window(const snfee::data::calo_digitized_hit & red_calo_hit_,
+                    const std::size_t before_,
+                    const std::size_t after_,
+                    std::size_t & first_,
+                    std::size_t & last_)
+  {
+    const std::size_t length = red_calo_hit_.get_waveform().size();
+    const int32_t peak_cell = red_calo_hit_.get_fwmeas_peak_cell();
+    const int32_t rising_cell = red_calo_hit_.get_fwmeas_rising_cell() / FWMEAS_CELL_FRACTION;
+    const int32_t falling_cell = red_calo_hit_.get_fwmeas_falling_cell() / FWMEAS_CELL_FRACTION;
+    const int32_t pulse_first = std::max(0, std::min(rising_cell, peak_cell));
+    const int32_t pulse_last = std::max(falling_cell, peak_cell);
+    first_ = std::size_t(pulse_first) > before_ ? pulse_first - before_ : 0;
+    last_ = std::min(length, std::size_t(std::max(pulse_last, 0)) + after_ + 1);
+    // No usable firmware measurement: keep all the samples
+    if (first_ >= last_)
+      {
+        first_ = 0;
+        last_ = length;
+      }
+    return;
+  }
+
+  void pack_waveform(const std::vector<int16_t> & samples_,
+                     std::vector<int16_t> & packed_)
+  {
+    // Layout: the first sample on 16 bits, then for each block of deltas
+    // between consecutive samples, the bit width of the block on 5 bits and
+    // the zigzag encoded deltas on this width. Deltas of 16 bits samples fit
+    // in 17 bits.
+    packed_.clear();
+    if (samples_.empty()) return;
+    packed_.reserve(samples_.size() / 2 + 2);
+    bit_writer writer(packed_);
+    writer.put(static_cast<uint16_t>(samples_[0]), 16);
+    uint32_t deltas[PACKING_BLOCK_SIZE];
+    for (std::size_t block_start = 1; block_start < samples_.size(); block_start += PACKING_BLOCK_SIZE)
+      {
+        const std::size_t block_end = std::min(samples_.size(), block_start + PACKING_BLOCK_SIZE);
+        uint32_t all_bits = 0;
+        for (std::size_t isample = block_start; isample < block_end; isample++)
+          {
+            const uint32_t delta = zigzag_encode(int32_t(samples_[isample]) - int32_t(samples_[isample - 1]));
+            deltas[isample - block_start] = delta;
+            all_bits |= delta;
+          }
+        const unsigned int width = bit_width(all_bits);
+        writer.put(width, WIDTH_BITS);
+        if (width == 0) continue;
+        for (std::size_t idelta = 0; idelta < block_end - block_start; idelta++)
+          writer.put(deltas[idelta], width);
+      }
+    writer.flush();
+    return;
+  }
+
+  bool unpack_waveform(const std::vector<int16_t> & packed_,
+                       const std::size_t number_of_samples_,
+                       std::vector<int16_t> & samples_)
+  {
+    samples_.resize(number_of_samples_);
+    if (number_of_samples_ == 0) return packed_.empty();
+    bit_reader reader(packed_);
+    uint32_t value = 0;
+    if (!reader.get(16, value)) return false;
+    int32_t sample = static_cast<int16_t>(static_cast<uint16_t>(value));
+    samples_[0] = sample;
+    for (std::size_t block_start = 1; block_start < number_of_samples_; block_start += PACKING_BLOCK_SIZE)
+      {
+        const std::size_t block_end = std::min(number_of_samples_, block_start + PACKING_BLOCK_SIZE);
+        uint32_t width = 0;
+        if (!reader.get(WIDTH_BITS, width) || width > 17) return false;
+        for (std::size_t isample = block_start; isample < block_end; isample++)
+          {
+            uint32_t delta = 0;
+            if (width > 0 && !reader.get(width, delta)) return false;
+            sample += zigzag_decode(delta);
+            if (sample < INT16_MIN || sample > INT16_MAX) return false;
+            samples_[isample] = sample;
+          }
+      }
+    return true;
+  }
+
+  void store_waveform(const snfee::data::calo_digitized_hit & red_calo_hit_,
+                      const waveform_config & config_,
+                      snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit_)
+  {
+    const std::vector<int16_t> & red_waveform = red_calo_hit_.get_waveform();
+    switch (config_.mode)
+      {
+      case waveform_mode::none:
+        break;
+
+      case waveform_mode::full:
+        udd_calo_hit_.set_waveform(red_waveform);
+        break;
+
+      case waveform_mode::roi:
+        {
+          std::size_t first = 0;
+          std::size_t last = 0;
+          pulse_window(red_calo_hit_, config_.roi_before, config_.roi_after, first, last);
+          // Reuse the buffer of the working hit for the window
+          static thread_local std::vector<int16_t> window;
+          window.assign(red_waveform.begin() + first, red_waveform.begin() + last);
+          udd_calo_hit_.set_waveform(window);
+          datatools::properties & auxiliaries = udd_calo_hit_.grab_auxiliaries();
+          auxiliaries.store_string(ENCODING_KEY, ROI_ENCODING);
+          auxiliaries.store_integer(LENGTH_KEY, red_waveform.size());
+          auxiliaries.store_integer(FIRST_CELL_KEY, first);
+        }
+        break;
+
+      case waveform_mode::packed:
+        {
+          static thread_local std::vector<int16_t> packed;
+          pack_waveform(red_waveform, packed);
+          udd_calo_hit_.set_waveform(packed);
+          datatools::properties & auxiliaries = udd_calo_hit_.grab_auxiliaries();
+          auxiliaries.store_string(ENCODING_KEY, PACKED_ENCODING);
+          auxiliaries.store_integer(LENGTH_KEY, red_waveform.size());
+        }
+        break;
+      }
+    return;
+  }
+
+  void decode_waveform(const snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit_,
+                       std::vector<int16_t> & samples_,
+                       std::size_t & first_cell_)
+  {
+    first_cell_ = 0;
+    const datatools::properties & auxiliaries = udd_calo_hit_.get_auxiliaries();
+    if (!auxiliaries.has_key(ENCODING_KEY))
+      {
+        samples_ = udd_calo_hit_.get_waveform();
+        return;
+      }
+    const std::string encoding = auxiliaries.fetch_string(ENCODING_KEY);
+    if (encoding == ROI_ENCODING)
+      {
+        first_cell_ = auxiliaries.fetch_integer(FIRST_CELL_KEY);
+        samples_ = udd_calo_hit_.get_waveform();
+        return;
+      }
+    DT_THROW_IF(encoding != PACKED_ENCODING, std::logic_error, "Unknown waveform encoding '" << encoding << "'!");
+    DT_THROW_IF(!unpack_waveform(udd_calo_hit_.get_waveform(), auxiliaries.fetch_integer(LENGTH_KEY), samples_),
+                std::runtime_error, "Corrupted packed waveform in calo hit #" << udd_calo_hit_.get_hit_id() << "!");
+    return;
+  }
+
+  bool compare_waveform(const snfee::data::calo_digitized_hit & red_calo_hit_,
+                        const snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit_,
+                        const waveform_config & config_)
+  {
+    const std::vector<int16_t> & red_waveform = red_calo_hit_.get_waveform();
+    const std::vector<int16_t> & udd_waveform = udd_calo_hit_.get_waveform();
+    const datatools::properties & auxiliaries = udd_calo_hit_.get_auxiliaries();
+    if (!auxiliaries.has_key(ENCODING_KEY)) return udd_waveform == red_waveform;
+
+    if (!auxiliaries.has_key(LENGTH_KEY)
+        || std::size_t(auxiliaries.fetch_integer(LENGTH_KEY)) != red_waveform.size())
+      return false;
+
+    const std::string encoding = auxiliaries.fetch_string(ENCODING_KEY);
+    if (encoding == ROI_ENCODING)
+      {
+        if (!auxiliaries.has_key(FIRST_CELL_KEY)) return false;
+        // The window stored by the conversion with the same margins
+        std::size_t first = 0;
+        std::size_t last = 0;
+        pulse_window(red_calo_hit_, config_.roi_before, config_.roi_after, first, last);
+        return std::size_t(auxiliaries.fetch_integer(FIRST_CELL_KEY)) == first
+          && udd_waveform.size() == last - first
+          && std::equal(udd_waveform.begin(), udd_waveform.end(), red_waveform.begin() + first);
+      }
+
+    if (encoding == PACKED_ENCODING)
+      {
+        static thread_local std::vector<int16_t> samples;
+        return unpack_waveform(udd_waveform, red_waveform.size(), samples)
+          && samples == red_waveform;
+      }
+
+    return false;
+  }
+
+} // namespace snredbridge
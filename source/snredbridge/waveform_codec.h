@@ -0,0 +1,92 @@
+/// \file snredbridge/waveform_codec.h
+/// Storage modes of the calorimeter waveforms in the UDD hits: full copy,
+/// region of interest around the pulse or lossless delta/bit packing
+
+#ifndef SNREDBRIDGE_WAVEFORM_CODEC_H
+#define SNREDBRIDGE_WAVEFORM_CODEC_H
+
+// Standard library:
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Falaise:
+#include <falaise/snemo/datamodels/calorimeter_digitized_hit.h>
+
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+namespace snredbridge {
+
+  /// \brief Storage of the RED waveform in the UDD calorimeter hit
+  ///
+  /// The UDD waveform is always a vector of 16 bits samples. For the roi and
+  /// packed modes, the auxiliary properties of the UDD hit describe how the
+  /// samples are stored, so that any reader can restore them with
+  /// decode_waveform():
+  ///
+  /// - "waveform.encoding" : "roi" or "delta_packed", absent for a full copy
+  /// - "waveform.length"   : number of samples of the RED waveform
+  /// - "waveform.first_cell" : cell of the first stored sample ("roi" only)
+  enum class waveform_mode
+  {
+    none,   ///< No waveform
+    full,   ///< Copy of all the samples
+    roi,    ///< Samples of a window around the pulse only
+    packed  ///< All the samples, delta encoded and bit packed (lossless)
+  };
+
+  /// Mode from its name ("none", "full", "roi", "packed")
+  waveform_mode waveform_mode_from_string(const std::string & name_);
+
+  /// Name of a mode
+  std::string to_string(const waveform_mode mode_);
+
+  /// Waveform storage configuration
+  struct waveform_config
+  {
+    waveform_mode mode = waveform_mode::full;
+    std::size_t roi_before = 32; ///< Cells kept before the rising edge ("roi" mode)
+    std::size_t roi_after = 96;  ///< Cells kept after the falling edge ("roi" mode)
+  };
+
+  /// Window [first_, last_) around the pulse of a RED calo hit, from the
+  /// firmware rising, peak and falling cells extended by the margins
+  void pulse_window(const snfee::data::calo_digitized_hit & red_calo_hit_,
+                    const std::size_t before_,
+                    const std::size_t after_,
+                    std::size_t & first_,
+                    std::size_t & last_);
+
+  /// Delta encode and bit pack samples into 16 bits words
+  void pack_waveform(const std::vector<int16_t> & samples_,
+                     std::vector<int16_t> & packed_);
+
+  /// Restore number_of_samples_ samples from packed words, false if the data are corrupted
+  bool unpack_waveform(const std::vector<int16_t> & packed_,
+                       const std::size_t number_of_samples_,
+                       std::vector<int16_t> & samples_);
+
+  /// Store the waveform of a RED calo hit into a UDD calo hit
+  void store_waveform(const snfee::data::calo_digitized_hit & red_calo_hit_,
+                      const waveform_config & config_,
+                      snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit_);
+
+  /// Restore the samples of a UDD calo hit whatever the storage mode,
+  /// first_cell_ is the cell of the first restored sample
+  void decode_waveform(const snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit_,
+                       std::vector<int16_t> & samples_,
+                       std::size_t & first_cell_);
+
+  /// Check that the UDD waveform holds the RED samples of its storage mode.
+  /// In the roi mode, the stored window must be the window around the pulse
+  /// with the margins of config_, whose mode is not used.
+  bool compare_waveform(const snfee::data::calo_digitized_hit & red_calo_hit_,
+                        const snemo::datamodel::calorimeter_digitized_hit & udd_calo_hit_,
+                        const waveform_config & config_);
+
+} // namespace snredbridge
+
+#endif // SNREDBRIDGE_WAVEFORM_CODEC_H
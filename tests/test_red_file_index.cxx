@@ -0,0 +1,193 @@
+// Test of the RED file index: records read from any position through the
+// inflate checkpoints must be the records of a sequential read
+
+// Standard library:
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/io_factory.h>
+#include <bayeux/datatools/logger.h>
+
+// - SNFEE:
+#include <snfee/snfee.h>
+#include <snfee/data/raw_event_data.h>
+#include <snfee/io/multifile_data_reader.h>
+
+// This project:
+#include <snredbridge/event_fingerprint.h>
+#include <snredbridge/parallel_gzip_writer.h>
+#include <snredbridge/red_event_generator.h>
+#include <snredbridge/red_file_index.h>
+
+namespace {
+
+  const std::size_t NUMBER_OF_EVENTS = 200;
+
+  /// Small spacing, so that the file has many checkpoints
+  const uint64_t CHECKPOINT_SPACING = 16 * 1024;
+
+  /// Small blocks, so that the file has many gzip members
+  const std::size_t BLOCK_SIZE = 32 * 1024;
+
+  /// Write the generated events into a RED file
+  void write_red_file(const std::string & filename_)
+  {
+    snredbridge::red_event_generator::config_type generator_cfg;
+    generator_cfg.run_id = 815;
+    generator_cfg.number_of_calo_hits = 2;
+    generator_cfg.waveform_length = 64;
+    generator_cfg.number_of_tracker_hits = 5;
+    generator_cfg.number_of_gg_times = 1;
+    snredbridge::red_event_generator generator(generator_cfg);
+    datatools::data_writer writer(filename_, datatools::using_single_archive);
+    snfee::data::raw_event_data red;
+    for (std::size_t ievent = 0; ievent < NUMBER_OF_EVENTS; ievent++)
+      {
+        red.reset();
+        generator.generate(red);
+        writer.store(red);
+      }
+    writer.reset();
+    return;
+  }
+
+  /// Compress a file into gzip members of BLOCK_SIZE bytes
+  void compress_in_blocks(const std::string & filename_, const std::string & gz_filename_)
+  {
+    std::ifstream input(filename_, std::ios::binary);
+    DT_THROW_IF(!input, std::runtime_error, "Cannot open '" << filename_ << "'!");
+    snredbridge::parallel_gzip_writer output(gz_filename_, -1, 2, BLOCK_SIZE);
+    std::vector<char> buffer(BLOCK_SIZE / 3);
+    while (input)
+      {
+        input.read(buffer.data(), buffer.size());
+        output.write(buffer.data(), input.gcount());
+      }
+    output.close();
+    return;
+  }
+
+  /// Fingerprints of the records of a sequential read
+  std::vector<snredbridge::event_fingerprint> read_sequentially(const std::string & filename_)
+  {
+    snfee::io::multifile_data_reader::config_type reader_cfg;
+    reader_cfg.filenames.push_back(filename_);
+    snfee::io::multifile_data_reader reader(reader_cfg);
+    std::vector<snredbridge::event_fingerprint> fingerprints;
+    snfee::data::raw_event_data red;
+    while (reader.has_record_tag())
+      {
+        reader.load(red);
+        fingerprints.push_back(snredbridge::compute_red_fingerprint(red, snredbridge::waveform_config()));
+      }
+    return fingerprints;
+  }
+
+  /// Read the records from first_record_ through the index and compare them
+  /// with the sequential read
+  void check_read_from(const std::string & filename_,
+                       const snredbridge::red_file_index & index_,
+                       const std::vector<snredbridge::event_fingerprint> & expected_,
+                       const std::size_t first_record_)
+  {
+    snredbridge::red_indexed_reader reader(filename_, index_, first_record_);
+    std::size_t position = first_record_;
+    snfee::data::raw_event_data red;
+    while (reader.has_record_tag())
+      {
+        DT_THROW_IF(position >= expected_.size(), std::runtime_error,
+                    filename_ << ": more records read from record " << first_record_ << " than in the file!");
+        reader.load(red);
+        DT_THROW_IF(!(snredbridge::compute_red_fingerprint(red, snredbridge::waveform_config()) == expected_[position]),
+                    std::runtime_error,
+                    filename_ << ": record " << position << " read from record " << first_record_
+                    << " differs from the sequential read!");
+        position++;
+      }
+    DT_THROW_IF(position != expected_.size(), std::runtime_error,
+                filename_ << ": " << position - first_record_ << " records read from record " << first_record_
+                << " instead of " << expected_.size() - first_record_ << "!");
+    return;
+  }
+
+  void check_file(const std::string & filename_)
+  {
+    const std::vector<snredbridge::event_fingerprint> expected = read_sequentially(filename_);
+    DT_THROW_IF(expected.size() != NUMBER_OF_EVENTS, std::runtime_error,
+                filename_ << ": " << expected.size() << " records read instead of " << NUMBER_OF_EVENTS << "!");
+
+    // The index is used as loaded from its file
+    const std::string index_filename = snredbridge::red_file_index::default_filename(filename_);
+    {
+      snredbridge::red_file_index index;
+      index.build(filename_, CHECKPOINT_SPACING);
+      index.save(index_filename);
+    }
+    snredbridge::red_file_index index;
+    index.load(index_filename);
+    DT_THROW_IF(!index.matches(filename_), std::runtime_error, filename_ << ": the index does not match the file!");
+    DT_THROW_IF(index.get_number_of_records() != NUMBER_OF_EVENTS, std::runtime_error,
+                filename_ << ": " << index.get_number_of_records() << " records in the index!");
+    DT_THROW_IF(index.get_number_of_checkpoints() < 3, std::runtime_error,
+                filename_ << ": only " << index.get_number_of_checkpoints() << " checkpoint(s) in the index!");
+
+    // First record after a checkpoint, beyond the prime records
+    const std::size_t prime_records = index.get_number_of_prime_records();
+    std::size_t after_checkpoint = 0;
+    for (std::size_t position = prime_records + 1; position < NUMBER_OF_EVENTS && after_checkpoint == 0; position++)
+      {
+        const uint64_t checkpoint_offset = index.find_checkpoint(index.get_record(position).offset).uncompressed_offset;
+        if (checkpoint_offset > index.get_record(position - 1).offset) after_checkpoint = position;
+      }
+    DT_THROW_IF(after_checkpoint == 0, std::runtime_error, filename_ << ": no record after a checkpoint!");
+
+    for (const std::size_t first_record : {std::size_t(0), prime_records, after_checkpoint, NUMBER_OF_EVENTS - 1})
+      check_read_from(filename_, index, expected, first_record);
+    std::remove(index_filename.c_str());
+    return;
+  }
+
+} // namespace
+
+//----------------------------------------------------------------------
+// MAIN PROGRAM
+//----------------------------------------------------------------------
+
+int main (int /* argc */, char ** /* argv */)
+{
+  datatools::logger::priority logging = datatools::logger::PRIO_WARNING;
+  int error_code = EXIT_SUCCESS;
+  try {
+    snfee::initialize();
+
+    // Single gzip member, as written by the Bayeux writers
+    const std::string single_filename = "test_red_file_index_single.data.gz";
+    write_red_file(single_filename);
+    check_file(single_filename);
+    std::remove(single_filename.c_str());
+
+    // Several gzip members, as written by parallel_gzip_writer
+    const std::string plain_filename = "test_red_file_index_members.data";
+    const std::string members_filename = plain_filename + ".gz";
+    write_red_file(plain_filename);
+    compress_in_blocks(plain_filename, members_filename);
+    std::remove(plain_filename.c_str());
+    check_file(members_filename);
+    std::remove(members_filename.c_str());
+
+    snfee::terminate();
+  }
+  catch (std::exception & x) {
+    DT_LOG_FATAL(logging, x.what());
+    error_code = EXIT_FAILURE;
+  }
+  return (error_code);
+}
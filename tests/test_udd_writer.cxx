@@ -0,0 +1,135 @@
+// Test of the block compression of the UDD writer: event records written
+// through the compression pipe must be read back by the dpp input module
+
+// Standard library:
+#include <cstdio>
+#include <iostream>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/logger.h>
+#include <bayeux/datatools/things.h>
+#include <bayeux/dpp/input_module.h>
+
+// - SNFEE:
+#include <snfee/snfee.h>
+#include <snfee/data/raw_event_data.h>
+
+// This project:
+#include <snredbridge/red_event_generator.h>
+#include <snredbridge/red_to_udd_conversion.h>
+#include <snredbridge/red_udd_comparison.h>
+#include <snredbridge/udd_writer.h>
+
+namespace {
+
+  const std::size_t NUMBER_OF_EVENTS = 100;
+
+  /// Small blocks, so that the file has many gzip members
+  const std::size_t BLOCK_SIZE = 32 * 1024;
+
+  /// Generated RED events
+  std::vector<snfee::data::raw_event_data> generate_events()
+  {
+    snredbridge::red_event_generator::config_type generator_cfg;
+    generator_cfg.run_id = 815;
+    generator_cfg.number_of_calo_hits = 2;
+    generator_cfg.waveform_length = 64;
+    generator_cfg.number_of_tracker_hits = 5;
+    generator_cfg.number_of_gg_times = 1;
+    snredbridge::red_event_generator generator(generator_cfg);
+    std::vector<snfee::data::raw_event_data> events(NUMBER_OF_EVENTS);
+    for (snfee::data::raw_event_data & red : events) generator.generate(red);
+    return events;
+  }
+
+  /// Convert and write the events with the given compression
+  void write_udd_file(const snredbridge::udd_writer::config_type & writer_cfg_,
+                      const std::vector<snfee::data::raw_event_data> & events_)
+  {
+    snredbridge::udd_writer writer(writer_cfg_);
+    DT_THROW_IF(!writer.is_block_compressed(), std::runtime_error,
+                writer_cfg_.filename << ": the writer does not compress in blocks!");
+    datatools::things event_record;
+    for (std::size_t ievent = 0; ievent < events_.size(); ievent++)
+      {
+        snredbridge::prepare_event_record(event_record, ievent);
+        snredbridge::do_red_to_udd_conversion(events_[ievent], event_record, snredbridge::waveform_config());
+        DT_THROW_IF(writer.process(event_record) != dpp::base_module::PROCESS_OK, std::runtime_error,
+                    writer_cfg_.filename << ": cannot write event record " << ievent << "!");
+      }
+    writer.reset();
+    return;
+  }
+
+  /// Read the event records back and compare them with the RED events
+  void check_udd_file(const std::string & filename_,
+                      const std::vector<snfee::data::raw_event_data> & events_,
+                      const datatools::logger::priority logging_)
+  {
+    dpp::input_module reader;
+    reader.set_logging_priority(datatools::logger::PRIO_FATAL);
+    reader.set_single_input_file(filename_);
+    reader.initialize_simple();
+    std::size_t udd_records = 0;
+    while (!reader.is_terminated())
+      {
+        datatools::things event_record;
+        if (reader.process(event_record) != dpp::base_module::PROCESS_OK) break;
+        DT_THROW_IF(udd_records >= events_.size(), std::runtime_error,
+                    filename_ << ": more records read than written!");
+        DT_THROW_IF(!snredbridge::compare_red_event_record(events_[udd_records], event_record, logging_,
+                                                           false, snredbridge::waveform_config()),
+                    std::runtime_error, filename_ << ": record " << udd_records << " differs from its RED event!");
+        udd_records++;
+      }
+    reader.reset();
+    DT_THROW_IF(udd_records != events_.size(), std::runtime_error,
+                filename_ << ": " << udd_records << " records read instead of " << events_.size() << "!");
+    return;
+  }
+
+} // namespace
+
+//----------------------------------------------------------------------
+// MAIN PROGRAM
+//----------------------------------------------------------------------
+
+int main (int /* argc */, char ** /* argv */)
+{
+  datatools::logger::priority logging = datatools::logger::PRIO_WARNING;
+  int error_code = EXIT_SUCCESS;
+  try {
+    snfee::initialize();
+    const std::vector<snfee::data::raw_event_data> events = generate_events();
+
+    // Compression level only: blocks deflated by a single thread
+    snredbridge::udd_writer::config_type writer_cfg;
+    writer_cfg.filename = "test_udd_writer_level.data.gz";
+    writer_cfg.level = 1;
+    writer_cfg.block_size = BLOCK_SIZE;
+    write_udd_file(writer_cfg, events);
+    check_udd_file(writer_cfg.filename, events, logging);
+    std::remove(writer_cfg.filename.c_str());
+
+    // Blocks deflated by several threads
+    writer_cfg.filename = "test_udd_writer_threads.data.gz";
+    writer_cfg.level = 6;
+    writer_cfg.compression_threads = 3;
+    write_udd_file(writer_cfg, events);
+    check_udd_file(writer_cfg.filename, events, logging);
+    std::remove(writer_cfg.filename.c_str());
+
+    snfee::terminate();
+  }
+  catch (std::exception & x) {
+    DT_LOG_FATAL(logging, x.what());
+    error_code = EXIT_FAILURE;
+  }
+  return (error_code);
+}
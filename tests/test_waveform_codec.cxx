@@ -0,0 +1,168 @@
+// Test of the waveform storage modes: round trip of the delta/bit packing
+// and of the region of interest around the pulse
+
+// Standard library:
+#include <cstdint>
+#include <iostream>
+#include <exception>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Third party:
+// - Bayeux:
+#include <bayeux/datatools/exception.h>
+#include <bayeux/datatools/logger.h>
+
+// - Falaise:
+#include <falaise/snemo/datamodels/calorimeter_digitized_hit.h>
+
+// - SNFEE:
+#include <snfee/data/raw_event_data.h>
+
+// This project:
+#include <snredbridge/waveform_codec.h>
+
+namespace {
+
+  /// FWMEAS rising and falling cells are given in 1/256 of a cell
+  const int32_t CELL_FRACTION = 256;
+
+  /// Pack, unpack and store the samples in the packed mode
+  void check_packing(const std::string & name_, const std::vector<int16_t> & samples_)
+  {
+    std::vector<int16_t> packed;
+    snredbridge::pack_waveform(samples_, packed);
+    std::vector<int16_t> unpacked;
+    DT_THROW_IF(!snredbridge::unpack_waveform(packed, samples_.size(), unpacked), std::runtime_error,
+                name_ << ": cannot unpack the waveform!");
+    DT_THROW_IF(unpacked != samples_, std::runtime_error, name_ << ": unpacked samples differ!");
+    if (!packed.empty())
+      {
+        // A truncated waveform is detected
+        packed.pop_back();
+        DT_THROW_IF(snredbridge::unpack_waveform(packed, samples_.size(), unpacked),
+                    std::runtime_error, name_ << ": truncated waveform unpacked!");
+      }
+
+    snfee::data::calo_digitized_hit red_hit;
+    red_hit.set_waveform(samples_);
+    snredbridge::waveform_config config;
+    config.mode = snredbridge::waveform_mode::packed;
+    snemo::datamodel::calorimeter_digitized_hit udd_hit;
+    snredbridge::store_waveform(red_hit, config, udd_hit);
+    std::vector<int16_t> decoded;
+    std::size_t first_cell = 1;
+    snredbridge::decode_waveform(udd_hit, decoded, first_cell);
+    DT_THROW_IF(decoded != samples_ || first_cell != 0, std::runtime_error, name_ << ": decoded samples differ!");
+    DT_THROW_IF(!snredbridge::compare_waveform(red_hit, udd_hit, config), std::runtime_error,
+                name_ << ": stored waveform not equal to the RED waveform!");
+    return;
+  }
+
+  std::vector<int16_t> noisy_samples(const std::size_t size_, std::mt19937 & engine_)
+  {
+    std::normal_distribution<double> noise(-2000.0, 20.0);
+    std::vector<int16_t> samples(size_);
+    for (int16_t & sample : samples) sample = static_cast<int16_t>(noise(engine_));
+    return samples;
+  }
+
+  /// Red calo hit with a pulse of one cell
+  void make_pulse(snfee::data::calo_digitized_hit & red_hit_,
+                  const std::size_t length_,
+                  const std::size_t cell_,
+                  std::mt19937 & engine_)
+  {
+    std::vector<int16_t> samples = noisy_samples(length_, engine_);
+    samples[cell_] = -10000;
+    red_hit_.set_waveform(samples);
+    red_hit_.set_fwmeas_peak_cell(cell_);
+    red_hit_.set_fwmeas_rising_cell(cell_ * CELL_FRACTION);
+    red_hit_.set_fwmeas_falling_cell(cell_ * CELL_FRACTION);
+    return;
+  }
+
+  /// Store the window around a pulse and check its cells
+  void check_roi(const std::string & name_,
+                 const std::size_t length_,
+                 const std::size_t cell_,
+                 const std::size_t expected_first_,
+                 const std::size_t expected_last_,
+                 std::mt19937 & engine_)
+  {
+    snfee::data::calo_digitized_hit red_hit;
+    make_pulse(red_hit, length_, cell_, engine_);
+    snredbridge::waveform_config config;
+    config.mode = snredbridge::waveform_mode::roi;
+
+    std::size_t first = 0;
+    std::size_t last = 0;
+    snredbridge::pulse_window(red_hit, config.roi_before, config.roi_after, first, last);
+    DT_THROW_IF(first != expected_first_ || last != expected_last_, std::runtime_error,
+                name_ << ": window [" << first << ", " << last << ") instead of ["
+                << expected_first_ << ", " << expected_last_ << ")!");
+
+    snemo::datamodel::calorimeter_digitized_hit udd_hit;
+    snredbridge::store_waveform(red_hit, config, udd_hit);
+    std::vector<int16_t> decoded;
+    std::size_t first_cell = 0;
+    snredbridge::decode_waveform(udd_hit, decoded, first_cell);
+    const std::vector<int16_t> & samples = red_hit.get_waveform();
+    DT_THROW_IF(first_cell != first || decoded != std::vector<int16_t>(samples.begin() + first, samples.begin() + last),
+                std::runtime_error, name_ << ": stored window differs from the RED samples!");
+    DT_THROW_IF(!snredbridge::compare_waveform(red_hit, udd_hit, config), std::runtime_error,
+                name_ << ": stored window not equal to the RED waveform!");
+
+    // A window with other margins, even holding the pulse, is not the stored one
+    snredbridge::waveform_config other_config = config;
+    other_config.roi_before++;
+    other_config.roi_after++;
+    DT_THROW_IF(snredbridge::compare_waveform(red_hit, udd_hit, other_config), std::runtime_error,
+                name_ << ": window accepted with other margins!");
+    return;
+  }
+
+} // namespace
+
+//----------------------------------------------------------------------
+// MAIN PROGRAM
+//----------------------------------------------------------------------
+
+int main (int /* argc */, char ** /* argv */)
+{
+  datatools::logger::priority logging = datatools::logger::PRIO_WARNING;
+  int error_code = EXIT_SUCCESS;
+  try {
+    std::mt19937 engine(314159);
+
+    // Around the block size of the packing (32 deltas)
+    for (const std::size_t size : {0, 1, 31, 32, 33, 1024})
+      check_packing(std::to_string(size) + " samples", noisy_samples(size, engine));
+
+    // Constant samples: blocks of null deltas
+    check_packing("constant", std::vector<int16_t>(100, -2000));
+
+    // Steps of +/-32767 and the full range: deltas on 17 bits
+    std::vector<int16_t> steps(70, 0);
+    std::vector<int16_t> extremes(70, INT16_MIN);
+    for (std::size_t isample = 1; isample < steps.size(); isample += 2)
+      {
+        steps[isample] = isample % 4 == 1 ? 32767 : -32767;
+        extremes[isample] = INT16_MAX;
+      }
+    check_packing("32767 steps", steps);
+    check_packing("full range steps", extremes);
+
+    // Pulse at the first and at the last cell: the window is cut by the waveform
+    check_roi("pulse at cell 0", 1024, 0, 0, 97, engine);
+    check_roi("pulse at the last cell", 1024, 1023, 991, 1024, engine);
+    check_roi("pulse in the middle", 1024, 500, 468, 597, engine);
+  }
+  catch (std::exception & x) {
+    DT_LOG_FATAL(logging, x.what());
+    error_code = EXIT_FAILURE;
+  }
+  return (error_code);
+}